@@ -0,0 +1,563 @@
+// Copyright 2016-2021 L. Pickering, P Stowell, R. Terri, C. Wilkinson, C. Wret
+
+/*******************************************************************************
+ *    This file is part of NUISANCE.
+ *
+ *    NUISANCE is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    NUISANCE is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with NUISANCE.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#include "ConstructibleFitEvent.h"
+#include "ConstructibleInputHandler.h"
+
+#include "FitLogger.h"
+#include "FitWeight.h"
+#include "NuisConfig.h"
+#include "NuisKey.h"
+#include "OpenMPWrapper.h"
+#include "PlotUtils.h"
+#include "SignalDef.h"
+#include "SplineCoeffStore.h"
+#include "SplineReader.h"
+#include "StatUtils.h"
+
+#include "TH1D.h"
+#include "TMatrixDSym.h"
+#include "TRandom3.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+// Throughput benchmark for the stages of a sample reconfigure, run on
+// synthetic events so it needs no generator inputs or reweight libraries.
+// Every stage reports items per second so results from different builds
+// and machines can be compared directly, and can be written as JSON with -o
+// for tracking over time.
+
+//*******************************
+void printInputCommands() {
+  //*******************************
+  std::cout
+      << "nuisbench [-n <events>] [-s <samples>] [-b <bins>] [-t <threads>]\n"
+      << "          [-p <splines>] [-r <repeats>] [-o <results.json>]\n\n"
+      << "\t-n : Number of synthetic events (default 200000)\n"
+      << "\t-s : Number of samples selecting and filling from each event "
+         "(default 4)\n"
+      << "\t-b : Number of bins per sample histogram (default 50)\n"
+      << "\t-t : Number of OpenMP threads, where the build supports them "
+         "(default 1)\n"
+      << "\t-p : Number of 1DPol3 splines per event (default 4)\n"
+      << "\t-r : Repeats per stage, the fastest is reported (default 3)\n"
+      << "\t-o : Write machine readable results to this JSON file\n"
+      << std::endl;
+  exit(-1);
+};
+
+namespace {
+typedef std::chrono::high_resolution_clock bench_clock;
+
+double ElapsedS(bench_clock::time_point const &start) {
+  return std::chrono::duration<double>(bench_clock::now() - start).count();
+}
+
+/// Timing of one stage
+struct StageResult {
+  std::string name;
+  std::string unit;
+  long items;
+  double seconds;
+
+  double Rate() const { return (seconds > 0.0) ? double(items) / seconds : 0.0; };
+};
+
+/// Raw particle as an input handler would read it from a generator record
+struct RawParticle {
+  double mom[4];
+  int pdg;
+  UInt_t state;
+};
+
+/// Flat raw event record, particles [first, first + n) of the pool
+struct RawEvent {
+  int mode;
+  size_t first;
+  int n;
+};
+
+std::vector<StageResult> gResults;
+int gRepeats = 3;
+
+/// Run func gRepeats times and keep the fastest
+template <typename F>
+void RunStage(std::string const &name, std::string const &unit, long items,
+              F func) {
+  double best = -1.0;
+  for (int r = 0; r < gRepeats; ++r) {
+    bench_clock::time_point start = bench_clock::now();
+    func();
+    double s = ElapsedS(start);
+    if (best < 0.0 || s < best) best = s;
+  }
+
+  StageResult res;
+  res.name = name;
+  res.unit = unit;
+  res.items = items;
+  res.seconds = best;
+  gResults.push_back(res);
+
+  std::cout << "  " << std::setw(24) << std::left << name << std::setw(14)
+            << std::right << std::scientific << std::setprecision(3)
+            << res.Rate() << " " << unit << "/s  (" << std::fixed
+            << std::setprecision(4) << best << " s)" << std::endl;
+}
+
+void AddRaw(std::vector<RawParticle> &parts, TRandom3 &rnd, int pdg,
+            UInt_t state, double mass, double pmean, double psigma) {
+  RawParticle p;
+  TVector3 p3;
+  p3.SetMagThetaPhi(std::fabs(rnd.Gaus(pmean, psigma)),
+                    std::acos(rnd.Uniform(-1.0, 1.0)),
+                    rnd.Uniform(2.0 * M_PI));
+  p.mom[0] = p3.X();
+  p.mom[1] = p3.Y();
+  p.mom[2] = p3.Z();
+  p.mom[3] = std::sqrt(p3.Mag2() + mass * mass);
+  p.pdg = pdg;
+  p.state = state;
+  parts.push_back(p);
+}
+
+/// Build a CC-dominated mixture of simple topologies with NEUT-like modes
+void BuildRawEvents(int nevents, std::vector<RawEvent> &events,
+                    std::vector<RawParticle> &parts) {
+  TRandom3 rnd(12345);
+  events.reserve(nevents);
+  parts.reserve(size_t(nevents) * 6);
+
+  for (int i = 0; i < nevents; ++i) {
+    RawEvent evt;
+    evt.first = parts.size();
+
+    double enu = std::fabs(rnd.Gaus(1000.0, 400.0)) + 100.0;
+    RawParticle nu = {{0.0, 0.0, enu, enu}, 14, kInitialState};
+    parts.push_back(nu);
+    AddRaw(parts, rnd, 2112, kInitialState, 939.6, 200.0, 50.0);
+
+    double topo = rnd.Uniform();
+    bool cc = (topo < 0.8);
+    if (cc) {
+      AddRaw(parts, rnd, 13, kFinalState, 105.7, 0.6 * enu, 0.2 * enu);
+    } else {
+      AddRaw(parts, rnd, 14, kFinalState, 0.0, 0.6 * enu, 0.2 * enu);
+    }
+
+    int nprot = int(rnd.Uniform(0.0, 3.0));
+    for (int j = 0; j < nprot; ++j) {
+      AddRaw(parts, rnd, 2212, kFinalState, 938.3, 400.0, 150.0);
+    }
+
+    if (topo < 0.45) {
+      evt.mode = (nprot > 1) ? 2 : 1;
+    } else if (topo < 0.6) {
+      evt.mode = 11;
+      AddRaw(parts, rnd, 211, kFinalState, 139.6, 250.0, 100.0);
+    } else if (topo < 0.7) {
+      evt.mode = 12;
+      AddRaw(parts, rnd, 111, kFinalState, 135.0, 250.0, 100.0);
+    } else if (topo < 0.8) {
+      evt.mode = 26;
+      AddRaw(parts, rnd, 211, kFinalState, 139.6, 300.0, 150.0);
+      AddRaw(parts, rnd, -211, kFinalState, 139.6, 300.0, 150.0);
+    } else {
+      evt.mode = 51;
+    }
+
+    evt.n = int(parts.size() - evt.first);
+    events.push_back(evt);
+  }
+}
+
+void ConvertEvent(ConstructibleFitEvent *fe, RawEvent const &raw,
+                  std::vector<RawParticle> const &parts) {
+  fe->ResetEvent();
+  for (int j = 0; j < raw.n; ++j) {
+    RawParticle const &p = parts[raw.first + j];
+    double mom[4] = {p.mom[0], p.mom[1], p.mom[2], p.mom[3]};
+    fe->AddPart(mom, p.state, p.pdg);
+  }
+  fe->SetMode(raw.mode);
+  fe->OrderStack();
+}
+
+/// Signal definition applied by sample isample
+bool IsSignal(int isample, FitEvent *event) {
+  switch (isample % 4) {
+  case 0:
+    return SignalDef::isCCINC(event, 14, 0, 10000);
+  case 1:
+    return SignalDef::isCC0pi(event, 14, 0, 10000);
+  case 2:
+    return SignalDef::isCC1pi(event, 14, 211, 0, 10000);
+  default:
+    return SignalDef::isNCINC(event, 14, 0, 10000);
+  }
+}
+
+void WriteResults(std::string const &file, int nevents, int nsamples,
+                  int nbins, int nthreads, int nsplines) {
+  std::ofstream out(file.c_str());
+  if (!out.good()) {
+    NUIS_ABORT("Could not open " << file << " to write benchmark results.");
+  }
+
+  out << "{\n"
+      << "  \"benchmark\": \"nuisbench\",\n"
+      << "  \"config\": {\"events\": " << nevents
+      << ", \"samples\": " << nsamples << ", \"bins\": " << nbins
+      << ", \"threads\": " << nthreads << ", \"splines\": " << nsplines
+      << ", \"repeats\": " << gRepeats << "},\n"
+      << "  \"stages\": [\n";
+  for (size_t i = 0; i < gResults.size(); ++i) {
+    StageResult const &res = gResults[i];
+    out << "    {\"name\": \"" << res.name << "\", \"unit\": \"" << res.unit
+        << "\", \"items\": " << res.items << ", \"seconds\": "
+        << std::setprecision(9) << res.seconds << ", \"rate\": "
+        << std::setprecision(9) << res.Rate() << "}"
+        << ((i + 1 < gResults.size()) ? ",\n" : "\n");
+  }
+  out << "  ]\n}" << std::endl;
+
+  NUIS_LOG(FIT, "Written benchmark results to " << file);
+}
+} // namespace
+
+//*******************************
+int main(int argc, char *argv[]) {
+  //*******************************
+
+  int nevents = 200000;
+  int nsamples = 4;
+  int nbins = 50;
+  int nthreads = 1;
+  int nsplines = 4;
+  std::string outfile = "";
+
+  for (int i = 1; i < argc; ++i) {
+    if (!std::strcmp(argv[i], "-h")) {
+      printInputCommands();
+    } else if (!std::strcmp(argv[i], "-n") && (i + 1) < argc) {
+      nevents = std::atoi(argv[++i]);
+    } else if (!std::strcmp(argv[i], "-s") && (i + 1) < argc) {
+      nsamples = std::atoi(argv[++i]);
+    } else if (!std::strcmp(argv[i], "-b") && (i + 1) < argc) {
+      nbins = std::atoi(argv[++i]);
+    } else if (!std::strcmp(argv[i], "-t") && (i + 1) < argc) {
+      nthreads = std::atoi(argv[++i]);
+    } else if (!std::strcmp(argv[i], "-p") && (i + 1) < argc) {
+      nsplines = std::atoi(argv[++i]);
+    } else if (!std::strcmp(argv[i], "-r") && (i + 1) < argc) {
+      gRepeats = std::atoi(argv[++i]);
+    } else if (!std::strcmp(argv[i], "-o") && (i + 1) < argc) {
+      outfile = argv[++i];
+    } else {
+      printInputCommands();
+    }
+  }
+
+  if (nevents < 1 || nsamples < 1 || nbins < 1 || nthreads < 1 ||
+      nsplines < 1 || gRepeats < 1) {
+    NUIS_ERR(FTL, "All benchmark sizes must be positive.");
+    printInputCommands();
+  }
+
+  // Load the default parameters, the handler reads them on construction
+  nuisconfig configuration = Config::Get();
+  Config::SetPar("EventPreload", false);
+  SETVERBOSITY(FIT);
+
+  omp_set_num_threads(nthreads);
+  nthreads = omp_get_max_threads();
+
+  NUIS_LOG(FIT, "Benchmarking " << nevents << " events, " << nsamples
+                                << " samples, " << nbins << " bins, "
+                                << nsplines << " splines on " << nthreads
+                                << " thread(s)");
+
+  std::vector<RawEvent> rawevents;
+  std::vector<RawParticle> rawparts;
+  BuildRawEvents(nevents, rawevents, rawparts);
+
+  // Converted events are held for a bounded pool and reused cyclically, as a
+  // FitEvent carries a full particle stack each.
+  int npool = std::min(nevents, 2000);
+  std::vector<ConstructibleFitEvent *> pool;
+  for (int i = 0; i < npool; ++i) {
+    pool.push_back(new ConstructibleFitEvent());
+    ConvertEvent(pool.back(), rawevents[i], rawparts);
+  }
+
+  ConstructibleInputHandler handler("nuisbench");
+  for (int i = 0; i < nevents; ++i) {
+    handler.AddFitEvent(pool[i % npool], false);
+  }
+
+  std::vector<ConstructibleFitEvent *> scratch;
+  for (int i = 0; i < nthreads; ++i) {
+    scratch.push_back(new ConstructibleFitEvent());
+  }
+
+  std::vector<FitEvent *> events(nevents, NULL);
+  std::vector<double> weights(nevents, 1.0);
+  volatile double sink = 0.0;
+
+  std::cout << "[ NUISANCE ]: Stage throughput (best of " << gRepeats << ")"
+            << std::endl;
+
+  // -- Read and convert
+  RunStage("convert", "events", nevents, [&]() {
+#ifdef __USE_OPENMP__
+#pragma omp parallel for
+#endif
+    for (int i = 0; i < nevents; ++i) {
+      ConvertEvent(scratch[omp_get_thread_num()], rawevents[i], rawparts);
+    }
+  });
+
+  RunStage("read", "events", nevents, [&]() {
+    int i = 0;
+    for (FitEvent *ev = handler.FirstNuisanceEvent(); ev;
+         ev = handler.NextNuisanceEvent()) {
+      events[i++] = ev;
+    }
+  });
+
+  // -- Event reweighting through FitWeight
+  FitWeight rw("nuisbench");
+  rw.IncludeDial("mode_1", "modenorm_parameter", 1.1);
+  rw.IncludeDial("mode_11", "modenorm_parameter", 0.9);
+  rw.IncludeDial("mode_26", "modenorm_parameter", 1.2);
+  rw.Reconfigure(true);
+  bool rwthreads = rw.IsThreadSafe();
+
+  RunStage("calcweight", "events", nevents, [&]() {
+    if (rwthreads) {
+#ifdef __USE_OPENMP__
+#pragma omp parallel for
+#endif
+      for (int i = 0; i < nevents; ++i) {
+        weights[i] = rw.CalcWeight(events[i]);
+      }
+    } else {
+      for (int i = 0; i < nevents; ++i) {
+        weights[i] = rw.CalcWeight(events[i]);
+      }
+    }
+  });
+
+  // -- Spline evaluation, per event through the reader and column-wise
+  // through the coefficient store
+  SplineReader reader;
+  std::map<std::string, double> splvals;
+  for (int i = 0; i < nsplines; ++i) {
+    std::ostringstream name;
+    name << "bench_par_" << i;
+    nuiskey splkey = Config::CreateKey("spline");
+    splkey.Set("name", name.str());
+    splkey.Set("type", "spline_parameter");
+    splkey.Set("form", "1DPol3");
+    splkey.Set("points", "-1,0,1");
+    splkey.Set("extrapolate", "");
+    reader.AddSpline(splkey);
+    splvals[name.str()] = 0.1 * (i + 1);
+  }
+  reader.Reconfigure(splvals);
+
+  int ncoeff = reader.GetNPar();
+  std::vector<std::vector<float> > coeffrows(nevents,
+                                             std::vector<float>(ncoeff));
+  TRandom3 splrnd(54321);
+  for (int i = 0; i < nevents; ++i) {
+    for (int j = 0; j < ncoeff; ++j) {
+      coeffrows[i][j] = (j % 4) ? splrnd.Gaus(0.0, 0.1) : 1.0;
+    }
+  }
+
+  std::vector<double> splweights(nevents, 1.0);
+  RunStage("spline_reader", "events", nevents, [&]() {
+#ifdef __USE_OPENMP__
+#pragma omp parallel for
+#endif
+    for (int i = 0; i < nevents; ++i) {
+      splweights[i] = reader.CalcWeight(&coeffrows[i][0]);
+    }
+  });
+
+  SplineCoeffStore store(&reader);
+  store.Fill(coeffrows.begin(), coeffrows.end());
+  RunStage("spline_store", "events", nevents, [&]() {
+    int nchunk = nthreads;
+#ifdef __USE_OPENMP__
+#pragma omp parallel for
+#endif
+    for (int c = 0; c < nchunk; ++c) {
+      size_t first = size_t(nevents) * c / nchunk;
+      size_t last = size_t(nevents) * (c + 1) / nchunk;
+      store.CalcWeights(&splweights[first], first, last);
+    }
+  });
+
+  // The particle summary is built lazily inside const queries and events are
+  // shared between samples (and repeated from the pool), so build every
+  // summary here, serially, before the selection threads only read them.
+  std::vector<double> xvar(nevents, 0.0);
+  for (int i = 0; i < nevents; ++i) {
+    FitParticleView lep = events[i]->GetHMFSParticleView(13);
+    if (!lep.IsValid()) lep = events[i]->GetHMFSParticleView(14);
+    xvar[i] = lep.p();
+  }
+
+  // -- Signal selection, every sample sees every event
+  std::vector<std::vector<char> > signal(nsamples,
+                                         std::vector<char>(nevents, 0));
+  RunStage("select", "event-samples", long(nevents) * nsamples, [&]() {
+#ifdef __USE_OPENMP__
+#pragma omp parallel for
+#endif
+    for (int s = 0; s < nsamples; ++s) {
+      for (int i = 0; i < nevents; ++i) {
+        signal[s][i] = IsSignal(s, events[i]);
+      }
+    }
+  });
+
+  // The same selection scanning the particle stack instead of the summary,
+  // to show what the summary saves.
+  std::vector<long> scanpassed(nsamples, 0);
+  bool usesummary = FitEvent::GetUseParticleSummary();
+  FitEvent::SetUseParticleSummary(false);
+  RunStage("select_scan", "event-samples", long(nevents) * nsamples, [&]() {
+#ifdef __USE_OPENMP__
+#pragma omp parallel for
+#endif
+    for (int s = 0; s < nsamples; ++s) {
+      for (int i = 0; i < nevents; ++i) {
+        scanpassed[s] += IsSignal(s, events[i]);
+      }
+    }
+  });
+  FitEvent::SetUseParticleSummary(usesummary);
+
+  // -- Histogram fills of the signal events, by value and by saved bin
+
+  std::vector<TH1D *> mchists;
+  std::vector<std::vector<int> > fillbins(nsamples);
+  long nfills = 0;
+  for (int s = 0; s < nsamples; ++s) {
+    std::ostringstream name;
+    name << "nuisbench_mc_" << s;
+    mchists.push_back(new TH1D(name.str().c_str(), "", nbins, 0.0, 2000.0));
+    mchists.back()->SetDirectory(NULL);
+    mchists.back()->Sumw2();
+
+    fillbins[s].resize(nevents, -1);
+    for (int i = 0; i < nevents; ++i) {
+      if (!signal[s][i]) continue;
+      fillbins[s][i] = mchists.back()->FindBin(xvar[i]);
+      nfills++;
+    }
+  }
+
+  RunStage("fill", "fills", nfills, [&]() {
+#ifdef __USE_OPENMP__
+#pragma omp parallel for
+#endif
+    for (int s = 0; s < nsamples; ++s) {
+      mchists[s]->Reset();
+      for (int i = 0; i < nevents; ++i) {
+        if (signal[s][i]) mchists[s]->Fill(xvar[i], weights[i]);
+      }
+    }
+  });
+
+  RunStage("fill_bins", "fills", nfills, [&]() {
+#ifdef __USE_OPENMP__
+#pragma omp parallel for
+#endif
+    for (int s = 0; s < nsamples; ++s) {
+      mchists[s]->Reset();
+      for (int i = 0; i < nevents; ++i) {
+        if (fillbins[s][i] != -1) {
+          PlotUtils::FillBin(mchists[s], fillbins[s][i], weights[i]);
+        }
+      }
+    }
+  });
+
+  // -- Likelihood, one correlated chi2 per sample
+  std::vector<TH1D *> datahists;
+  TMatrixDSym invcov(nbins);
+  for (int i = 0; i < nbins; ++i) {
+    for (int j = 0; j < nbins; ++j) {
+      invcov(i, j) = (i == j) ? 1.0 : 1E-3 / (1.0 + std::abs(i - j));
+    }
+  }
+  for (int s = 0; s < nsamples; ++s) {
+    datahists.push_back((TH1D *)mchists[s]->Clone());
+    datahists.back()->SetDirectory(NULL);
+    datahists.back()->Scale(1.05);
+    for (int i = 0; i < nbins; ++i) {
+      datahists.back()->SetBinError(i + 1, 1.0);
+    }
+  }
+
+  int nchi2 = std::max(1, 20000000 / (nbins * nbins * nsamples));
+  RunStage("chi2", "samples", long(nchi2) * nsamples, [&]() {
+    for (int n = 0; n < nchi2; ++n) {
+      for (int s = 0; s < nsamples; ++s) {
+        sink = sink + StatUtils::GetChi2FromCov(datahists[s], mchists[s],
+                                                &invcov);
+      }
+    }
+  });
+
+  std::vector<StatUtils::Chi2Evaluator> evaluators(nsamples);
+  for (int s = 0; s < nsamples; ++s) {
+    evaluators[s].Setup(datahists[s], &invcov);
+  }
+  RunStage("chi2_evaluator", "samples", long(nchi2) * nsamples, [&]() {
+    for (int n = 0; n < nchi2; ++n) {
+      for (int s = 0; s < nsamples; ++s) {
+        sink = sink + evaluators[s].Eval(datahists[s], mchists[s]);
+      }
+    }
+  });
+
+  if (!outfile.empty()) {
+    WriteResults(outfile, nevents, nsamples, nbins, nthreads, nsplines);
+  }
+
+  for (int s = 0; s < nsamples; ++s) {
+    delete mchists[s];
+    delete datahists[s];
+  }
+  for (size_t i = 0; i < scratch.size(); ++i) delete scratch[i];
+  for (size_t i = 0; i < pool.size(); ++i) delete pool[i];
+
+  return 0;
+}
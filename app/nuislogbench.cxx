@@ -0,0 +1,149 @@
+// Copyright 2016-2021 L. Pickering, P Stowell, R. Terri, C. Wilkinson, C. Wret
+
+/*******************************************************************************
+ *    This file is part of NUISANCE.
+ *
+ *    NUISANCE is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    NUISANCE is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with NUISANCE.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#include "FitLogger.h"
+#include "StatUtils.h"
+
+#include "TH1D.h"
+#include "TMatrixDSym.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+
+// Measures what NUIS_LOG statements cost in a hot loop when their level is
+// not being printed. Build once with the default NUIS_LOG_MAX_LEVEL and once
+// with e.g. -DNUIS_LOG_MAX_LEVEL=REC to compare runtime against compile time
+// gating.
+
+//*******************************
+void printInputCommands() {
+  //*******************************
+  std::cout
+      << "nuislogbench [-n <iterations>] [-b <bins>]\n\n"
+      << "\t-n : Number of loop iterations to time (default 100000000)\n"
+      << "\t-b : Number of bins in the GetChi2FromCov test (default 200)\n"
+      << std::endl;
+  exit(-1);
+};
+
+namespace {
+typedef std::chrono::high_resolution_clock bench_clock;
+
+double ElapsedNS(bench_clock::time_point const &start) {
+  return std::chrono::duration<double, std::nano>(bench_clock::now() - start)
+      .count();
+}
+
+void Report(std::string const &name, double ns, long ncalls) {
+  std::cout << "  " << std::setw(36) << std::left << name << std::setw(12)
+            << std::right << std::fixed << std::setprecision(3)
+            << (ns / double(ncalls)) << " ns/call" << std::endl;
+}
+} // namespace
+
+//*******************************
+int main(int argc, char *argv[]) {
+  //*******************************
+
+  long niter = 100000000;
+  int nbins = 200;
+
+  for (int i = 1; i < argc; ++i) {
+    if (!std::strcmp(argv[i], "-h")) {
+      printInputCommands();
+    } else if (!std::strcmp(argv[i], "-n") && (i + 1) < argc) {
+      niter = std::atol(argv[++i]);
+    } else if (!std::strcmp(argv[i], "-b") && (i + 1) < argc) {
+      nbins = std::atoi(argv[++i]);
+    } else {
+      printInputCommands();
+    }
+  }
+
+  // Only FIT output is wanted while timing
+  SETVERBOSITY(FIT);
+
+  std::cout << "[ NUISANCE ]: NUIS_LOG_MAX_LEVEL = " << NUIS_LOG_MAX_LEVEL
+            << ", runtime verbosity = " << FIT << std::endl;
+
+  // Volatile sink so the loops themselves are not optimised away
+  volatile double sink = 0.0;
+
+  bench_clock::time_point start = bench_clock::now();
+  for (long i = 0; i < niter; ++i) {
+    sink = sink + double(i);
+  }
+  double ns_base = ElapsedNS(start);
+
+  start = bench_clock::now();
+  for (long i = 0; i < niter; ++i) {
+    sink = sink + double(i);
+    NUIS_LOG(REC, "Iteration " << i << " sink " << sink);
+  }
+  double ns_rec = ElapsedNS(start);
+
+  start = bench_clock::now();
+  for (long i = 0; i < niter; ++i) {
+    sink = sink + double(i);
+    NUIS_LOG(EVT, "Iteration " << i << " sink " << sink);
+  }
+  double ns_evt = ElapsedNS(start);
+
+  start = bench_clock::now();
+  for (long i = 0; i < niter; ++i) {
+    sink = sink + double(i);
+    NUIS_LOG(DEB, "Iteration " << i << " sink " << sink);
+  }
+  double ns_deb = ElapsedNS(start);
+
+  std::cout << "[ NUISANCE ]: Suppressed statement cost over " << niter
+            << " iterations" << std::endl;
+  Report("empty loop", ns_base, niter);
+  Report("NUIS_LOG(REC) per iteration", ns_rec - ns_base, niter);
+  Report("NUIS_LOG(EVT) per iteration", ns_evt - ns_base, niter);
+  Report("NUIS_LOG(DEB) per iteration", ns_deb - ns_base, niter);
+
+  // GetChi2FromCov logs at DEB for every bin pair
+  TH1D data("data", "data", nbins, 0.0, 1.0);
+  TH1D mc("mc", "mc", nbins, 0.0, 1.0);
+  TMatrixDSym invcov(nbins);
+  for (int i = 0; i < nbins; ++i) {
+    data.SetBinContent(i + 1, 1.0 + 0.01 * i);
+    data.SetBinError(i + 1, 0.1);
+    mc.SetBinContent(i + 1, 1.0 + 0.011 * i);
+    for (int j = 0; j < nbins; ++j) {
+      invcov(i, j) = (i == j) ? 1.0 : 1E-3 / (1.0 + std::abs(i - j));
+    }
+  }
+
+  int nchi2 = 100;
+  start = bench_clock::now();
+  for (int i = 0; i < nchi2; ++i) {
+    sink = sink + StatUtils::GetChi2FromCov(&data, &mc, &invcov);
+  }
+  double ns_chi2 = ElapsedNS(start);
+
+  std::cout << "[ NUISANCE ]: GetChi2FromCov with " << nbins << " bins"
+            << std::endl;
+  Report("GetChi2FromCov", ns_chi2, nchi2);
+  Report("GetChi2FromCov per bin pair", ns_chi2, long(nchi2) * nbins * nbins);
+
+  return 0;
+}
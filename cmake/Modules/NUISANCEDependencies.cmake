@@ -31,6 +31,7 @@ DefineEnabledRequiredSwitch(GENIE TRUE)
 DefineEnabledRequiredSwitch(NuWro TRUE)
 DefineEnabledRequiredSwitch(Prob3plusplus FALSE)
 DefineEnabledRequiredSwitch(NuHepMC FALSE)
+DefineEnabledRequiredSwitch(OpenMP FALSE)
 
 if (T2KReWeight_ENABLED)
   include(T2KReWeight)
@@ -261,5 +262,32 @@ if (NuHepMC_ENABLED)
   target_compile_options(GeneratorCompileDependencies INTERFACE -Wno-unused-parameter -Wno-unused-but-set-variable)
 endif()
 
+if (OpenMP_ENABLED)
+  find_package(OpenMP COMPONENTS CXX)
+
+  if(NOT OpenMP_CXX_FOUND)
+    if(OpenMP_REQUIRED)
+      cmessage(FATAL_ERROR "OpenMP was explicitly enabled but cannot be found.")
+    endif()
+    SET(OpenMP_ENABLED FALSE)
+  else()
+    SET(OpenMP_ENABLED TRUE)
+    target_compile_definitions(GeneratorCompileDependencies INTERFACE __USE_OPENMP__)
+    target_link_libraries(GeneratorCompileDependencies INTERFACE OpenMP::OpenMP_CXX)
+  endif()
+endif()
+
+# Compile time ceiling for NUIS_LOG, statements above this level are removed
+if(NOT DEFINED NUIS_LOG_MAX_LEVEL)
+  SET(NUIS_LOG_MAX_LEVEL DEB)
+endif()
+SET(NUIS_LOG_LEVELS QUIET FIT MIN SAM REC SIG EVT DEB)
+LIST(FIND NUIS_LOG_LEVELS ${NUIS_LOG_MAX_LEVEL} NUIS_LOG_MAX_LEVEL_INT)
+if(NUIS_LOG_MAX_LEVEL_INT LESS 0)
+  cmessage(FATAL_ERROR "NUIS_LOG_MAX_LEVEL=${NUIS_LOG_MAX_LEVEL} is not one of ${NUIS_LOG_LEVELS}.")
+endif()
+cmessage(STATUS "NUIS_LOG statements above ${NUIS_LOG_MAX_LEVEL} will be compiled out.")
+target_compile_definitions(GeneratorCompileDependencies INTERFACE NUIS_LOG_MAX_LEVEL=${NUIS_LOG_MAX_LEVEL_INT})
+
 install(TARGETS GeneratorCompileDependencies
     EXPORT nuisance-targets)
@@ -74,6 +74,8 @@ nuisconfig::nuisconfig() {
 
   // Setup Main XML Node to be the first file read
   fMainNode = fXML->DocGetRootElement(fXMLDocs[0]);
+  fConfigCacheValid = false;
+  fThreadSafe = false;
 
   // Print result
   std::cout << "[ NUISANCE ]: Finished nuisconfig." << std::endl;
@@ -101,6 +103,8 @@ void nuisconfig::LoadSettings(std::string const &filename,
     std::cout << " -> Assuming its a simple card file." << std::endl;
     LoadCardSettings(filename, state);
   }
+
+  BuildConfigCache();
 }
 
 void nuisconfig::LoadXMLSettings(std::string const &filename,
@@ -143,6 +147,7 @@ void nuisconfig::LoadXMLSettings(std::string const &filename,
             // If we already have this config, free the old attribute
             if (fXML->HasAttr(confignodes[i], fXML->GetAttrName(attr1))) {
               fXML->FreeAttr(confignodes[i], fXML->GetAttrName(attr1));
+              InvalidateConfigCache();
               break;
             }
           }
@@ -164,6 +169,7 @@ void nuisconfig::LoadXMLSettings(std::string const &filename,
 
     // Add this child to the main config list
     fXML->AddChild(fMainNode, copyNode);
+    InvalidateConfigCache();
 
     // std::cout << "Done, was it added?" << std::endl;
     // PrintXML(fMainNode);
@@ -312,6 +318,7 @@ void nuisconfig::FinaliseSettings(std::string const &name) {
   // Save full config to file
   RemoveEmptyNodes();
   RemoveIdenticalNodes();
+  BuildConfigCache();
 
   std::cout << "[ NUISANCE ]: Finished finalising run settings" << std::endl;
 }
@@ -361,16 +368,21 @@ void nuisconfig::PrintXML(XMLNodePointer_t node, int indent) {
 }
 
 XMLNodePointer_t nuisconfig::CreateNode(std::string const &name) {
+  ConfigLock lock(*this);
+  InvalidateConfigCache();
   return fXML->NewChild(fMainNode, 0, name.c_str());
 }
 
 XMLNodePointer_t nuisconfig::CreateNode(XMLNodePointer_t node,
                                         std::string const &name) {
+  ConfigLock lock(*this);
+  InvalidateConfigCache();
   return fXML->NewChild(node, 0, name.c_str());
 }
 
 XMLNodePointer_t nuisconfig::GetNode(XMLNodePointer_t node,
                                      std::string const &type) {
+  ConfigLock lock(*this);
   /// Loop over all children
   XMLNodePointer_t child = fXML->GetChild(node);
   while (child != 0) {
@@ -449,8 +461,10 @@ void nuisconfig::RemoveIdenticalNodes() {
 }
 
 void nuisconfig::RemoveNode(XMLNodePointer_t node) {
+  ConfigLock lock(*this);
   // std::cout << "[ CONFIG   ]: Removing node: ";
   // PrintNode(node);
+  InvalidateConfigCache();
   fXML->FreeAllAttr(node);
   fXML->CleanNode(node);
   fXML->FreeNode(node);
@@ -487,6 +501,7 @@ XMLNodePointer_t nuisconfig::GetNode(std::string const &type) {
 
 std::vector<XMLNodePointer_t> nuisconfig::GetNodes(XMLNodePointer_t node,
                                                    std::string const &type) {
+  ConfigLock lock(*this);
   // Create new vector for nodes
   std::vector<XMLNodePointer_t> nodelist;
 
@@ -512,6 +527,9 @@ std::vector<XMLNodePointer_t> nuisconfig::GetNodes(std::string const &type) {
 
 void nuisconfig::Set(XMLNodePointer_t node, std::string const &name,
                      std::string const &val) {
+  ConfigLock lock(*this);
+  InvalidateConfigCache();
+
   // Remove and re-add attribute
   if (fXML->HasAttr(node, name.c_str())) {
     fXML->FreeAttr(node, name.c_str());
@@ -567,6 +585,7 @@ void nuisconfig::SetD(XMLNodePointer_t node, std::string const &name,
 }
 
 bool nuisconfig::Has(XMLNodePointer_t node, std::string const &name) {
+  ConfigLock lock(*this);
   // If node empty return empty
   if (node == 0) return false;
 
@@ -590,6 +609,7 @@ bool nuisconfig::Has(XMLNodePointer_t node, std::string const &name) {
 }
 
 std::string nuisconfig::Get(XMLNodePointer_t node, std::string const &name) {
+  ConfigLock lock(*this);
   // If node empty return empty
   if (node == 0) return "";
 
@@ -670,6 +690,7 @@ std::vector<double> nuisconfig::GetVD(XMLNodePointer_t node,
 }
 
 std::vector<std::string> nuisconfig::GetAllKeysForNode(XMLNodePointer_t node) {
+  ConfigLock lock(*this);
   //bool matching = true;
   XMLAttrPointer_t attr = fXML->GetFirstAttr(node);
   std::vector<std::string> keys;
@@ -683,19 +704,24 @@ std::vector<std::string> nuisconfig::GetAllKeysForNode(XMLNodePointer_t node) {
   return keys;
 }
 
-XMLNodePointer_t nuisconfig::GetConfigNode(std::string const &name) {
-  // Loop over children and look for name
+void nuisconfig::BuildConfigCache() {
+  fConfigCache.clear();
+
+  // Loop over children and index every config attribute. The first node
+  // holding a name wins, matching the old linear search order.
   XMLNodePointer_t child = fXML->GetChild(fMainNode);
   while (child != 0) {
     // Select only config parameters
     if (!std::string(fXML->GetNodeName(child)).compare("config")) {
-      // Loop over config attributes and search for name
       XMLAttrPointer_t attr = fXML->GetFirstAttr(child);
       while (attr != 0) {
-        // Save name value
-        if (std::string(fXML->GetAttrName(attr)) == name.c_str()) {
-          return child;
-        }
+        ConfigCacheEntry entry;
+        entry.node = child;
+        entry.s = fXML->GetAttrValue(attr);
+        entry.b = GeneralUtils::StrToBool(entry.s);
+        entry.i = GeneralUtils::StrToInt(entry.s);
+        entry.d = GeneralUtils::StrToDbl(entry.s);
+        fConfigCache.insert(std::make_pair(fXML->GetAttrName(attr), entry));
 
         // Get Next Attribute
         attr = fXML->GetNextAttr(attr);
@@ -706,7 +732,23 @@ XMLNodePointer_t nuisconfig::GetConfigNode(std::string const &name) {
     child = fXML->GetNext(child);
   }
 
-  return 0;
+  fConfigCacheValid = true;
+}
+
+nuisconfig::ConfigCacheEntry const *nuisconfig::FindConfigCache(
+    std::string const &name) {
+  if (!fConfigCacheValid) BuildConfigCache();
+
+  std::unordered_map<std::string, ConfigCacheEntry>::const_iterator it =
+      fConfigCache.find(name);
+  if (it == fConfigCache.end()) return NULL;
+  return &it->second;
+}
+
+XMLNodePointer_t nuisconfig::GetConfigNode(std::string const &name) {
+  ConfigLock lock(*this);
+  ConfigCacheEntry const *entry = FindConfigCache(name);
+  return entry ? entry->node : 0;
 }
 
 void nuisconfig::SetConfig(std::string const &name, std::string const &val) {
@@ -748,51 +790,44 @@ void nuisconfig::OverrideConfig(std::string const &conf) {
 }
 
 std::string nuisconfig::GetConfig(std::string const &name) {
-  XMLNodePointer_t node = GetConfigNode(name);
-  if (!node) return "";
-
-  XMLAttrPointer_t attr = fXML->GetFirstAttr(node);
-  std::string temp = "";
-
-  // Loop config attributes
-  while (attr != 0) {
-    // Find match
-    if (std::string(fXML->GetAttrName(attr)) == name.c_str()) {
-      temp = fXML->GetAttrValue(attr);
-    }
-
-    // Get Next Attribute
-    attr = fXML->GetNextAttr(attr);
-  }
-  return temp;
+  ConfigLock lock(*this);
+  ConfigCacheEntry const *entry = FindConfigCache(name);
+  return entry ? entry->s : "";
 }
 
 bool nuisconfig::HasConfig(std::string const &name) {
-  return bool(GetConfigNode(name));
+  ConfigLock lock(*this);
+  return bool(FindConfigCache(name));
 }
 
 std::string nuisconfig::GetConfigS(std::string const &name) {
   return GetConfig(name);
 }
 
+// Typed getters return the values parsed when the cache was built, unset
+// parameters parse an empty string as before.
 bool nuisconfig::GetConfigB(std::string const &name) {
-  std::string pars = GetConfig(name);
-  return GeneralUtils::StrToBool(pars);
+  ConfigLock lock(*this);
+  ConfigCacheEntry const *entry = FindConfigCache(name);
+  return entry ? entry->b : GeneralUtils::StrToBool("");
 }
 
 int nuisconfig::GetConfigI(std::string const &name) {
-  std::string pars = GetConfig(name);
-  return GeneralUtils::StrToInt(pars);
+  ConfigLock lock(*this);
+  ConfigCacheEntry const *entry = FindConfigCache(name);
+  return entry ? entry->i : GeneralUtils::StrToInt("");
 }
 
 float nuisconfig::GetConfigF(std::string const &name) {
-  std::string pars = GetConfig(name);
-  return GeneralUtils::StrToDbl(pars);
+  ConfigLock lock(*this);
+  ConfigCacheEntry const *entry = FindConfigCache(name);
+  return entry ? entry->d : GeneralUtils::StrToDbl("");
 }
 
 double nuisconfig::GetConfigD(std::string const &name) {
-  std::string pars = GetConfig(name);
-  return GeneralUtils::StrToDbl(pars);
+  ConfigLock lock(*this);
+  ConfigCacheEntry const *entry = FindConfigCache(name);
+  return entry ? entry->d : GeneralUtils::StrToDbl("");
 }
 
 std::string nuisconfig::GetParDIR(std::string const &parName) {
@@ -21,6 +21,8 @@
 
 #include <algorithm>
 #include <map>
+#include <mutex>
+#include <unordered_map>
 
 #include "TFile.h"
 #include "TXMLEngine.h"
@@ -154,6 +156,11 @@ class nuisconfig {
 
   std::string GetParDIR(std::string const &parName);
 
+  /// Serialise every read and write of the config so that samples can be
+  /// constructed on several threads. Off by default, as the lock is not
+  /// free.
+  inline void SetThreadSafe(bool safe) { fThreadSafe = safe; };
+
   TFile *out;
 
  private:
@@ -161,6 +168,39 @@ class nuisconfig {
   TXMLEngine *fXML;                       ///< ROOT XML Engine
   std::vector<XMLDocPointer_t> fXMLDocs;  ///< List of all XML document inputs
 
+  /// Parsed value of a single config parameter
+  struct ConfigCacheEntry {
+    XMLNodePointer_t node;  ///< Config node holding the attribute
+    std::string s;
+    bool b;
+    int i;
+    double d;
+  };
+
+  /// Rebuild the name -> value index from all config nodes
+  void BuildConfigCache();
+
+  /// Mark the index stale, it is rebuilt on the next config lookup
+  inline void InvalidateConfigCache() { fConfigCacheValid = false; };
+
+  /// Cached entry for name, or NULL if it is not set
+  ConfigCacheEntry const *FindConfigCache(std::string const &name);
+
+  std::unordered_map<std::string, ConfigCacheEntry> fConfigCache;
+  bool fConfigCacheValid;  ///< False after any change to the XML tree
+
+  /// Locks fMutex for the lifetime of an accessor, only while the config
+  /// is in thread safe mode.
+  struct ConfigLock {
+    ConfigLock(nuisconfig &config) : fLock(config.fMutex, std::defer_lock) {
+      if (config.fThreadSafe) fLock.lock();
+    };
+    std::unique_lock<std::recursive_mutex> fLock;
+  };
+
+  std::recursive_mutex fMutex;
+  bool fThreadSafe;  ///< Serialise access to the XML tree and cache
+
  protected:
   static nuisconfig *m_nuisconfigInstance;
 };
@@ -0,0 +1,289 @@
+#include "FCNSocket.h"
+#include "FitLogger.h"
+
+#include <arpa/inet.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <stdint.h>
+#include <sys/socket.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+// Guards against talking to something that is not a NUISANCE worker
+static const uint32_t kFCNSocketMagic = 0x4E554953; // "NUIS"
+
+struct FCNSocketHeader {
+  uint32_t magic;
+  uint32_t type;
+  uint64_t nvalues;
+  uint64_t ntext;
+};
+
+//***************************************************
+static bool ResolveAddress(std::string const &host, int port,
+                           struct sockaddr_in &addr) {
+  //***************************************************
+
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+
+  if (host.empty() || host == "*" || host == "0.0.0.0") {
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    return true;
+  }
+
+  if (inet_pton(AF_INET, host.c_str(), &addr.sin_addr) == 1) {
+    return true;
+  }
+
+  struct addrinfo hints;
+  std::memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = SOCK_STREAM;
+
+  struct addrinfo *res = NULL;
+  if (getaddrinfo(host.c_str(), NULL, &hints, &res) != 0 || !res) {
+    NUIS_ERR(WRN, "Could not resolve host " << host);
+    return false;
+  }
+  addr.sin_addr = ((struct sockaddr_in *)res->ai_addr)->sin_addr;
+  freeaddrinfo(res);
+  return true;
+}
+
+//***************************************************
+int FCNSocket::Listen(std::string const &host, int &port, int backlog) {
+  //***************************************************
+
+  struct sockaddr_in addr;
+  if (!ResolveAddress(host, port, addr)) {
+    return -1;
+  }
+
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) {
+    NUIS_ERR(WRN, "Could not create socket: " << std::strerror(errno));
+    return -1;
+  }
+
+  int on = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+
+  if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+      listen(fd, backlog) < 0) {
+    NUIS_ERR(WRN, "Could not listen on " << host << ":" << port << ": "
+                                         << std::strerror(errno));
+    close(fd);
+    return -1;
+  }
+
+  socklen_t len = sizeof(addr);
+  if (getsockname(fd, (struct sockaddr *)&addr, &len) == 0) {
+    port = ntohs(addr.sin_port);
+  }
+
+  return fd;
+}
+
+//***************************************************
+FCNSocket *FCNSocket::Accept(int listenfd, double timeout) {
+  //***************************************************
+
+  struct pollfd pfd;
+  pfd.fd = listenfd;
+  pfd.events = POLLIN;
+  pfd.revents = 0;
+
+  int ready;
+  do {
+    ready = poll(&pfd, 1, int(timeout * 1000));
+  } while (ready < 0 && errno == EINTR);
+
+  if (ready <= 0) {
+    return NULL;
+  }
+
+  int fd = accept(listenfd, NULL, NULL);
+  if (fd < 0) {
+    NUIS_ERR(WRN, "Could not accept connection: " << std::strerror(errno));
+    return NULL;
+  }
+
+  // Requests are small and latency bound
+  int on = 1;
+  setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+
+  return new FCNSocket(fd);
+}
+
+//***************************************************
+FCNSocket *FCNSocket::Connect(std::string const &host, int port,
+                              double timeout) {
+  //***************************************************
+
+  struct sockaddr_in addr;
+  if (!ResolveAddress(host, port, addr)) {
+    return NULL;
+  }
+
+  // The coordinator may still be starting, keep trying until timeout
+  for (double waited = 0.0; waited <= timeout; waited += 0.1) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+      NUIS_ERR(WRN, "Could not create socket: " << std::strerror(errno));
+      return NULL;
+    }
+
+    if (connect(fd, (struct sockaddr *)&addr, sizeof(addr)) == 0) {
+      int on = 1;
+      setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+      return new FCNSocket(fd);
+    }
+
+    close(fd);
+    usleep(100000);
+  }
+
+  NUIS_ERR(WRN, "Could not connect to " << host << ":" << port << " after "
+                                        << timeout << "s");
+  return NULL;
+}
+
+//***************************************************
+bool FCNSocket::ParseAddress(std::string const &address, std::string &host,
+                             int &port) {
+  //***************************************************
+
+  size_t colon = address.rfind(':');
+  if (colon == std::string::npos || colon + 1 == address.size()) {
+    return false;
+  }
+
+  host = address.substr(0, colon);
+  port = std::atoi(address.substr(colon + 1).c_str());
+  return port > 0;
+}
+
+//***************************************************
+bool FCNSocket::SendAll(void const *buf, size_t n) {
+  //***************************************************
+
+  char const *data = (char const *)buf;
+  while (n) {
+    ssize_t sent = send(fFD, data, n, MSG_NOSIGNAL);
+    if (sent < 0 && errno == EINTR) {
+      continue;
+    }
+    if (sent <= 0) {
+      return false;
+    }
+    data += sent;
+    n -= sent;
+  }
+  return true;
+}
+
+//***************************************************
+bool FCNSocket::RecvAll(void *buf, size_t n) {
+  //***************************************************
+
+  char *data = (char *)buf;
+  while (n) {
+    ssize_t got = recv(fFD, data, n, 0);
+    if (got < 0 && errno == EINTR) {
+      continue;
+    }
+    if (got <= 0) {
+      return false;
+    }
+    data += got;
+    n -= got;
+  }
+  return true;
+}
+
+//***************************************************
+bool FCNSocket::Send(int type, std::vector<double> const &values,
+                     std::string const &text) {
+  //***************************************************
+
+  if (fFD < 0) {
+    return false;
+  }
+
+  FCNSocketHeader header;
+  header.magic = kFCNSocketMagic;
+  header.type = type;
+  header.nvalues = values.size();
+  header.ntext = text.size();
+
+  return SendAll(&header, sizeof(header)) &&
+         (values.empty() ||
+          SendAll(&values[0], values.size() * sizeof(double))) &&
+         (text.empty() || SendAll(text.data(), text.size()));
+}
+
+//***************************************************
+bool FCNSocket::Receive(int &type, std::vector<double> &values,
+                        std::string &text) {
+  //***************************************************
+
+  if (fFD < 0) {
+    return false;
+  }
+
+  FCNSocketHeader header;
+  if (!RecvAll(&header, sizeof(header))) {
+    return false;
+  }
+
+  if (header.magic != kFCNSocketMagic) {
+    NUIS_ERR(WRN, "Received a message that is not from a NUISANCE FCN.");
+    return false;
+  }
+
+  type = header.type;
+
+  values.resize(header.nvalues);
+  if (header.nvalues &&
+      !RecvAll(&values[0], header.nvalues * sizeof(double))) {
+    return false;
+  }
+
+  text.resize(header.ntext);
+  if (header.ntext && !RecvAll(&text[0], header.ntext)) {
+    return false;
+  }
+
+  return true;
+}
+
+//***************************************************
+bool FCNSocket::Request(int type, std::vector<double> const &values,
+                        std::string const &text, std::vector<double> &reply,
+                        std::string &replytext) {
+  //***************************************************
+
+  int replytype = 0;
+  if (!Send(type, values, text) || !Receive(replytype, reply, replytext)) {
+    replytext = "connection lost";
+    return false;
+  }
+  return replytype == kReply;
+}
+
+//***************************************************
+void FCNSocket::Close() {
+  //***************************************************
+
+  if (fFD >= 0) {
+    close(fFD);
+    fFD = -1;
+  }
+}
@@ -0,0 +1,72 @@
+#ifndef _FCN_SOCKET_H_
+#define _FCN_SOCKET_H_
+/*!
+ *  \addtogroup FCN
+ *  @{
+ */
+
+#include <string>
+#include <vector>
+
+//! Framed messages over a TCP stream, used between a distributed JointFCN
+//! coordinator and the worker processes that own its samples.
+//!
+//! Each message is a type, a block of doubles and a block of text. Doubles
+//! are sent in host byte order, so every process in one fit must run on the
+//! same architecture.
+class FCNSocket {
+public:
+  enum MessageType {
+    kHello = 1, //!< Worker -> coordinator: index, NDOFs and sample names
+    kEval,      //!< Full flag then dial values, reply likelihoods and NDOFs
+    kFakeData,  //!< Text is the fake data input, reply as kEval
+    kThrowToy,  //!< Throw a data toy in every sample, reply as kEval
+    kWrite,     //!< Text is the directory to write the samples into
+    kStop,      //!< Worker exits after replying
+    kReply,     //!< Success, with any values the request returns
+    kError      //!< Failure, text holds the reason
+  };
+
+  //! Take ownership of an open socket descriptor
+  explicit FCNSocket(int fd = -1) : fFD(fd){};
+  ~FCNSocket() { Close(); };
+
+  //! Listen on host:port. A port of 0 picks a free one and returns it in
+  //! port. Returns the listening descriptor, or -1 on failure.
+  static int Listen(std::string const &host, int &port, int backlog);
+
+  //! Wait up to timeout seconds for a connection on a listening descriptor.
+  //! Returns NULL on timeout or failure.
+  static FCNSocket *Accept(int listenfd, double timeout);
+
+  //! Connect to host:port, retrying for up to timeout seconds while the
+  //! other end is not listening yet. Returns NULL on failure.
+  static FCNSocket *Connect(std::string const &host, int port,
+                            double timeout);
+
+  //! Split "host:port". Returns false if there is no port.
+  static bool ParseAddress(std::string const &address, std::string &host,
+                           int &port);
+
+  bool Send(int type, std::vector<double> const &values,
+            std::string const &text = "");
+  bool Receive(int &type, std::vector<double> &values, std::string &text);
+
+  //! Send a request and wait for its reply. Returns false on a broken
+  //! connection or a kError reply, leaving the reason in text.
+  bool Request(int type, std::vector<double> const &values,
+               std::string const &text, std::vector<double> &reply,
+               std::string &replytext);
+
+  inline bool IsOpen() const { return fFD >= 0; };
+  void Close();
+
+private:
+  bool SendAll(void const *buf, size_t n);
+  bool RecvAll(void *buf, size_t n);
+
+  int fFD;
+};
+
+/*! @} */
+#endif // _FCN_SOCKET_H_
@@ -1,6 +1,48 @@
 #include "JointFCN.h"
 #include "FitUtils.h"
+#include "InputFactory.h"
+#include "SplineWeightEngine.h"
+#include "WeightUtils.h"
+#include "MeasurementVariableBox2D.h"
+#include "TFile.h"
+#include "TROOT.h"
+#include "TRandom.h"
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <iomanip>
+#include <sstream>
 #include <stdio.h>
+#include <sys/wait.h>
+#include <typeinfo>
+#include <unistd.h>
+
+// Dial step for numeric gradients, and the step along each analytic MC bin
+// derivative, in dial units
+static const double kGradientStep = 1E-2;
+// Relative agreement CheckGradient requires of the two
+static const double kGradientTolerance = 5E-2;
+
+//***************************************************
+static int GetManagerThreads() {
+  //***************************************************
+
+  int nthreads = 1;
+  if (FitPar::Config().HasConfig("NThreads")) {
+    nthreads = FitPar::Config().GetParI("NThreads");
+  }
+
+#ifndef __USE_OPENMP__
+  if (nthreads > 1) {
+    NUIS_ERR(WRN, "NThreads = " << nthreads
+                                << " requested but NUISANCE was built without "
+                                   "OpenMP. Reconfigures will run serially.");
+  }
+  nthreads = 1;
+#endif
+
+  return nthreads > 1 ? nthreads : 1;
+}
 
 //***************************************************
 JointFCN::JointFCN(TFile *outfile) {
@@ -11,10 +53,25 @@ JointFCN::JointFCN(TFile *outfile) {
     Config::Get().out = outfile;
 
   std::vector<nuiskey> samplekeys = Config::QueryKeys("sample");
-  LoadSamples(samplekeys);
 
-  std::vector<nuiskey> covarkeys = Config::QueryKeys("covar");
-  LoadPulls(covarkeys);
+  // A distributed coordinator leaves its samples to the workers, and a
+  // remote worker only loads its share and no pulls.
+  int nworkers = FitPar::Config().GetParI("DistributedWorkers");
+  std::string coordinator = FitPar::Config().GetParS("DistributedCoordinator");
+  int workerindex = FitPar::Config().GetParI("DistributedWorkerIndex");
+
+  if (!coordinator.empty()) {
+    LoadSamples(GetWorkerSampleKeys(samplekeys, workerindex, nworkers));
+  } else if (nworkers > 0) {
+    LoadSamples(std::vector<nuiskey>());
+  } else {
+    LoadSamples(samplekeys);
+  }
+
+  if (coordinator.empty()) {
+    std::vector<nuiskey> covarkeys = Config::QueryKeys("covar");
+    LoadPulls(covarkeys);
+  }
 
   fCurIter = 0;
   fMCFilled = false;
@@ -22,9 +79,33 @@ JointFCN::JointFCN(TFile *outfile) {
   fIterationTree = false;
   fDialVals = NULL;
   fNDials = 0;
+  fNSignalEvents = 0;
 
   fUsingEventManager = FitPar::Config().GetParB("EventManager");
+  fNThreads = GetManagerThreads();
   fOutputDir->cd();
+
+  if (!coordinator.empty()) {
+    // Remote worker, started by hand with the coordinator's card
+    std::string host;
+    int port = 0;
+    if (!FCNSocket::ParseAddress(coordinator, host, port)) {
+      NUIS_ABORT("DistributedCoordinator should be host:port, not "
+                 << coordinator);
+    }
+
+    FCNSocket *socket = FCNSocket::Connect(
+        host, port, FitPar::Config().GetParD("DistributedTimeout"));
+    if (!socket) {
+      NUIS_ABORT("Could not reach the coordinator at " << coordinator);
+    }
+    ServeDistributed(socket, workerindex);
+    delete socket;
+    exit(0);
+
+  } else if (nworkers > 0) {
+    StartDistributedWorkers(samplekeys, nworkers);
+  }
 }
 
 //***************************************************
@@ -45,8 +126,10 @@ JointFCN::JointFCN(std::vector<nuiskey> samplekeys, TFile *outfile) {
   fIterationTree = false;
   fDialVals = NULL;
   fNDials = 0;
+  fNSignalEvents = 0;
 
   fUsingEventManager = FitPar::Config().GetParB("EventManager");
+  fNThreads = GetManagerThreads();
   fOutputDir->cd();
 }
 
@@ -54,6 +137,8 @@ JointFCN::JointFCN(std::vector<nuiskey> samplekeys, TFile *outfile) {
 JointFCN::~JointFCN() {
   //***************************************************
 
+  StopDistributedWorkers();
+
   // Delete Samples
   for (MeasListConstIter iter = fSamples.begin(); iter != fSamples.end();
        iter++) {
@@ -66,6 +151,22 @@ JointFCN::~JointFCN() {
     delete pull;
   }
 
+  ClearSignalSplineStores();
+
+  // The first reader of each input is the input itself
+  for (size_t i = 0; i < fInputReaders.size(); i++) {
+    for (size_t j = 1; j < fInputReaders[i].size(); j++) {
+      delete fInputReaders[i][j];
+    }
+  }
+
+  // Samples are gone so nothing can still point at a saved custom box
+  for (size_t i = 0; i < fSignalCache.size(); i++) {
+    for (size_t j = 0; j < fSignalCache[i].fBoxes.size(); j++) {
+      delete fSignalCache[i].fBoxes[j];
+    }
+  }
+
   // Sort Tree
   if (fIterationTree)
     DestroyIterationTree();
@@ -98,6 +199,14 @@ void JointFCN::CreateIterationTree(std::string name, FitWeight *rw) {
     fCurrentValues.push_back(0.0);
   }
 
+  // Samples owned by distributed workers
+  for (size_t i = 0; i < fRemoteNames.size(); i++) {
+    fNameValues.push_back(fRemoteNames[i] + "_likelihood");
+    fCurrentValues.push_back(0.0);
+    fNameValues.push_back(fRemoteNames[i] + "_ndof");
+    fCurrentValues.push_back(0.0);
+  }
+
   // Add Pull terms
   for (PullListConstIter iter = fPulls.begin(); iter != fPulls.end(); iter++) {
     ParamPull *pull = *iter;
@@ -120,7 +229,7 @@ void JointFCN::CreateIterationTree(std::string name, FitWeight *rw) {
   fCurrentValues.push_back(0.0);
 
   // Setup Containers
-  fSampleN = fSamples.size() + fPulls.size();
+  fSampleN = fSamples.size() + fRemoteNames.size() + fPulls.size();
   fSampleLikes = new double[fSampleN+1];
   fSampleNDOF = new int[fSampleN+1];
 
@@ -133,6 +242,25 @@ void JointFCN::CreateIterationTree(std::string name, FitWeight *rw) {
   fNDials = dials.size();
   fDialVals = new double[fNDials];
 
+  // Add stage timings, totals then the per sample stages
+  for (int i = 0; i < FCNStageTimer::kNStages; i++) {
+    fNameValues.push_back(
+        "time_" + FCNStageTimer::GetStageName(FCNStageTimer::Stage(i)));
+    fCurrentValues.push_back(0.0);
+  }
+  fNameValues.push_back("time_total");
+  fCurrentValues.push_back(0.0);
+
+  for (int i = 0; i < fTimer.GetNSamples(); i++) {
+    std::string name = fTimer.GetSampleName(i);
+    fNameValues.push_back(name + "_time_fill");
+    fCurrentValues.push_back(0.0);
+    fNameValues.push_back(name + "_time_convert");
+    fCurrentValues.push_back(0.0);
+    fNameValues.push_back(name + "_time_likelihood");
+    fCurrentValues.push_back(0.0);
+  }
+
   // Set IterationTree Flag
   fIterationTree = true;
 }
@@ -205,29 +333,50 @@ void JointFCN::FillIterationTree(FitWeight *rw) {
     fCurrentValues[count++] = double(fDialVals[i]);
   }
 
+  // Stage timings of this evaluation
+  for (int i = 0; i < FCNStageTimer::kNStages; i++) {
+    fCurrentValues[count++] = fTimer.GetEval(FCNStageTimer::Stage(i));
+  }
+  fCurrentValues[count++] = fTimer.GetEvalTotal();
+
+  for (int i = 0; i < fTimer.GetNSamples(); i++) {
+    fCurrentValues[count++] =
+        fTimer.GetEvalSample(FCNStageTimer::kFill, i);
+    fCurrentValues[count++] =
+        fTimer.GetEvalSample(FCNStageTimer::kConvert, i);
+    fCurrentValues[count++] =
+        fTimer.GetEvalSample(FCNStageTimer::kLikelihood, i);
+  }
+
   // Push Back Into Container
   fIterationCount.push_back(fCurIter);
   fIterationValues.push_back(fCurrentValues);
 }
 
 //***************************************************
-double JointFCN::DoEval(const double *x) {
+void JointFCN::GetParameterValues(const double *x, double *par_vals,
+                                  bool *mirrored) {
   //***************************************************
 
-  double *par_vals = new double[fNPars];
-
   for (int i = 0; i < fNPars; ++i) {
+    if (mirrored)
+      mirrored[i] = false;
+
     if (fMirroredParams.count(i)) {
       if (!fMirroredParams[i].mirror_above &&
           (x[i] < fMirroredParams[i].mirror_value)) {
         double xabove = fMirroredParams[i].mirror_value - x[i];
         par_vals[i] = fMirroredParams[i].mirror_value + xabove;
+        if (mirrored)
+          mirrored[i] = true;
         std::cout << "\t--Parameter " << i << " mirrored from " << x[i]
                   << " -> " << par_vals[i] << std::endl;
       } else if (fMirroredParams[i].mirror_above &&
                  (x[i] >= fMirroredParams[i].mirror_value)) {
         double xabove = x[i] - fMirroredParams[i].mirror_value;
         par_vals[i] = fMirroredParams[i].mirror_value - xabove;
+        if (mirrored)
+          mirrored[i] = true;
         std::cout << "\t--Parameter " << i << " mirrored from " << x[i]
                   << " -> " << par_vals[i] << std::endl;
       } else {
@@ -237,14 +386,27 @@ double JointFCN::DoEval(const double *x) {
       par_vals[i] = x[i];
     }
   }
+}
+
+//***************************************************
+double JointFCN::DoEval(const double *x) {
+  //***************************************************
+
+  FCNStageTimer::clock::time_point evalstart = FCNStageTimer::Now();
+  fTimer.StartEval();
+
+  double *par_vals = new double[fNPars];
+  GetParameterValues(x, par_vals);
 
   // WEIGHT ENGINE
+  FCNStageTimer::clock::time_point start = FCNStageTimer::Now();
   fDialChanged = FitBase::GetRW()->HasRWDialChanged(par_vals);
   FitBase::GetRW()->UpdateWeightEngine(par_vals);
   if (fDialChanged) {
     FitBase::GetRW()->Reconfigure();
     FitBase::EvtManager().ResetWeightFlags();
   }
+  fTimer.Add(FCNStageTimer::kRWReconfigure, FCNStageTimer::Since(start));
   if (LOG_LEVEL(REC)) {
     FitBase::GetRW()->Print();
   }
@@ -261,6 +423,7 @@ double JointFCN::DoEval(const double *x) {
            "Current Stat (iter. " << this->fCurIter << ") = " << fLikelihood);
 
   // UPDATE TREE
+  fTimer.EndEval(FCNStageTimer::Since(evalstart));
   if (fIterationTree)
     FillIterationTree(FitBase::GetRW());
 
@@ -269,6 +432,376 @@ double JointFCN::DoEval(const double *x) {
   return fLikelihood;
 }
 
+//***************************************************
+bool JointFCN::CanUseAnalyticGradient() {
+  //***************************************************
+
+  if (IsDistributed() || !fUsingEventManager ||
+      !FitPar::Config().GetParB("SignalReconfigures"))
+    return false;
+
+  // Inputs and signal stores are only known after the first reconfigure
+  if (!fMCFilled)
+    ReconfigureAllEvents();
+
+  if (!fIsAllSplines || !fNSignalEvents)
+    return false;
+
+  // Weight derivatives are added into the bins each event filled
+  for (size_t isample = 0; isample < fSignalCache.size(); isample++) {
+    SampleSignalCache const &cache = fSignalCache[isample];
+    if (!cache.GetNEvents())
+      continue;
+    if (cache.fCustomBox)
+      return false;
+    for (size_t j = 0; j < cache.GetNEvents(); j++) {
+      if (cache.fBins[2 * j] < 0)
+        return false;
+    }
+  }
+
+  for (size_t i = 0; i < fSignalSplineStores.size(); i++) {
+    if (fSignalSplineStores[i])
+      return true;
+  }
+  return false;
+}
+
+//***************************************************
+double JointFCN::DoEvalGradient(const double *x, double *grad,
+                                bool evaluated) {
+  //***************************************************
+
+  // Function value, which also brings the readers and samples to x
+  double like = evaluated ? fLikelihood : DoEval(x);
+
+  std::vector<double> par_vals(fNPars, 0.0);
+  bool *mirrored = new bool[fNPars];
+  GetParameterValues(x, &par_vals[0], mirrored);
+
+  FitWeight *rw = FitBase::GetRW();
+  std::vector<int> enums = rw->GetDialEnums();
+  std::vector<std::string> names = rw->GetDialNames();
+
+  SplineWeightEngine *splinerw = NULL;
+  if (CanUseAnalyticGradient() && rw->HasRWEngine(kSPLINEPARAMETER)) {
+    splinerw = static_cast<SplineWeightEngine *>(
+        rw->GetRWEngine(kSPLINEPARAMETER));
+  }
+
+  // Find the spline dials whose splines all have an analytic derivative,
+  // and which splines they move in each input.
+  std::vector<int> analytic;
+  std::vector<bool> isanalytic(fNPars, false);
+  std::vector<std::vector<std::vector<int> > > dialsplines(fInputList.size());
+  for (int ipar = 0; splinerw && ipar < fNPars; ipar++) {
+    if (fFixedParams[ipar] ||
+        Reweight::GetDialType(enums[ipar]) != kSPLINEPARAMETER)
+      continue;
+
+    std::vector<size_t> const &indices = splinerw->fNameIndex[names[ipar]];
+    bool hasderivative = true;
+    std::vector<std::vector<int> > inputsplines(fInputList.size());
+
+    for (size_t iinput = 0; iinput < fSignalSplineStores.size(); iinput++) {
+      if (!fSignalSplineStores[iinput])
+        continue;
+
+      SplineReader *reader = fSignalSplineStores[iinput]->GetReader();
+      for (size_t ispl = 0; ispl < reader->fAllSplines.size(); ispl++) {
+        Spline const &spl = reader->fAllSplines[ispl];
+        bool moves = false;
+        for (size_t j = 0; j < indices.size() && !moves; j++) {
+          moves = (std::find(spl.fSplitNames.begin(), spl.fSplitNames.end(),
+                             splinerw->fSingleNames[indices[j]]) !=
+                   spl.fSplitNames.end());
+        }
+        if (!moves)
+          continue;
+
+        if (spl.fNDim != 1 || !spl.HasColumnDerivative())
+          hasderivative = false;
+        inputsplines[iinput].push_back(ispl);
+      }
+    }
+
+    if (!hasderivative)
+      continue;
+
+    analytic.push_back(ipar);
+    isanalytic[ipar] = true;
+    for (size_t iinput = 0; iinput < fInputList.size(); iinput++) {
+      dialsplines[iinput].push_back(inputsplines[iinput]);
+    }
+  }
+
+  if (!analytic.empty()) {
+    int nsignal = fNSignalEvents;
+    int nanalytic = analytic.size();
+    int nsamples = fSubSampleList.size();
+
+    // Index the saved fills by signal event, so that each weight derivative
+    // can be added straight into the MC bins its event filled.
+    std::vector<int> fillstart(nsignal + 1, 0);
+    for (int isample = 0; isample < nsamples; isample++) {
+      std::vector<int> const &events = fSignalCache[isample].fEvent;
+      for (size_t j = 0; j < events.size(); j++) {
+        fillstart[events[j] + 1]++;
+      }
+    }
+    for (int i = 0; i < nsignal; i++) {
+      fillstart[i + 1] += fillstart[i];
+    }
+
+    std::vector<int> fillsample(fillstart[nsignal]);
+    std::vector<int> fillentry(fillstart[nsignal]);
+    std::vector<int> nextfill(fillstart.begin(), fillstart.end() - 1);
+    std::vector<int> nbins(nsamples, 0);
+    for (int isample = 0; isample < nsamples; isample++) {
+      SampleSignalCache const &cache = fSignalCache[isample];
+      for (size_t j = 0; j < cache.GetNEvents(); j++) {
+        int f = nextfill[cache.fEvent[j]]++;
+        fillsample[f] = isample;
+        fillentry[f] = j;
+        nbins[isample] = std::max(nbins[isample], cache.fBins[2 * j] + 1);
+      }
+    }
+
+    // d(MC bin)/d(dial) and d(MC bin error^2)/d(dial) of each sample, as
+    // [k * nbins + bin], summed per thread as the derivatives are made.
+    int nthreads = std::max(1, fNThreads);
+    std::vector<std::vector<std::vector<double> > > dmc(
+        nthreads, std::vector<std::vector<double> >(nsamples));
+    std::vector<std::vector<std::vector<double> > > derr2(dmc);
+    for (int t = 0; t < nthreads; t++) {
+      for (int isample = 0; isample < nsamples; isample++) {
+        dmc[t][isample].assign(size_t(nanalytic) * nbins[isample], 0.0);
+        derr2[t][isample].assign(size_t(nanalytic) * nbins[isample], 0.0);
+      }
+    }
+
+    std::vector<double> weights(nsignal, 1.0);
+    SignalDerivativeSink sink = [&](int first, int n,
+                                    double const *const *derivs) {
+      int thread = omp_get_thread_num();
+      for (int i = 0; i < n; i++) {
+        int event = first + i;
+        for (int f = fillstart[event]; f < fillstart[event + 1]; f++) {
+          int isample = fillsample[f];
+          SampleSignalCache const &cache = fSignalCache[isample];
+          int j = fillentry[f];
+          int bin = cache.fBins[2 * j];
+          double sampleweight = cache.fSampleWeight[j];
+          double weight = weights[event] * sampleweight;
+
+          double *mc = &dmc[thread][isample][bin];
+          double *err2 = &derr2[thread][isample][bin];
+          for (int k = 0; k < nanalytic; k++) {
+            double dweight = derivs[k][i] * sampleweight;
+            mc[size_t(k) * nbins[isample]] += dweight;
+            err2[size_t(k) * nbins[isample]] += 2.0 * weight * dweight;
+          }
+        }
+      }
+    };
+    CalcSignalSplineWeights(&weights[0], &dialsplines, &sink);
+
+    for (int t = 1; t < nthreads; t++) {
+      for (int isample = 0; isample < nsamples; isample++) {
+        for (size_t b = 0; b < dmc[t][isample].size(); b++) {
+          dmc[0][isample][b] += dmc[t][isample][b];
+          derr2[0][isample][b] += derr2[t][isample][b];
+        }
+      }
+    }
+
+    // One fill at x, kept before conversion
+    FillSignalEvents(&weights[0], false);
+    std::vector<int> ncells(nsamples, -1);
+    bool saved = true;
+    for (int isample = 0; isample < nsamples; isample++) {
+      int nfill = fSignalCache[isample].GetNEvents();
+      ncells[isample] = fSubSampleList[isample]->SaveBinFills(nfill);
+      if (nfill && ncells[isample] < nbins[isample])
+        saved = false;
+    }
+
+    if (saved) {
+      // Chain rule through ConvertEventRates and the likelihoods: each is
+      // differenced along the MC bin derivatives, which stays correct for
+      // shape-only normalisation, Poisson likelihoods and MC stat errors,
+      // and needs no further event loops.
+      std::vector<double> shift, shifterr2;
+      for (int k = 0; k < nanalytic; k++) {
+        double sidelike[2];
+        for (int side = 0; side < 2; side++) {
+          double eps = side ? -kGradientStep : kGradientStep;
+          for (int isample = 0; isample < nsamples; isample++) {
+            if (ncells[isample] < 0)
+              continue;
+            shift.assign(ncells[isample], 0.0);
+            shifterr2.assign(ncells[isample], 0.0);
+            size_t koffset = size_t(k) * nbins[isample];
+            for (int b = 0; b < nbins[isample]; b++) {
+              shift[b] = eps * dmc[0][isample][koffset + b];
+              shifterr2[b] = eps * derr2[0][isample][koffset + b];
+            }
+            fSubSampleList[isample]->RestoreBinFills(&shift[0],
+                                                     &shifterr2[0]);
+          }
+          ConvertSampleEventRates();
+          sidelike[side] = GetSampleLikelihood();
+        }
+        grad[analytic[k]] =
+            (sidelike[0] - sidelike[1]) / (2.0 * kGradientStep);
+      }
+
+      // Leave the samples at x
+      for (int isample = 0; isample < nsamples; isample++) {
+        if (ncells[isample] >= 0)
+          fSubSampleList[isample]->RestoreBinFills();
+      }
+      ConvertSampleEventRates();
+
+    } else {
+      // A sample could not keep its fills, difference these dials too
+      NUIS_LOG(REC, "Samples cannot be restored by bin, using numeric "
+                    "gradients.");
+      ConvertSampleEventRates();
+      for (int k = 0; k < nanalytic; k++) {
+        isanalytic[analytic[k]] = false;
+      }
+      analytic.clear();
+    }
+
+    for (size_t k = 0; k < analytic.size(); k++) {
+      int ipar = analytic[k];
+
+      // Pulls depend on the dial value itself
+      if (!fPulls.empty()) {
+        grad[ipar] +=
+            (GetPullLikelihood(ipar, par_vals[ipar] + kGradientStep) -
+             GetPullLikelihood(ipar, par_vals[ipar] - kGradientStep)) /
+            (2.0 * kGradientStep);
+      }
+
+      // Derivative with respect to the minimizer's value
+      if (mirrored[ipar])
+        grad[ipar] = -grad[ipar];
+    }
+  }
+
+  // Everything else from central differences of full evaluations
+  std::vector<double> xshift(x, x + fNPars);
+  bool moved = false;
+  for (int ipar = 0; ipar < fNPars; ipar++) {
+    if (isanalytic[ipar])
+      continue;
+
+    if (fFixedParams[ipar]) {
+      grad[ipar] = 0.0;
+      continue;
+    }
+
+    xshift[ipar] = x[ipar] + kGradientStep;
+    double up = DoEval(&xshift[0]);
+    xshift[ipar] = x[ipar] - kGradientStep;
+    double down = DoEval(&xshift[0]);
+    xshift[ipar] = x[ipar];
+
+    grad[ipar] = (up - down) / (2.0 * kGradientStep);
+    moved = true;
+  }
+
+  if (moved) {
+    DoEval(x);
+  }
+
+  NUIS_LOG(REC, "Gradient from " << analytic.size() << " analytic and "
+                                 << fNPars - int(analytic.size())
+                                 << " numeric components.");
+
+  delete[] mirrored;
+  return like;
+}
+
+//***************************************************
+bool JointFCN::CheckGradient(const double *x) {
+  //***************************************************
+
+  // These evaluations are not fit iterations, keep them out of the tree
+  bool savetree = fIterationTree;
+  fIterationTree = false;
+
+  std::vector<double> grad(fNPars, 0.0);
+  DoEvalGradient(x, &grad[0]);
+
+  std::vector<std::string> names = FitBase::GetRW()->GetDialNames();
+  std::vector<double> xshift(x, x + fNPars);
+  bool agree = true;
+
+  for (int ipar = 0; ipar < fNPars; ipar++) {
+    if (fFixedParams[ipar])
+      continue;
+
+    xshift[ipar] = x[ipar] + kGradientStep;
+    double up = DoEval(&xshift[0]);
+    xshift[ipar] = x[ipar] - kGradientStep;
+    double down = DoEval(&xshift[0]);
+    xshift[ipar] = x[ipar];
+
+    double numeric = (up - down) / (2.0 * kGradientStep);
+    double scale = std::max(1.0, std::max(fabs(numeric), fabs(grad[ipar])));
+    if (fabs(numeric - grad[ipar]) > kGradientTolerance * scale) {
+      NUIS_ERR(WRN, "Gradient of " << names[ipar] << " differs : analytic "
+                                   << grad[ipar] << ", numeric " << numeric);
+      agree = false;
+    }
+  }
+
+  DoEval(x);
+  fIterationTree = savetree;
+  return agree;
+}
+
+//***************************************************
+double JointFCN::GetSampleLikelihood() {
+  //***************************************************
+
+  double like = 0.0;
+  for (MeasListConstIter iter = fSamples.begin(); iter != fSamples.end();
+       iter++) {
+    like += (*iter)->GetLikelihood();
+  }
+  return like;
+}
+
+//***************************************************
+double JointFCN::GetPullLikelihood(int ipar, double val) {
+  //***************************************************
+
+  // Pulls are given the shifted values directly, setting the dial would
+  // change the engines' versions and drop their caches.
+  FitWeight *rw = FitBase::GetRW();
+  std::vector<std::string> names = rw->GetDialNames();
+  std::vector<double> values = rw->GetDialValues();
+  double nominal = values[ipar];
+
+  values[ipar] = val;
+  double like = 0.0;
+  for (PullListConstIter iter = fPulls.begin(); iter != fPulls.end(); iter++) {
+    (*iter)->Reconfigure(names, values);
+    like += (*iter)->GetLikelihood();
+  }
+
+  values[ipar] = nominal;
+  for (PullListConstIter iter = fPulls.begin(); iter != fPulls.end(); iter++) {
+    (*iter)->Reconfigure(names, values);
+  }
+
+  return like;
+}
+
 //***************************************************
 int JointFCN::GetNDOF() {
   //***************************************************
@@ -292,6 +825,15 @@ int JointFCN::GetNDOF() {
     count++;
   }
 
+  // Samples owned by distributed workers
+  for (size_t i = 0; i < fRemoteNDOF.size(); i++) {
+    if (fIterationTree) {
+      fSampleNDOF[count] = fRemoteNDOF[i];
+    }
+    totaldof += fRemoteNDOF[i];
+    count++;
+  }
+
   // Loop over pulls
   for (PullListConstIter iter = fPulls.begin(); iter != fPulls.end(); iter++) {
     ParamPull *pull = *iter;
@@ -328,7 +870,9 @@ double JointFCN::GetLikelihood() {
   for (MeasListConstIter iter = fSamples.begin(); iter != fSamples.end();
        iter++) {
     MeasurementBase *exp = *iter;
+    FCNStageTimer::clock::time_point start = FCNStageTimer::Now();
     double newlike = exp->GetLikelihood();
+    fTimer.Add(FCNStageTimer::kLikelihood, FCNStageTimer::Since(start), count);
     int ndof = exp->GetNDOF();
     // Save separate likelihoods
     if (fIterationTree) {
@@ -346,10 +890,25 @@ double JointFCN::GetLikelihood() {
     count++;
   }
 
+  // Samples owned by distributed workers, evaluated in the last reconfigure
+  for (size_t i = 0; i < fRemoteLikes.size(); i++) {
+    if (fIterationTree) {
+      fSampleLikes[count] = fRemoteLikes[i];
+    }
+
+    NUIS_LOG(MIN, "|-> " << std::left << std::setw(49) << fRemoteNames[i]
+                         << " : " << fRemoteLikes[i] << "/" << fRemoteNDOF[i]);
+
+    like += fRemoteLikes[i];
+    count++;
+  }
+
   // Loop over pulls
   for (PullListConstIter iter = fPulls.begin(); iter != fPulls.end(); iter++) {
     ParamPull *pull = *iter;
+    FCNStageTimer::clock::time_point start = FCNStageTimer::Now();
     double newlike = pull->GetLikelihood();
+    fTimer.Add(FCNStageTimer::kLikelihood, FCNStageTimer::Since(start));
 
     // Save separate likelihoods
     if (fIterationTree) {
@@ -372,28 +931,118 @@ double JointFCN::GetLikelihood() {
 
 void JointFCN::LoadSamples(std::vector<nuiskey> samplekeys) {
   NUIS_LOG(MIN, "Loading Samples : " << samplekeys.size());
-  for (size_t i = 0; i < samplekeys.size(); i++) {
-    nuiskey key = samplekeys[i];
 
-    // Get Sample Options
-    std::string samplename = key.GetS("name");
-    std::string samplefile = key.GetS("input");
-    std::string sampletype = key.GetS("type");
-    std::string fakeData = "";
+  int nsamples = samplekeys.size();
+  int nthreads = 1;
+  if (FitPar::Config().HasConfig("SampleLoadThreads")) {
+    nthreads = FitPar::Config().GetParI("SampleLoadThreads");
+  }
+#ifndef __USE_OPENMP__
+  if (nthreads > 1) {
+    NUIS_ERR(WRN, "SampleLoadThreads = "
+                      << nthreads
+                      << " requested but NUISANCE was built without OpenMP. "
+                         "Samples will be loaded serially.");
+  }
+  nthreads = 1;
+#endif
+  nthreads = std::max(1, std::min(nthreads, nsamples));
+
+  // Samples built on other threads must not touch shared ROOT directories
+  // or the config unguarded. Their histograms are left unattached, which
+  // only matters for ownership as every sample writes its own.
+  bool adddirectory = TH1::AddDirectoryStatus();
+  if (nthreads > 1) {
+    NUIS_LOG(MIN, "Constructing samples on " << nthreads << " threads");
+    ROOT::EnableThreadSafety();
+    Config::Get().SetThreadSafe(true);
+    TH1::AddDirectory(kFALSE);
+
+    // Scan the sample plugins once up front, lookups are read only after
+    DynamicSampleFactory::Get();
+  }
+
+  std::vector<MeasurementBase *> loaded(nsamples, NULL);
+  std::vector<double> loadtime(nsamples, 0.0);
+  FCNStageTimer::clock::time_point loadstart = FCNStageTimer::Now();
 
-    NUIS_LOG(MIN, "Loading Sample : " << samplename);
+  // An exception cannot leave the parallel region, so the first one is kept
+  // and rethrown once the shared state has been restored.
+  std::exception_ptr loaderror;
+  std::mutex loaderrorlock;
 
+#ifdef __USE_OPENMP__
+#pragma omp parallel for schedule(dynamic) num_threads(nthreads)
+#endif
+  for (int i = 0; i < nsamples; i++) {
+    nuiskey key = samplekeys[i];
+    FCNStageTimer::clock::time_point start = FCNStageTimer::Now();
+
+    NUIS_LOG(MIN, "Loading Sample : " << key.GetS("name"));
+
+    if (nthreads == 1)
+      fOutputDir->cd();
+    try {
+      loaded[i] = SampleUtils::CreateSample(key);
+    } catch (std::exception const &e) {
+      NUIS_ERR(FTL, "Failed to construct sample " << key.GetS("name") << ": "
+                                                  << e.what());
+      std::lock_guard<std::mutex> lock(loaderrorlock);
+      if (!loaderror)
+        loaderror = std::current_exception();
+    } catch (...) {
+      NUIS_ERR(FTL, "Failed to construct sample " << key.GetS("name"));
+      std::lock_guard<std::mutex> lock(loaderrorlock);
+      if (!loaderror)
+        loaderror = std::current_exception();
+    }
+
+    loadtime[i] = FCNStageTimer::Since(start);
+  }
+
+  double walltime = FCNStageTimer::Since(loadstart);
+  if (nthreads > 1) {
+    TH1::AddDirectory(adddirectory);
+    Config::Get().SetThreadSafe(false);
     fOutputDir->cd();
-    MeasurementBase *NewLoadedSample = SampleUtils::CreateSample(key);
+  }
 
-    if (!NewLoadedSample) {
-      NUIS_ERR(FTL, "Could not load sample provided: " << samplename);
+  if (loaderror)
+    std::rethrow_exception(loaderror);
+
+  // Keep the card order whatever order they finished in
+  double summedtime = 0.0;
+  for (int i = 0; i < nsamples; i++) {
+    if (!loaded[i]) {
+      NUIS_ERR(FTL, "Could not load sample provided: "
+                        << samplekeys[i].GetS("name"));
       NUIS_ERR(FTL, "Check spelling with that in src/FCN/SampleList.cxx");
       throw;
-    } else {
-      fSamples.push_back(NewLoadedSample);
     }
+    fSamples.push_back(loaded[i]);
+    summedtime += loadtime[i];
   }
+
+  // Startup report
+  if (nsamples) {
+    NUIS_LOG(FIT, "Sample construction times:");
+    for (int i = 0; i < nsamples; i++) {
+      NUIS_LOG(FIT, "|-> " << std::left << std::setw(49)
+                           << loaded[i]->GetName() << " : " << std::fixed
+                           << std::setprecision(2) << loadtime[i] << "s");
+    }
+    NUIS_LOG(FIT, "Constructed " << nsamples << " samples in " << std::fixed
+                                 << std::setprecision(2) << walltime
+                                 << "s on " << nthreads << " threads ("
+                                 << summedtime << "s summed)");
+  }
+
+  std::vector<std::string> names;
+  for (MeasListConstIter iter = fSamples.begin(); iter != fSamples.end();
+       iter++) {
+    names.push_back((*iter)->GetName());
+  }
+  fTimer.Setup(names);
 }
 
 //***************************************************
@@ -418,31 +1067,55 @@ void JointFCN::ReconfigureSamples(bool fullconfig) {
   int starttime = time(NULL);
   NUIS_LOG(REC, "------------");
   NUIS_LOG(REC, "Starting Reconfigure iter. " << this->fCurIter);
-  // std::cout << fUsingEventManager << " " << fullconfig << " " << fMCFilled
-  // << std::endl; Event Manager Reconf
-  if (fUsingEventManager) {
+  // If only normalisation dials have moved since the last evaluation the
+  // filled histograms just need rescaling, skip the event loop.
+  bool eventrw =
+      fullconfig || !fMCFilled || FitBase::GetRW()->NeedsEventReWeight();
+
+  // Samples that cannot rescale what they hold would run their own event
+  // loop inside Renormalise, so they go through the usual reconfigure.
+  for (MeasListConstIter iter = fSamples.begin();
+       !eventrw && !IsDistributed() && iter != fSamples.end(); iter++) {
+    eventrw = !(*iter)->CanRenormalise();
+  }
+
+  if (IsDistributed()) {
+    // Workers track their own dial changes
+    ReconfigureDistributed(fullconfig || !fMCFilled);
+
+  } else if (!eventrw) {
+    NUIS_LOG(REC, "Only normalisation dials changed, renormalising samples.");
+    int isample = 0;
+    for (MeasListConstIter iter = fSamples.begin(); iter != fSamples.end();
+         iter++, isample++) {
+      FCNStageTimer::clock::time_point start = FCNStageTimer::Now();
+      (*iter)->Renormalise();
+      fTimer.Add(FCNStageTimer::kConvert, FCNStageTimer::Since(start),
+                 isample);
+    }
+
+  } else if (fUsingEventManager) {
     if (!fullconfig && fMCFilled)
       ReconfigureFastUsingManager();
     else
       ReconfigureUsingManager();
 
   } else {
-    // Loop over all Measurement Classes
+    // Loop over all Measurement Classes. Each sample runs its own event
+    // loop, so all of it is counted as that sample's fill.
+    int isample = 0;
     for (MeasListConstIter iter = fSamples.begin(); iter != fSamples.end();
-         iter++) {
+         iter++, isample++) {
       MeasurementBase *exp = *iter;
+      FCNStageTimer::clock::time_point start = FCNStageTimer::Now();
 
-      // If RW Either do signal or full reconfigure.
-      if (fDialChanged or !fMCFilled or fullconfig) {
-        if (!fullconfig and fMCFilled)
-          exp->ReconfigureFast();
-        else
-          exp->Reconfigure();
+      // Either do signal or full reconfigure.
+      if (!fullconfig and fMCFilled)
+        exp->ReconfigureFast();
+      else
+        exp->Reconfigure();
 
-        // If RW Not needed just do normalisation
-      } else {
-        exp->Renormalise();
-      }
+      fTimer.Add(FCNStageTimer::kFill, FCNStageTimer::Since(start), isample);
     }
   }
 
@@ -453,6 +1126,7 @@ void JointFCN::ReconfigureSamples(bool fullconfig) {
   }
 
   fMCFilled = true;
+  FitBase::GetRW()->SetDialsEvaluated();
   NUIS_LOG(MIN, "Finished Reconfigure iter. " << fCurIter << " in "
                                               << time(NULL) - starttime << "s");
 
@@ -523,9 +1197,11 @@ void JointFCN::ReconfigureUsingManager() {
 
   // Reset all samples
   MeasListConstIter iterSam = fSamples.begin();
-  for (; iterSam != fSamples.end(); iterSam++) {
+  for (int isample = 0; iterSam != fSamples.end(); iterSam++, isample++) {
     MeasurementBase *exp = (*iterSam);
+    FCNStageTimer::clock::time_point start = FCNStageTimer::Now();
     exp->ResetAll();
+    fTimer.Add(FCNStageTimer::kFill, FCNStageTimer::Since(start), isample);
   }
 
   // If we are saving signal, reset all containers.
@@ -533,234 +1209,440 @@ void JointFCN::ReconfigureUsingManager() {
 
   if (savesignal) {
     // Reset all of our event signal vectors
-    fSignalEventBoxes.clear();
+    // Custom box clones are not deleted here as a sample may still be
+    // pointing at the last one it was filled from.
+    fSignalCache.clear();
+    fSignalWeightCache.Clear();
+    fNSignalEvents = 0;
     fSignalEventFlags.clear();
-    fSampleSignalFlags.clear();
     fSignalEventSplines.clear();
+    ClearSignalSplineStores();
+    fSignalEventInputs.clear();
+    fSignalEventEntries.clear();
   }
 
   // Make sure we have a list of inputs
   if (fInputList.empty()) {
     fInputList = GetInputList();
     fSubSampleList = GetSubSampleList();
-  }
 
-  // If all inputs are splines make sure the readers are told
-  // they need to be reconfigured.
-  std::vector<InputHandlerBase *>::iterator inp_iter = fInputList.begin();
-
-  if (fIsAllSplines) {
-    for (; inp_iter != fInputList.end(); inp_iter++) {
-      InputHandlerBase *curinput = (*inp_iter);
-
-      // Tell reader in each BaseEvent it needs a Reconfigure next weight
-      // calc.
-      BaseFitEvt *curevent = curinput->FirstBaseEvent();
-      if (curevent->fSplineRead) {
-        curevent->fSplineRead->SetNeedsReconfigure(true);
-      }
+    fSubSampleOwner.clear();
+    int isample = 0;
+    for (MeasListConstIter iter = fSamples.begin(); iter != fSamples.end();
+         iter++, isample++) {
+      fSubSampleOwner.insert(fSubSampleOwner.end(),
+                             (*iter)->GetSubSamples().size(), isample);
     }
   }
 
-  // MAIN INPUT LOOP ====================
+  if (savesignal) {
+    fSignalCache.resize(fSubSampleList.size());
+  }
 
-  int fillcount = 0;
-  int inputcount = 0;
-  inp_iter = fInputList.begin();
-
-  // Loop over each input in manager
-  for (; inp_iter != fInputList.end(); inp_iter++) {
-    InputHandlerBase *curinput = (*inp_iter);
-
-    // Get event information
-    FitEvent *curevent = curinput->FirstNuisanceEvent();
-    curinput->CreateCache();
-
-    int i = 0;
-    int nevents = curinput->GetNEvents();
-    int countwidth = nevents / 10;
-    uint textwidth = strlen(Form("%i", nevents));
-
-    // Start event loop iterating until we get a NULL pointer.
-    while (curevent) {
-      // Get Event Weight
-      // The reweighting weight
-      curevent->RWWeight = FitBase::GetRW()->CalcWeight(curevent);
-      // The Custom weight and reweight
-      curevent->Weight =
-          curevent->RWWeight * curevent->InputWeight * curevent->CustomWeight;
+  // Each input is cut into contiguous entry ranges, roughly in proportion to
+  // its share of the events, so that one large input does not leave the
+  // other threads idle. Every range of an input reads through its own clone
+  // of it, inputs that cannot be cloned are kept whole.
+  int ninputs = fInputList.size();
+  int nthreads = std::max(1, fNThreads);
+  double totalevents = 0.0;
+  for (int iinput = 0; iinput < ninputs; iinput++) {
+    totalevents += fInputList[iinput]->GetNEvents();
+  }
+
+  std::vector<int> rangeinput;
+  std::vector<InputHandlerBase *> rangereader;
+  std::vector<int> rangefirst;
+  std::vector<int> rangelast;
+  for (int iinput = 0; iinput < ninputs; iinput++) {
+    int nevents = fInputList[iinput]->GetNEvents();
+    int nranges = 1;
+    if (nthreads > 1 && totalevents > 0.0) {
+      nranges = int(std::ceil(nthreads * nevents / totalevents));
+      nranges = std::max(1, std::min(std::min(nthreads, nevents), nranges));
+    }
 
-      if (LOGGING(REC)) {
-        if (countwidth && (i % countwidth == 0)) {
-          NUIS_LOG(REC, std::left << std::setw(52) << curinput->GetName()
-		   << ": Processed " << std::right << std::setw(textwidth) << i
-		   << " events. [M, W] = [" << std::setw(3)
-		   << curevent->Mode << ", " << std::setw(5)
-		   << Form("%.3lf", curevent->Weight) << "]");
+    std::vector<InputHandlerBase *> const &readers =
+        GetInputReaders(iinput, nranges);
+    nranges = std::min(nranges, int(readers.size()));
+    for (int r = 0; r < nranges; r++) {
+      rangeinput.push_back(iinput);
+      rangereader.push_back(readers[r]);
+      rangefirst.push_back(int((long long)(nevents) * r / nranges));
+      rangelast.push_back(int((long long)(nevents) * (r + 1) / nranges));
+
+      // If all inputs are splines make sure the readers are told
+      // they need to be reconfigured.
+      if (fIsAllSplines) {
+        BaseFitEvt *curevent = readers[r]->FirstBaseEvent();
+        if (curevent->fSplineRead) {
+          curevent->fSplineRead->SetNeedsReconfigure(true);
         }
       }
+    }
+  }
 
-      // Setup flag for if signal found in at least one sample
-      bool foundsignal = false;
+  // MAIN INPUT LOOP ====================
 
-      // Create a new signal bitset for this event
-      std::vector<bool> signalbitset(fSubSampleList.size());
+  FCNStageTimer::clock::time_point loopstart = FCNStageTimer::Now();
+  int fillcount = 0;
+  int nranges = rangeinput.size();
+  nthreads = std::min(nthreads, nranges);
+
+  // Signal containers are filled per range and joined afterwards in entry
+  // order, so the fast reconfigure sees the same layout as a serial loop.
+  std::vector<std::vector<bool> > rangeflags(nranges);
+  std::vector<std::vector<SampleSignalCache> > rangecache(
+      nranges, std::vector<SampleSignalCache>(fSubSampleList.size()));
+  std::vector<int> rangensignal(nranges, 0);
+  std::vector<std::vector<std::vector<float> > > rangesplines(nranges);
+
+  // Ranges of one input share its samples, which are only touched under
+  // that input's lock.
+  std::vector<std::mutex> samplelocks(ninputs);
+
+  if (nthreads > 1) {
+    NUIS_LOG(REC, "Event Manager Reconfigure using "
+                      << nthreads << " threads over " << nranges
+                      << " event ranges.");
+    ROOT::EnableThreadSafety();
+  }
 
-      // Create a new signal box vector for this event
-      std::vector<MeasurementVariableBox *> signalboxes;
+#ifdef __USE_OPENMP__
+#pragma omp parallel for schedule(dynamic, 1) num_threads(nthreads) \
+    reduction(+ : fillcount)
+#endif
+  for (int irange = 0; irange < nranges; irange++) {
+    fillcount += ReconfigureInputUsingManager(
+        fInputList[rangeinput[irange]], rangereader[irange],
+        rangefirst[irange], rangelast[irange], savesignal, rangeflags[irange],
+        rangecache[irange], rangensignal[irange], rangesplines[irange],
+        (nthreads > 1) ? &samplelocks[rangeinput[irange]] : NULL);
+  }
 
-      // Start measurement iterator
-      size_t measitercount = 0;
-      std::vector<MeasurementBase *>::iterator meas_iter =
-          fSubSampleList.begin();
+  if (savesignal) {
+    for (int irange = 0; irange < nranges; irange++) {
+      fSignalEventFlags.insert(fSignalEventFlags.end(),
+                               rangeflags[irange].begin(),
+                               rangeflags[irange].end());
+      for (size_t isample = 0; isample < fSignalCache.size(); isample++) {
+        fSignalCache[isample].Append(rangecache[irange][isample],
+                                     fNSignalEvents);
+      }
+      fNSignalEvents += rangensignal[irange];
+      fSignalEventSplines.insert(fSignalEventSplines.end(),
+                                 rangesplines[irange].begin(),
+                                 rangesplines[irange].end());
+    }
+  }
 
-      // Loop over all subsamples (sub in JointMeas)
-      for (; meas_iter != fSubSampleList.end(); meas_iter++) {
-        MeasurementBase *curmeas = (*meas_iter);
+  // End of Event Loop ===============================
 
-        // Compare input pointers, to current input, skip if not.
-        // Pointer tells us if it matches without doing ID checks.
-        if (curinput != curmeas->GetInput()) {
-          if (savesignal) {
-            // Set bit to 0 as definitely not signal
-            signalbitset[measitercount] = 0;
-          }
+  if (savesignal) {
+    for (size_t isample = 0; isample < fSignalCache.size(); isample++) {
+      fSignalCache[isample].Compact();
+    }
+    BuildSignalEventIndex();
+    if (fIsAllSplines) {
+      BuildSignalSplineStores();
+    } else {
+      fSignalWeightCache.Setup(fNSignalEvents, FitBase::GetRW()->GetNEngines(),
+                               FitPar::Config().GetParD("EventWeightCacheMB"));
+    }
+  }
+  fTimer.Add(FCNStageTimer::kEventLoop, FCNStageTimer::Since(loopstart));
 
-          // Count up what measurement we are on.
-          measitercount++;
+  // Now event loop is finished loop over all Measurements
+  // Converting Binned events to XSec Distributions
+  iterSam = fSamples.begin();
+  for (int isample = 0; iterSam != fSamples.end(); iterSam++, isample++) {
+    MeasurementBase *exp = (*iterSam);
+    FCNStageTimer::clock::time_point start = FCNStageTimer::Now();
+    exp->ConvertEventRates();
+    exp->SetMCFilled();
+    fTimer.Add(FCNStageTimer::kConvert, FCNStageTimer::Since(start), isample);
+  }
 
-          // Skip sample as input not signal.
+  // Print out statements on approximate memory usage for profiling.
+  NUIS_LOG(REC, "Filled " << fillcount << " signal events.");
+  if (savesignal) {
+    size_t cachemem = fSignalEventFlags.capacity() / 8 +
+                      (fSignalEventInputs.capacity() +
+                       fSignalEventEntries.capacity()) * sizeof(int);
+    size_t ncustom = 0;
+    for (size_t isample = 0; isample < fSignalCache.size(); isample++) {
+      cachemem += fSignalCache[isample].GetMemoryUsage();
+      ncustom += fSignalCache[isample].fBoxes.size();
+    }
+    NUIS_LOG(REC, " -> Saved " << fillcount
+                               << " signal events for faster access. ("
+                               << cachemem * 1E-6 << " MB)");
+    if (ncustom) {
+      NUIS_LOG(REC, " -> " << ncustom
+                           << " of these keep a custom variable box clone.");
+    }
+    if (fSignalWeightCache.GetNSlots()) {
+      NUIS_LOG(REC, " -> Caching engine weights for "
+                        << fSignalWeightCache.GetNSlots() << " signal events. ("
+                        << fSignalWeightCache.GetMemoryUsage() * 1E-6
+                        << " MB)");
+    }
+    if (fIsAllSplines and !fSignalSplineStores.empty()) {
+      size_t nsplines = 0;
+      double splmem = 0.0;
+      for (size_t i = 0; i < fSignalSplineStores.size(); i++) {
+        if (!fSignalSplineStores[i])
           continue;
-        }
-
-        // Fill events for matching inputs.
-        MeasurementVariableBox *box = curmeas->FillVariableBox(curevent);
+        nsplines += fSignalSplineStores[i]->GetNEvents();
+        splmem += fSignalSplineStores[i]->GetMemoryUsage() * 1E-6;
+      }
+      NUIS_LOG(REC, " -> Saved " << fillcount << " " << nsplines
+                                 << " spline sets into memory. (" << splmem
+                                 << " MB)");
+    }
+  }
 
-        bool signal = curmeas->isSignal(curevent);
-        curmeas->SetSignal(signal);
-        curmeas->FillHistograms(curevent->Weight);
+  // Check SignalReconfigures works for all samples
+  if (savesignal) {
+    double likefull = GetLikelihood();
+    ReconfigureFastUsingManager();
+    double likefast = GetLikelihood();
 
-        // If its Signal tally up fills
-        if (signal) {
-          fillcount++;
-        }
+    if (fabs(likefull - likefast) > 0.0001) {
+      NUIS_ERR(FTL, "Fast and Full Likelihoods DIFFER! : " << likefull << " : "
+                                                           << likefast);
+      NUIS_ERR(FTL,
+               "This means some samples you are using are not setup to use "
+               "SignalReconfigures=1");
+      NUIS_ERR(FTL, "Please turn OFF signal reconfigures.");
+      throw;
+    } else {
+      NUIS_LOG(FIT,
+               "Likelihoods for FULL and FAST match. Will use FAST next time.");
+    }
+  }
+};
 
-        // If we are saving signal/splines fill the bitset
-        if (savesignal) {
-          signalbitset[measitercount] = signal;
-        }
+//***************************************************
+int JointFCN::ReconfigureInputUsingManager(
+    InputHandlerBase *curinput, InputHandlerBase *reader, int first,
+    int last, bool savesignal, std::vector<bool> &eventflags,
+    std::vector<SampleSignalCache> &samplecache, int &nsignal,
+    std::vector<std::vector<float> > &eventsplines, std::mutex *samplelock) {
+  //***************************************************
 
-        // If signal save a clone of the event box for use later.
-        if (savesignal and signal) {
-          foundsignal = true;
-          signalboxes.push_back(box->CloneSignalBox());
-        }
+  // Engines wrapping generator libraries cannot be called concurrently.
+  bool rwthreadsafe = FitBase::GetRW()->IsThreadSafe();
+  int fillcount = 0;
 
-        // Keep track of Measurement we are on.
-        measitercount++;
+  // Get event information
+  reader->CreateCache();
+
+  int nevents = curinput->GetNEvents();
+  int countwidth = nevents / 10;
+  uint textwidth = strlen(Form("%i", nevents));
+
+  // Event loop over this range, stopping early if the reader runs out.
+  for (int i = first; i < last; i++) {
+    FitEvent *curevent = reader->ReadNuisanceEvent(i);
+    if (!curevent)
+      break;
+
+    // Get Event Weight
+    // The reweighting weight
+    if (rwthreadsafe) {
+      curevent->RWWeight = FitBase::GetRW()->CalcWeight(curevent);
+    } else {
+#ifdef __USE_OPENMP__
+#pragma omp critical(JointFCN_CalcWeight)
+#endif
+      curevent->RWWeight = FitBase::GetRW()->CalcWeight(curevent);
+    }
+    // The Custom weight and reweight
+    curevent->Weight =
+        curevent->RWWeight * curevent->InputWeight * curevent->CustomWeight;
+
+    if (LOGGING(REC)) {
+      if (countwidth && (i % countwidth == 0)) {
+        NUIS_LOG(REC, std::left << std::setw(52) << curinput->GetName()
+                 << ": Processed " << std::right << std::setw(textwidth) << i
+                 << " events. [M, W] = [" << std::setw(3)
+                 << curevent->Mode << ", " << std::setw(5)
+                 << Form("%.3lf", curevent->Weight) << "]");
       }
+    }
+
+    // Setup flag for if signal found in at least one sample
+    bool foundsignal = false;
+
+    std::unique_lock<std::mutex> lock;
+    if (samplelock) {
+      lock = std::unique_lock<std::mutex>(*samplelock);
+    }
+
+    // Loop over all subsamples (sub in JointMeas)
+    for (size_t isample = 0; isample < fSubSampleList.size(); isample++) {
+      MeasurementBase *curmeas = fSubSampleList[isample];
+
+      // Compare input pointers, to current input, skip if not.
+      // Pointer tells us if it matches without doing ID checks.
+      if (curinput != curmeas->GetInput())
+        continue;
 
-      // Once we've filled the measurements, if saving signal
-      // push back if any sample flagged this event as signal
-      if (savesignal) {
-        fSignalEventFlags.push_back(foundsignal);
+      // Fill events for matching inputs.
+      MeasurementVariableBox *box = curmeas->FillVariableBox(curevent);
+
+      bool signal = curmeas->isSignal(curevent);
+      curmeas->SetSignal(signal);
+
+      // Every event is filled here, through the sample's own
+      // FillHistograms, so the full reconfigure stays an independent
+      // reference for the saved signal fills of the fast one.
+      curmeas->FillHistograms(curevent->Weight);
+
+      // If its Signal tally up fills
+      if (signal) {
+        fillcount++;
       }
 
-      // Save the vector of signal boxes for this event
-      if (savesignal && foundsignal) {
-        fSignalEventBoxes.push_back(signalboxes);
-        fSampleSignalFlags.push_back(signalbitset);
+      // If signal save the event variables for use later.
+      if (savesignal and signal) {
+        foundsignal = true;
+        int mcbin, finebin;
+        curmeas->FindFillBins(mcbin, finebin);
+        samplecache[isample].Add(nsignal, box, mcbin, finebin);
       }
+    }
 
-      // If all inputs are splines we can save the spline coefficients
-      // for fast in memory reconfigures later.
-      if (fIsAllSplines && savesignal && foundsignal) {
-        // Make temp vector to push back with
-        std::vector<float> coeff;
-        for (size_t l = 0; l < (UInt_t)curevent->fSplineRead->GetNPar(); l++) {
-          coeff.push_back(curevent->fSplineCoeff[l]);
-        }
+    if (lock.owns_lock()) {
+      lock.unlock();
+    }
 
-        // Push back to signal event splines. Kept in sync with
-        // fSignalEventBoxes size.
-        // int splinecount = fSignalEventSplines.size();
-        fSignalEventSplines.push_back(coeff);
-
-        // if (splinecount % 1000 == 0) {
-        // std::cout << "Pushed Back Coeff " << splinecount << " : ";
-        // for (size_t l = 0; l < fSignalEventSplines[splinecount].size();
-        // l++)
-        // {
-        // std::cout << " " << fSignalEventSplines[splinecount][l];
-        // }
-        // std::cout << std::endl;
-        // }
-      }
+    // Once we've filled the measurements, if saving signal
+    // push back if any sample flagged this event as signal
+    if (savesignal) {
+      eventflags.push_back(foundsignal);
+    }
+
+    // Sample caches refer to this event by its signal index
+    if (foundsignal) {
+      nsignal++;
+    }
 
-      // Clean up vectors once done with this event
-      signalboxes.clear();
-      signalbitset.clear();
+    // If all inputs are splines we can save the spline coefficients
+    // for fast in memory reconfigures later.
+    if (fIsAllSplines && foundsignal) {
+      // Make temp vector to push back with
+      std::vector<float> coeff;
+      for (size_t l = 0; l < (UInt_t)curevent->fSplineRead->GetNPar(); l++) {
+        coeff.push_back(curevent->fSplineCoeff[l]);
+      }
 
-      // Iterate to the next event.
-      curevent = curinput->NextNuisanceEvent();
-      i++;
+      // Push back to signal event splines. Kept in sync with
+      // the signal event count.
+      eventsplines.push_back(coeff);
     }
+  }
 
-    //    curinput->RemoveCache();
+  //    reader->RemoveCache();
 
-    // Keep track of what input we are on.
-    inputcount++;
+  return fillcount;
+}
+
+//***************************************************
+std::vector<InputHandlerBase *> const &
+JointFCN::GetInputReaders(int iinput, int nreaders) {
+  //***************************************************
+
+  if (fInputReaders.size() < fInputList.size()) {
+    fInputReaders.resize(fInputList.size());
   }
 
-  // End of Event Loop ===============================
+  std::vector<InputHandlerBase *> &readers = fInputReaders[iinput];
+  if (readers.empty()) {
+    readers.push_back(fInputList[iinput]);
+  }
 
-  // Now event loop is finished loop over all Measurements
-  // Converting Binned events to XSec Distributions
-  iterSam = fSamples.begin();
-  for (; iterSam != fSamples.end(); iterSam++) {
-    MeasurementBase *exp = (*iterSam);
-    exp->ConvertEventRates();
+  int nopened = 0;
+  while ((int)readers.size() < nreaders) {
+    InputHandlerBase *clone = InputUtils::CloneInputHandler(readers[0]);
+    if (!clone)
+      break;
+    readers.push_back(clone);
+    nopened++;
   }
 
-  // Print out statements on approximate memory usage for profiling.
-  NUIS_LOG(REC, "Filled " << fillcount << " signal events.");
-  if (savesignal) {
-    int mem = ( // sizeof(fSignalEventBoxes) +
-                // fSignalEventBoxes.size() * sizeof(fSignalEventBoxes.at(0)) +
-                  sizeof(MeasurementVariableBox1D) * fillcount) *
-              1E-6;
-    NUIS_LOG(REC, " -> Saved " << fillcount
-                               << " signal boxes for faster access. (~" << mem
-                               << " MB)");
-    if (fIsAllSplines and !fSignalEventSplines.empty()) {
-      int splmem = sizeof(float) * fSignalEventSplines.size() *
-                   fSignalEventSplines[0].size() * 1E-6;
-      NUIS_LOG(REC, " -> Saved "
-                        << fillcount << " " << fSignalEventSplines.size()
-                        << " spline sets into memory. (~" << splmem << " MB)");
-    }
+  if (nopened) {
+    NUIS_LOG(REC, "Opened " << nopened << " extra readers for input "
+                            << readers[0]->GetName());
   }
 
-  // Check SignalReconfigures works for all samples
-  if (savesignal) {
-    double likefull = GetLikelihood();
-    ReconfigureFastUsingManager();
-    double likefast = GetLikelihood();
+  return readers;
+}
 
-    if (fabs(likefull - likefast) > 0.0001) {
-      NUIS_ERR(FTL, "Fast and Full Likelihoods DIFFER! : " << likefull << " : "
-                                                           << likefast);
-      NUIS_ERR(FTL,
-               "This means some samples you are using are not setup to use "
-               "SignalReconfigures=1");
-      NUIS_ERR(FTL, "Please turn OFF signal reconfigures.");
-      throw;
-    } else {
-      NUIS_LOG(FIT,
-               "Likelihoods for FULL and FAST match. Will use FAST next time.");
+//***************************************************
+void JointFCN::BuildSignalEventIndex() {
+  //***************************************************
+
+  fSignalEventInputs.clear();
+  fSignalEventEntries.clear();
+  fInputSignalStart.clear();
+  fSignalEventInputs.reserve(fNSignalEvents);
+  fSignalEventEntries.reserve(fNSignalEvents);
+
+  size_t sigcount = 0;
+  for (size_t iinput = 0; iinput < fInputList.size(); iinput++) {
+    fInputSignalStart.push_back(fSignalEventInputs.size());
+    int nevents = fInputList[iinput]->GetNEvents();
+    for (int i = 0; i < nevents && sigcount < fSignalEventFlags.size(); i++) {
+      if (fSignalEventFlags[sigcount]) {
+        fSignalEventInputs.push_back(iinput);
+        fSignalEventEntries.push_back(i);
+      }
+      sigcount++;
     }
   }
-};
+  fInputSignalStart.push_back(fSignalEventInputs.size());
+
+  if ((int)fSignalEventInputs.size() != fNSignalEvents) {
+    NUIS_ABORT("Signal event index out of sync with saved signal events! ("
+               << fSignalEventInputs.size() << " != " << fNSignalEvents
+               << ")");
+  }
+}
+
+//***************************************************
+void JointFCN::BuildSignalSplineStores() {
+  //***************************************************
+
+  ClearSignalSplineStores();
+  fSignalSplineStores.resize(fInputList.size(), NULL);
+
+  for (size_t iinput = 0; iinput < fInputList.size(); iinput++) {
+    int first = fInputSignalStart[iinput];
+    int last = fInputSignalStart[iinput + 1];
+    SplineReader *reader = fInputList[iinput]->FirstBaseEvent()->fSplineRead;
+    if (!reader || first == last)
+      continue;
+
+    fSignalSplineStores[iinput] = new SplineCoeffStore(reader);
+    fSignalSplineStores[iinput]->Fill(fSignalEventSplines.begin() + first,
+                                      fSignalEventSplines.begin() + last);
+  }
+
+  // The row copies are no longer needed once the columns are filled.
+  std::vector<std::vector<float> >().swap(fSignalEventSplines);
+}
+
+//***************************************************
+void JointFCN::ClearSignalSplineStores() {
+  //***************************************************
+
+  for (size_t i = 0; i < fSignalSplineStores.size(); i++) {
+    delete fSignalSplineStores[i];
+  }
+  fSignalSplineStores.clear();
+}
 
 //***************************************************
 void JointFCN::ReconfigureFastUsingManager() {
@@ -770,13 +1652,6 @@ void JointFCN::ReconfigureFastUsingManager() {
   // Get Start time for profilling
   // int timestart = time(NULL);
 
-  // Reset all samples
-  MeasListConstIter iterSam = fSamples.begin();
-  for (; iterSam != fSamples.end(); iterSam++) {
-    MeasurementBase *exp = (*iterSam);
-    exp->ResetAll();
-  }
-
   // Check for saved variables if not do a full reconfigure.
   if (fSignalEventFlags.empty()) {
     NUIS_LOG(REC, "Signal Flags Empty! Using normal manager.");
@@ -787,162 +1662,271 @@ void JointFCN::ReconfigureFastUsingManager() {
   bool fFillNuisanceEvent =
       FitPar::Config().GetParB("FullEventOnSignalReconfigure");
 
-  // Setup fast vector iterators.
-  std::vector<bool>::iterator inpsig_iter = fSignalEventFlags.begin();
-  std::vector<std::vector<MeasurementVariableBox *> >::iterator box_iter =
-      fSignalEventBoxes.begin();
-  std::vector<std::vector<float> >::iterator spline_iter =
-      fSignalEventSplines.begin();
-  std::vector<std::vector<bool> >::iterator samsig_iter =
-      fSampleSignalFlags.begin();
-  int splinecount = 0;
-
-  // Setup stuff for logging
-  int fillcount = 0;
-  // This is just the total number of events
-  // int nevents = fSignalEventFlags.size();
   // This is the number of events that are signal
-  int nevents = fSignalEventBoxes.size();
+  int nevents = fNSignalEvents;
   int countwidth = nevents / 10;
 
-  // If All Splines tell splines they need a reconfigure.
-  std::vector<InputHandlerBase *>::iterator inp_iter = fInputList.begin();
+  // Signal events are addressed through the precomputed input/entry index
+  // so the weight stage has no shared counters.
+  if ((int)fSignalEventInputs.size() != fNSignalEvents) {
+    BuildSignalEventIndex();
+  }
+
+  int nsignal = fNSignalEvents;
+  double *coreeventweights = new double[nsignal];
+
   if (fIsAllSplines) {
     NUIS_LOG(REC, "All Spline Inputs so using fast spline loop.");
-    for (; inp_iter != fInputList.end(); inp_iter++) {
-      InputHandlerBase *curinput = (*inp_iter);
+    CalcSignalSplineWeights(coreeventweights);
+
+  } else {
+    FCNStageTimer::clock::time_point rwstart = FCNStageTimer::Now();
+    for (int isig = 0; isig < nsignal; isig++) {
+      InputHandlerBase *curinput = fInputList[fSignalEventInputs[isig]];
+      int i = fSignalEventEntries[isig];
+
+      // Get Event Info
+      BaseFitEvt *curevent = NULL;
+      if (fFillNuisanceEvent) {
+        curevent = curinput->ReadNuisanceEvent(i);
+      } else {
+        curevent = curinput->GetBaseEvent(i);
+      }
+
+      curevent->RWWeight =
+          FitBase::GetRW()->CalcWeight(curevent, &fSignalWeightCache, isig);
+      curevent->Weight =
+          curevent->RWWeight * curevent->InputWeight * curevent->CustomWeight;
+      coreeventweights[isig] = curevent->Weight;
 
-      // Tell each fSplineRead in BaseFitEvent to reconf next weight calc
-      BaseFitEvt *curevent = curinput->FirstBaseEvent();
-      if (curevent->fSplineRead)
-        curevent->fSplineRead->SetNeedsReconfigure(true);
+      if (countwidth && ((isig % countwidth) == 0)) {
+        NUIS_LOG(REC, curinput->GetName()
+                          << " : Processed " << i << " events. W = "
+                          << curevent->Weight << std::endl);
+      }
     }
+    fTimer.Add(FCNStageTimer::kEventReweight, FCNStageTimer::Since(rwstart));
   }
 
-  // Loop over all possible spline inputs
-  double *coreeventweights = new double[fSignalEventBoxes.size()];
-  splinecount = 0;
+  NUIS_LOG(SAM, "Processed event weights.");
 
-  inp_iter = fInputList.begin();
-  inpsig_iter = fSignalEventFlags.begin();
-  spline_iter = fSignalEventSplines.begin();
+  int fillcount = FillSignalEvents(coreeventweights);
 
-  // Loop over all signal flags
-  // For each valid signal flag add one to splinecount
-  // Get Splines from that count and add to weight
-  // Add splinecount
-  int sigcount = 0;
+  // Cleanup coreeventweights
+  delete[] coreeventweights;
 
-  // #pragma omp parallel for shared(splinecount,sigcount)
-  for (uint iinput = 0; iinput < fInputList.size(); iinput++) {
-    InputHandlerBase *curinput = fInputList[iinput];
-    BaseFitEvt *curevent = curinput->FirstBaseEvent();
+  // Print some reconfigure profiling.
+  NUIS_LOG(REC, "Filled " << fillcount << " signal events.");
+}
 
-    // Loop over the events in each input
-    for (int i = 0; i < curinput->GetNEvents(); i++) {
-      double rwweight = 0.0;
+//***************************************************
+void JointFCN::CalcSignalSplineWeights(
+    double *weights,
+    std::vector<std::vector<std::vector<int> > > const *dialsplines,
+    SignalDerivativeSink const *sink) {
+  //***************************************************
 
-      // If the event is a signal event
-      if (fSignalEventFlags[sigcount]) {
-        // Get Event Info
-        if (!fIsAllSplines) {
-          if (fFillNuisanceEvent) {
-            curevent = curinput->GetNuisanceEvent(i);
-          } else {
-            curevent = curinput->GetBaseEvent(i);
-          }
-        } else {
-          curevent->fSplineCoeff = &fSignalEventSplines[splinecount][0];
-        }
+  // Bring every reader up to date before the weight loop so that readers
+  // are only ever read from inside it.
+  std::vector<BaseFitEvt *> inputevents(fInputList.size(), NULL);
+  SplineWeightEngine *splinerw = NULL;
+  if (FitBase::GetRW()->HasRWEngine(kSPLINEPARAMETER)) {
+    splinerw = static_cast<SplineWeightEngine *>(
+        FitBase::GetRW()->GetRWEngine(kSPLINEPARAMETER));
+  }
 
-        curevent->RWWeight = FitBase::GetRW()->CalcWeight(curevent);
-        curevent->Weight =
-            curevent->RWWeight * curevent->InputWeight * curevent->CustomWeight;
-        rwweight = curevent->Weight;
+  FCNStageTimer::clock::time_point start = FCNStageTimer::Now();
+  for (size_t iinput = 0; iinput < fInputList.size(); iinput++) {
+    BaseFitEvt *curevent = fInputList[iinput]->FirstBaseEvent();
+    if (curevent->fSplineRead) {
+      curevent->fSplineRead->SetNeedsReconfigure(true);
+      if (splinerw) {
+        curevent->fSplineRead->Reconfigure(splinerw->fSplineValueMap);
+      }
+    }
+    inputevents[iinput] = curevent;
+  }
+  fTimer.Add(FCNStageTimer::kRWReconfigure, FCNStageTimer::Since(start));
+  start = FCNStageTimer::Now();
+
+  // Weight from every other engine, which only sees per-input state here.
+  // SplineWeightEngine returns 1.0 for an event without a reader, so the
+  // spline part is taken from the column stores below.
+  std::vector<double> inputweights(fInputList.size(), 1.0);
+  for (size_t iinput = 0; iinput < fInputList.size(); iinput++) {
+    BaseFitEvt otherevent;
+    otherevent.Mode = inputevents[iinput]->Mode;
+    otherevent.fType = inputevents[iinput]->fType;
+    inputweights[iinput] = FitBase::GetRW()->CalcWeight(&otherevent) *
+                           inputevents[iinput]->InputWeight *
+                           inputevents[iinput]->CustomWeight;
+  }
+
+  // Split each input's signal events into chunks shared across threads.
+  const int chunksize = 4096;
+  std::vector<int> chunkinput;
+  std::vector<int> chunkfirst;
+  for (size_t iinput = 0; iinput < fInputList.size(); iinput++) {
+    int nsig = fInputSignalStart[iinput + 1] - fInputSignalStart[iinput];
+    for (int first = 0; first < nsig; first += chunksize) {
+      chunkinput.push_back(iinput);
+      chunkfirst.push_back(first);
+    }
+  }
 
-        coreeventweights[splinecount] = rwweight;
-        if (countwidth && ((splinecount % countwidth) == 0)) {
-          NUIS_LOG(REC, curinput->GetName()
-                            << " : Processed " << i << " events. W = "
-                            << curevent->Weight << std::endl);
+  int nderivs = (sink && dialsplines && !dialsplines->empty())
+                    ? (*dialsplines)[0].size()
+                    : 0;
+
+  int nchunks = chunkinput.size();
+#ifdef __USE_OPENMP__
+#pragma omp parallel for schedule(dynamic) num_threads(fNThreads)
+#endif
+  for (int ichunk = 0; ichunk < nchunks; ichunk++) {
+    int iinput = chunkinput[ichunk];
+    int first = chunkfirst[ichunk];
+    int last = std::min(first + chunksize, fInputSignalStart[iinput + 1] -
+                                               fInputSignalStart[iinput]);
+    int offset = fInputSignalStart[iinput] + first;
+    double *chunkweights = weights + offset;
+
+    // Derivatives only live as long as their chunk
+    std::vector<double> derivbuffer(size_t(nderivs) * (last - first));
+    std::vector<double *> chunkderivs(nderivs, NULL);
+    for (int k = 0; k < nderivs; k++) {
+      chunkderivs[k] = &derivbuffer[size_t(k) * (last - first)];
+    }
+
+    SplineCoeffStore *store = NULL;
+    if (iinput < (int)fSignalSplineStores.size()) {
+      store = fSignalSplineStores[iinput];
+    }
+
+    if (store && nderivs) {
+      store->CalcWeightDerivatives(chunkweights, &chunkderivs[0],
+                                   (*dialsplines)[iinput], first, last);
+    } else if (store) {
+      store->CalcWeights(chunkweights, first, last);
+    } else {
+      for (int i = 0; i < last - first; i++) {
+        chunkweights[i] = 1.0;
+        for (int k = 0; k < nderivs; k++) {
+          chunkderivs[k][i] = 0.0;
         }
+      }
+    }
 
-        // #pragma omp atomic
-        splinecount++;
+    for (int i = 0; i < last - first; i++) {
+      chunkweights[i] *= inputweights[iinput];
+      for (int k = 0; k < nderivs; k++) {
+        chunkderivs[k][i] *= inputweights[iinput];
       }
+    }
 
-      // #pragma omp atomic
-      sigcount++;
+    if (nderivs) {
+      (*sink)(offset, last - first, &chunkderivs[0]);
     }
   }
 
-  NUIS_LOG(SAM, "Processed event weights.");
+  fTimer.Add(FCNStageTimer::kEventReweight, FCNStageTimer::Since(start));
+}
 
-  // #pragma omp barrier
+//***************************************************
+int JointFCN::FillSignalEvents(double const *weights, bool convert) {
+  //***************************************************
 
-  // Reset Iterators
-  inpsig_iter = fSignalEventFlags.begin();
-  spline_iter = fSignalEventSplines.begin();
-  box_iter = fSignalEventBoxes.begin();
-  samsig_iter = fSampleSignalFlags.begin();
-  int nsplineweights = splinecount;
-  splinecount = 0;
+  // Reset all samples
+  MeasListConstIter iterSam = fSamples.begin();
+  for (int isample = 0; iterSam != fSamples.end(); iterSam++, isample++) {
+    MeasurementBase *exp = (*iterSam);
+    FCNStageTimer::clock::time_point start = FCNStageTimer::Now();
+    exp->ResetAll();
+    fTimer.Add(FCNStageTimer::kFill, FCNStageTimer::Since(start), isample);
+  }
 
   // Start of Fast Event Loop ============================
 
-  // Start input iterators
-  // Loop over number of inputs
-  for (int ispline = 0; ispline < nsplineweights; ispline++) {
-    double rwweight = coreeventweights[ispline];
-
-    // Get iterators for this event
-    std::vector<bool>::iterator subsamsig_iter = (*samsig_iter).begin();
-    std::vector<MeasurementVariableBox *>::iterator subbox_iter =
-        (*box_iter).begin();
-
-    // Loop over all sub measurements.
-    std::vector<MeasurementBase *>::iterator meas_iter = fSubSampleList.begin();
-    for (; meas_iter != fSubSampleList.end(); meas_iter++, subsamsig_iter++) {
-      MeasurementBase *curmeas = (*meas_iter);
-
-      // If event flagged as signal for this sample fill from the box.
-      if (*subsamsig_iter) {
+  // Each sample streams through its own saved events in signal order, which
+  // is the order the event-major loop filled it in.
+  int fillcount = 0;
+  for (size_t isample = 0; isample < fSubSampleList.size(); isample++) {
+    MeasurementBase *curmeas = fSubSampleList[isample];
+    SampleSignalCache const &cache = fSignalCache[isample];
+    int nfill = cache.GetNEvents();
+    if (!nfill)
+      continue;
+
+    FCNStageTimer::clock::time_point start = FCNStageTimer::Now();
+
+    if (cache.fCustomBox) {
+      // Cloned boxes carry their own sample weight, applied as in the flat
+      // path and MeasurementBase::FillHistograms
+      for (int j = 0; j < nfill; j++) {
+        MeasurementVariableBox *box = cache.fBoxes[j];
         curmeas->SetSignal(true);
-        curmeas->FillHistogramsFromBox((*subbox_iter), rwweight);
-
-        // Move onto next box if there is one.
-        subbox_iter++;
-        fillcount++;
+        curmeas->FillHistogramsFromBox(box, weights[cache.fEvent[j]] *
+                                                box->GetSampleWeight());
       }
+    } else {
+      FillSavedBins(curmeas, cache, weights);
+      curmeas->FinaliseBinFills();
     }
+    fillcount += nfill;
 
-    if (ispline % countwidth == 0) {
-      NUIS_LOG(REC, "Filled " << ispline << " sample weights.");
-    }
+    int owner = (isample < fSubSampleOwner.size()) ? fSubSampleOwner[isample]
+                                                   : -1;
+    fTimer.Add(FCNStageTimer::kFill, FCNStageTimer::Since(start), owner);
 
-    // Iterate over the main signal event containers.
-    samsig_iter++;
-    box_iter++;
-    spline_iter++;
-    splinecount++;
+    NUIS_LOG(REC, "Filled " << nfill << " events for " << curmeas->GetName());
   }
   // End of Fast Event Loop ===================
 
   NUIS_LOG(SAM, "Filled sample distributions.");
 
+  if (convert)
+    ConvertSampleEventRates();
+
+  return fillcount;
+}
+
+//***************************************************
+void JointFCN::FillSavedBins(MeasurementBase *curmeas,
+                             SampleSignalCache const &cache,
+                             double const *weights) {
+  //***************************************************
+
+  // Saved bins let the standard histograms be filled without a search
+  MeasurementVariableBox *box = curmeas->GetBox();
+  int nfill = cache.GetNEvents();
+  int const *event = &cache.fEvent[0];
+  double const *vars = &cache.fVars[0];
+  double const *sampleweight = &cache.fSampleWeight[0];
+  int const *bins = &cache.fBins[0];
+  for (int j = 0; j < nfill; j++, vars += 3, bins += 2) {
+    box->SetX(vars[0]);
+    box->SetY(vars[1]);
+    box->SetZ(vars[2]);
+    box->SetFillBins(bins[0], bins[1]);
+    curmeas->SetSignal(true);
+    curmeas->FillHistogramsFromBox(box, weights[event[j]] * sampleweight[j]);
+  }
+  box->SetFillBins(-1, -1);
+}
+
+//***************************************************
+void JointFCN::ConvertSampleEventRates() {
+  //***************************************************
+
   // Now loop over all Measurements
   // Convert Binned events
-  iterSam = fSamples.begin();
-  for (; iterSam != fSamples.end(); iterSam++) {
+  MeasListConstIter iterSam = fSamples.begin();
+  for (int isample = 0; iterSam != fSamples.end(); iterSam++, isample++) {
     MeasurementBase *exp = (*iterSam);
+    FCNStageTimer::clock::time_point start = FCNStageTimer::Now();
     exp->ConvertEventRates();
+    exp->SetMCFilled();
+    fTimer.Add(FCNStageTimer::kConvert, FCNStageTimer::Since(start), isample);
   }
-
-  // Cleanup coreeventweights
-  delete coreeventweights;
-
-  // Print some reconfigure profiling.
-  NUIS_LOG(REC, "Filled " << fillcount << " signal events.");
 }
 
 //***************************************************
@@ -964,6 +1948,11 @@ void JointFCN::Write() {
     ndofs.push_back(ndof);
     names.push_back(name);
   }
+  for (size_t i = 0; i < fRemoteNames.size(); i++) {
+    likes.push_back(fRemoteLikes[i]);
+    ndofs.push_back(fRemoteNDOF[i]);
+    names.push_back(fRemoteNames[i]);
+  }
   if (likes.size()) {
     TH1D likehist = TH1D("likelihood_hist", "likelihood_hist;Sample;#chi^{2}",
                          likes.size(), 0.0, double(likes.size()));
@@ -995,6 +1984,14 @@ void JointFCN::Write() {
     exp->Write();
   }
 
+  // Workers write their samples to the same directory of their own file
+  if (IsDistributed()) {
+    std::string path = gDirectory->GetPath();
+    size_t root = path.find(":/");
+    path = (root == std::string::npos) ? "" : path.substr(root + 2);
+    RequestAllWorkers(FCNSocket::kWrite, std::vector<double>(), path);
+  }
+
   // Save Pull Terms
   for (PullListConstIter iter = fPulls.begin(); iter != fPulls.end(); iter++) {
     ParamPull *pull = *iter;
@@ -1028,6 +2025,14 @@ void JointFCN::SetFakeData(std::string fakeinput) {
     exp->SetFakeDataValues(fakeinput);
   }
 
+  // The workers reply with their likelihoods against the new data
+  if (IsDistributed()) {
+    std::vector<std::vector<double> > replies;
+    RequestAllWorkers(FCNSocket::kFakeData, std::vector<double>(), fakeinput,
+                      &replies);
+    SetRemoteLikelihoods(replies);
+  }
+
   return;
 }
 
@@ -1041,6 +2046,13 @@ void JointFCN::ThrowDataToy() {
     exp->ThrowDataToy();
   }
 
+  if (IsDistributed()) {
+    std::vector<std::vector<double> > replies;
+    RequestAllWorkers(FCNSocket::kThrowToy, std::vector<double>(), "",
+                      &replies);
+    SetRemoteLikelihoods(replies);
+  }
+
   return;
 }
 
@@ -1060,6 +2072,9 @@ std::vector<std::string> JointFCN::GetAllNames() {
     namevect.push_back(exp->GetName());
   }
 
+  // Then samples owned by distributed workers
+  namevect.insert(namevect.end(), fRemoteNames.begin(), fRemoteNames.end());
+
   // Loop over pulls second
   for (PullListConstIter iter = fPulls.begin(); iter != fPulls.end(); iter++) {
     ParamPull *pull = *iter;
@@ -1098,6 +2113,15 @@ std::vector<double> JointFCN::GetAllLikelihoods() {
                         << singlelike);
   }
 
+  // Then samples owned by distributed workers
+  for (size_t i = 0; i < fRemoteLikes.size(); i++) {
+    likevect.push_back(fRemoteLikes[i]);
+    total_likelihood += fRemoteLikes[i];
+
+    NUIS_LOG(MIN, "-> " << std::left << std::setw(40) << fRemoteNames[i]
+                        << " : " << fRemoteLikes[i]);
+  }
+
   // Loop over pulls second
   for (PullListConstIter iter = fPulls.begin(); iter != fPulls.end(); iter++) {
     ParamPull *pull = *iter;
@@ -1137,6 +2161,12 @@ std::vector<int> JointFCN::GetAllNDOF() {
     total_ndof += singlendof;
   }
 
+  // Then samples owned by distributed workers
+  for (size_t i = 0; i < fRemoteNDOF.size(); i++) {
+    ndofvect.push_back(fRemoteNDOF[i]);
+    total_ndof += fRemoteNDOF[i];
+  }
+
   // Loop over pulls second
   for (PullListConstIter iter = fPulls.begin(); iter != fPulls.end(); iter++) {
     ParamPull *pull = *iter;
@@ -1152,3 +2182,617 @@ std::vector<int> JointFCN::GetAllNDOF() {
 
   return ndofvect;
 }
+
+//***************************************************
+std::vector<nuiskey>
+JointFCN::GetWorkerSampleKeys(std::vector<nuiskey> const &samplekeys,
+                              int index, int nworkers) {
+  //***************************************************
+
+  if (nworkers < 1)
+    return samplekeys;
+
+  if (index < 0 || index >= nworkers) {
+    NUIS_ABORT("DistributedWorkerIndex " << index << " is outside 0 to "
+                                         << nworkers - 1);
+  }
+
+  std::vector<nuiskey> workerkeys;
+  for (size_t i = 0; i < samplekeys.size(); i++) {
+    if (int(i % nworkers) == index)
+      workerkeys.push_back(samplekeys[i]);
+  }
+  return workerkeys;
+}
+
+//***************************************************
+UInt_t JointFCN::GetWorkerSeed(ULong64_t masterseed, int index) {
+  //***************************************************
+
+  // SplitMix64 finaliser, so neighbouring workers get unrelated seeds
+  ULong64_t z = masterseed + 0x9E3779B97F4A7C15ULL * ULong64_t(index + 1);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  z = z ^ (z >> 31);
+
+  // TRandom3 treats a zero seed as a request for a random one
+  UInt_t seed = UInt_t(z & 0xFFFFFFFFULL);
+  return seed ? seed : 1;
+}
+
+//***************************************************
+void JointFCN::StartDistributedWorkers(std::vector<nuiskey> const &samplekeys,
+                                       int nworkers) {
+  //***************************************************
+
+  int nremote = FitPar::Config().GetParI("DistributedRemoteWorkers");
+  nremote = std::max(0, std::min(nremote, nworkers));
+  int nlocal = nworkers - nremote;
+
+  std::string host = FitPar::Config().GetParS("DistributedHost");
+  if (host.empty())
+    host = "127.0.0.1";
+  int port = FitPar::Config().GetParI("DistributedPort");
+  double timeout = FitPar::Config().GetParD("DistributedTimeout");
+
+  if (nremote && !port) {
+    NUIS_ABORT("DistributedRemoteWorkers needs a fixed DistributedPort for "
+               "the remote workers to connect to.");
+  }
+
+  int listenfd = FCNSocket::Listen(host, port, nworkers);
+  if (listenfd < 0) {
+    NUIS_ABORT("Could not listen for distributed workers on " << host << ":"
+                                                              << port);
+  }
+
+  NUIS_LOG(FIT, "Distributing " << samplekeys.size() << " samples over "
+                                << nworkers << " workers (" << nlocal
+                                << " local) on " << host << ":" << port);
+  for (int w = nlocal; w < nworkers; w++) {
+    NUIS_LOG(FIT, "Waiting for remote worker "
+                      << w << ", start it with the same card and -q "
+                      << "DistributedCoordinator=<this host>:" << port
+                      << " -q DistributedWorkerIndex=" << w
+                      << " -q DistributedWorkers=" << nworkers);
+  }
+
+  // Local workers connect back over loopback unless bound elsewhere
+  std::string localhost =
+      (host == "0.0.0.0" || host == "*") ? std::string("127.0.0.1") : host;
+  std::string outname =
+      Config::Get().out ? std::string(Config::Get().out->GetName())
+                        : std::string("nuisance");
+
+  // Nothing has been reconfigured in this process yet, so the workers can
+  // keep their own OpenMP threads.
+  for (int w = 0; w < nlocal; w++) {
+    pid_t pid = fork();
+    if (pid < 0) {
+      NUIS_ABORT("Failed to fork distributed worker " << w);
+    }
+
+    if (pid == 0) {
+      close(listenfd);
+
+      TFile *workerfile =
+          new TFile(Form("%s.worker%i.root", outname.c_str(), w), "RECREATE");
+      Config::Get().out = workerfile;
+      fOutputDir = workerfile;
+
+      // Pulls stay with the coordinator
+      for (PullListConstIter iter = fPulls.begin(); iter != fPulls.end();
+           iter++) {
+        delete *iter;
+      }
+      fPulls.clear();
+
+      LoadSamples(GetWorkerSampleKeys(samplekeys, w, nworkers));
+
+      FCNSocket *socket = FCNSocket::Connect(localhost, port, timeout);
+      if (!socket) {
+        _exit(1);
+      }
+      ServeDistributed(socket, w);
+      delete socket;
+
+      // Skip the parent's exit handlers and open files
+      _exit(0);
+    }
+
+    fWorkerPids.push_back(pid);
+  }
+
+  // Take connections in whatever order they come and place them by index
+  fWorkers.assign(nworkers, NULL);
+  fWorkerNSamples.assign(nworkers, 0);
+  std::vector<std::vector<std::string> > workernames(nworkers);
+  std::vector<std::vector<double> > workerndof(nworkers);
+
+  // Accept in short slices, so a local worker that dies while loading its
+  // samples stops the fit straight away rather than after the full timeout.
+  FCNStageTimer::clock::time_point start = FCNStageTimer::Now();
+  for (int n = 0; n < nworkers; n++) {
+    FCNSocket *socket = NULL;
+    while (!socket) {
+      double remaining = timeout - FCNStageTimer::Since(start);
+      if (remaining <= 0.0) {
+        NUIS_ABORT("Only " << n << " of " << nworkers
+                           << " distributed workers connected within "
+                           << timeout << "s");
+      }
+      socket = FCNSocket::Accept(listenfd, std::min(remaining, 1.0));
+
+      for (size_t w = 0; w < fWorkerPids.size() && !socket; w++) {
+        int status = 0;
+        if (waitpid(fWorkerPids[w], &status, WNOHANG) == fWorkerPids[w]) {
+          NUIS_ABORT("Distributed worker "
+                     << w << " (pid " << fWorkerPids[w]
+                     << ") exited before connecting, status " << status);
+        }
+      }
+    }
+
+    int type = 0;
+    std::vector<double> hello;
+    std::string text;
+    if (!socket->Receive(type, hello, text) || type != FCNSocket::kHello ||
+        hello.empty()) {
+      NUIS_ABORT("Distributed worker did not introduce itself.");
+    }
+
+    int index = int(hello[0]);
+    if (index < 0 || index >= nworkers || fWorkers[index]) {
+      NUIS_ABORT("Unexpected distributed worker index " << index);
+    }
+    fWorkers[index] = socket;
+
+    std::stringstream names(text);
+    std::string name;
+    while (std::getline(names, name)) {
+      workernames[index].push_back(name);
+    }
+    workerndof[index].assign(hello.begin() + 1, hello.end());
+
+    if (workernames[index].size() != workerndof[index].size()) {
+      NUIS_ABORT("Distributed worker " << index
+                                       << " sent a malformed sample list.");
+    }
+
+    fWorkerNSamples[index] = workernames[index].size();
+    NUIS_LOG(FIT, "Distributed worker " << index << " connected with "
+                                        << fWorkerNSamples[index]
+                                        << " samples");
+  }
+  close(listenfd);
+
+  for (int w = 0; w < nworkers; w++) {
+    for (int i = 0; i < fWorkerNSamples[w]; i++) {
+      fRemoteNames.push_back(workernames[w][i]);
+      fRemoteNDOF.push_back(int(workerndof[w][i]));
+      fRemoteLikes.push_back(0.0);
+    }
+  }
+}
+
+//***************************************************
+void JointFCN::ServeDistributed(FCNSocket *socket, int index) {
+  //***************************************************
+
+  // Forked workers inherit the coordinator's gRandom and remote ones all
+  // start from the default, so give each worker its own stream for toys.
+  gRandom->SetSeed(GetWorkerSeed(gRandom->GetSeed(), index));
+
+  std::vector<double> hello(1, double(index));
+  std::string names;
+  for (MeasListConstIter iter = fSamples.begin(); iter != fSamples.end();
+       iter++) {
+    hello.push_back((*iter)->GetNDOF());
+    names += (names.empty() ? "" : "\n") + (*iter)->GetName();
+  }
+
+  if (fSamples.empty()) {
+    NUIS_ERR(WRN, "Distributed worker " << index << " owns no samples.");
+  }
+  if (!socket->Send(FCNSocket::kHello, hello, names)) {
+    NUIS_ABORT("Distributed worker " << index
+                                     << " could not reach the coordinator.");
+  }
+
+  FitWeight *rw = FitBase::GetRW();
+  int type = 0;
+  std::vector<double> values;
+  std::string text;
+  bool serving = true;
+
+  while (serving && socket->Receive(type, values, text)) {
+    std::vector<double> reply;
+    std::string error;
+
+    if (type == FCNSocket::kEval) {
+      // Full flag, then the dials in FitWeight order
+      if (values.empty() || values.size() - 1 != rw->GetDialValues().size()) {
+        error = "dial count does not match the coordinator";
+      } else {
+        bool fullconfig = (values[0] != 0.0);
+        fDialChanged = false;
+        if (values.size() > 1) {
+          fDialChanged = rw->HasRWDialChanged(&values[1]);
+          rw->UpdateWeightEngine(&values[1]);
+        }
+        if (fDialChanged || fullconfig) {
+          rw->Reconfigure();
+          FitBase::EvtManager().ResetWeightFlags();
+        }
+        ReconfigureSamples(fullconfig);
+        reply = GetWorkerLikelihoods();
+      }
+
+    } else if (type == FCNSocket::kFakeData) {
+      SetFakeData(text);
+      reply = GetWorkerLikelihoods();
+
+    } else if (type == FCNSocket::kThrowToy) {
+      ThrowDataToy();
+      reply = GetWorkerLikelihoods();
+
+    } else if (type == FCNSocket::kWrite) {
+      TDirectory *dir = Config::Get().out;
+      if (!dir) {
+        error = "worker has no output file";
+      } else {
+        std::stringstream path(text);
+        std::string sub;
+        while (std::getline(path, sub, '/')) {
+          if (sub.empty())
+            continue;
+          TDirectory *subdir = dir->GetDirectory(sub.c_str());
+          dir = subdir ? subdir : dir->mkdir(sub.c_str());
+        }
+        dir->cd();
+        Write();
+      }
+
+    } else if (type == FCNSocket::kStop) {
+      serving = false;
+
+    } else {
+      error = "unknown request";
+    }
+
+    bool sent = error.empty()
+                    ? socket->Send(FCNSocket::kReply, reply)
+                    : socket->Send(FCNSocket::kError, reply, error);
+    if (!sent)
+      break;
+  }
+
+  if (serving) {
+    NUIS_ERR(WRN, "Distributed worker " << index
+                                        << " lost its coordinator.");
+  }
+
+  if (Config::Get().out && Config::Get().out->IsOpen()) {
+    Config::Get().out->Close();
+  }
+}
+
+//***************************************************
+void JointFCN::ReconfigureDistributed(bool fullconfig) {
+  //***************************************************
+
+  FCNStageTimer::clock::time_point start = FCNStageTimer::Now();
+
+  std::vector<double> request(1, fullconfig ? 1.0 : 0.0);
+  std::vector<double> dials = FitBase::GetRW()->GetDialValues();
+  request.insert(request.end(), dials.begin(), dials.end());
+
+  std::vector<std::vector<double> > replies;
+  RequestAllWorkers(FCNSocket::kEval, request, "", &replies);
+  SetRemoteLikelihoods(replies);
+
+  fTimer.Add(FCNStageTimer::kFill, FCNStageTimer::Since(start));
+}
+
+//***************************************************
+std::vector<double> JointFCN::GetWorkerLikelihoods() {
+  //***************************************************
+
+  std::vector<double> reply;
+  for (MeasListConstIter iter = fSamples.begin(); iter != fSamples.end();
+       iter++) {
+    reply.push_back((*iter)->GetLikelihood());
+  }
+  for (MeasListConstIter iter = fSamples.begin(); iter != fSamples.end();
+       iter++) {
+    reply.push_back((*iter)->GetNDOF());
+  }
+  return reply;
+}
+
+//***************************************************
+void JointFCN::SetRemoteLikelihoods(
+    std::vector<std::vector<double> > const &replies) {
+  //***************************************************
+
+  size_t offset = 0;
+  for (size_t w = 0; w < fWorkers.size(); w++) {
+    size_t n = fWorkerNSamples[w];
+    if (replies[w].size() != 2 * n) {
+      NUIS_ABORT("Distributed worker " << w << " returned "
+                                       << replies[w].size()
+                                       << " values for " << n << " samples");
+    }
+    for (size_t i = 0; i < n; i++) {
+      fRemoteLikes[offset + i] = replies[w][i];
+      fRemoteNDOF[offset + i] = int(replies[w][n + i]);
+    }
+    offset += n;
+  }
+}
+
+//***************************************************
+void JointFCN::RequestAllWorkers(int type, std::vector<double> const &values,
+                                 std::string const &text,
+                                 std::vector<std::vector<double> > *replies) {
+  //***************************************************
+
+  for (size_t w = 0; w < fWorkers.size(); w++) {
+    if (!fWorkers[w]->Send(type, values, text)) {
+      NUIS_ABORT("Lost connection to distributed worker " << w);
+    }
+  }
+
+  if (replies)
+    replies->assign(fWorkers.size(), std::vector<double>());
+
+  for (size_t w = 0; w < fWorkers.size(); w++) {
+    int replytype = 0;
+    std::vector<double> reply;
+    std::string replytext;
+    if (!fWorkers[w]->Receive(replytype, reply, replytext)) {
+      NUIS_ABORT("Lost connection to distributed worker " << w);
+    }
+    if (replytype != FCNSocket::kReply) {
+      NUIS_ABORT("Distributed worker " << w << " failed: " << replytext);
+    }
+    if (replies)
+      (*replies)[w] = reply;
+  }
+}
+
+//***************************************************
+void JointFCN::StopDistributedWorkers() {
+  //***************************************************
+
+  for (size_t w = 0; w < fWorkers.size(); w++) {
+    if (!fWorkers[w])
+      continue;
+
+    std::vector<double> reply;
+    std::string replytext;
+    if (!fWorkers[w]->Request(FCNSocket::kStop, std::vector<double>(), "",
+                              reply, replytext)) {
+      NUIS_ERR(WRN, "Distributed worker " << w
+                                          << " did not stop cleanly: "
+                                          << replytext);
+    }
+    delete fWorkers[w];
+  }
+  fWorkers.clear();
+
+  for (size_t w = 0; w < fWorkerPids.size(); w++) {
+    int status = 0;
+    waitpid(fWorkerPids[w], &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+      NUIS_ERR(WRN, "Distributed worker " << w << " (pid " << fWorkerPids[w]
+                                          << ") did not exit cleanly.");
+    }
+  }
+  fWorkerPids.clear();
+}
+
+//***************************************************
+bool SampleSignalCache::IsCustomBox(MeasurementVariableBox *box) {
+  //***************************************************
+
+  // Default boxes hold nothing beyond X, Y and Z, anything else must be
+  // kept whole for FillExtraHistograms.
+  std::type_info const &type = typeid(*box);
+  return (type != typeid(MeasurementVariableBox) &&
+          type != typeid(MeasurementVariableBox1D) &&
+          type != typeid(MeasurementVariableBox2D));
+}
+
+//***************************************************
+void SampleSignalCache::Add(int event, MeasurementVariableBox *box,
+                            int mcbin, int finebin) {
+  //***************************************************
+
+  if (fEvent.empty()) {
+    fCustomBox = IsCustomBox(box);
+  }
+
+  fEvent.push_back(event);
+  if (fCustomBox) {
+    fBoxes.push_back(box->CloneSignalBox());
+    return;
+  }
+
+  fVars.push_back(box->GetX());
+  fVars.push_back(box->GetY());
+  fVars.push_back(box->GetZ());
+  fSampleWeight.push_back(box->GetSampleWeight());
+  fBins.push_back(mcbin);
+  fBins.push_back(finebin);
+}
+
+//***************************************************
+void SampleSignalCache::Append(SampleSignalCache const &other, int offset) {
+  //***************************************************
+
+  if (other.fEvent.empty())
+    return;
+  if (fEvent.empty())
+    fCustomBox = other.fCustomBox;
+
+  fEvent.reserve(fEvent.size() + other.fEvent.size());
+  for (size_t i = 0; i < other.fEvent.size(); i++) {
+    fEvent.push_back(other.fEvent[i] + offset);
+  }
+  fVars.insert(fVars.end(), other.fVars.begin(), other.fVars.end());
+  fSampleWeight.insert(fSampleWeight.end(), other.fSampleWeight.begin(),
+                       other.fSampleWeight.end());
+  fBins.insert(fBins.end(), other.fBins.begin(), other.fBins.end());
+  fBoxes.insert(fBoxes.end(), other.fBoxes.begin(), other.fBoxes.end());
+}
+
+//***************************************************
+void SampleSignalCache::Compact() {
+  //***************************************************
+
+  std::vector<int>(fEvent).swap(fEvent);
+  std::vector<double>(fVars).swap(fVars);
+  std::vector<double>(fSampleWeight).swap(fSampleWeight);
+  std::vector<int>(fBins).swap(fBins);
+  std::vector<MeasurementVariableBox *>(fBoxes).swap(fBoxes);
+}
+
+//***************************************************
+size_t SampleSignalCache::GetMemoryUsage() const {
+  //***************************************************
+
+  return sizeof(SampleSignalCache) +
+         (fEvent.capacity() + fBins.capacity()) * sizeof(int) +
+         (fVars.capacity() + fSampleWeight.capacity()) * sizeof(double) +
+         fBoxes.capacity() * sizeof(MeasurementVariableBox *);
+}
+
+//***************************************************
+FCNStageTimer::FCNStageTimer() {
+  //***************************************************
+
+  Setup(std::vector<std::string>());
+}
+
+//***************************************************
+void FCNStageTimer::Setup(std::vector<std::string> const &samplenames) {
+  //***************************************************
+
+  fSampleNames = samplenames;
+  for (int i = 0; i < kNStages; i++) {
+    fEval[i] = 0.0;
+    fTotal[i] = 0.0;
+  }
+  fEvalSample.assign(fSampleNames.size() * kNStages, 0.0);
+  fTotalSample.assign(fSampleNames.size() * kNStages, 0.0);
+  fEvalTime = 0.0;
+  fTotalTime = 0.0;
+  fNEvals = 0;
+}
+
+//***************************************************
+void FCNStageTimer::StartEval() {
+  //***************************************************
+
+  for (int i = 0; i < kNStages; i++) {
+    fEval[i] = 0.0;
+  }
+  std::fill(fEvalSample.begin(), fEvalSample.end(), 0.0);
+}
+
+//***************************************************
+void FCNStageTimer::EndEval(double seconds) {
+  //***************************************************
+
+  fEvalTime = seconds;
+  fTotalTime += seconds;
+  fNEvals++;
+}
+
+//***************************************************
+void FCNStageTimer::Add(Stage stage, double seconds, int isample) {
+  //***************************************************
+
+  fEval[stage] += seconds;
+  fTotal[stage] += seconds;
+  if (isample >= 0 && isample < (int)fSampleNames.size()) {
+    fEvalSample[isample * kNStages + stage] += seconds;
+    fTotalSample[isample * kNStages + stage] += seconds;
+  }
+}
+
+//***************************************************
+double FCNStageTimer::GetEvalSample(Stage stage, int isample) const {
+  //***************************************************
+
+  if (isample < 0 || isample >= (int)fSampleNames.size())
+    return 0.0;
+  return fEvalSample[isample * kNStages + stage];
+}
+
+//***************************************************
+std::string FCNStageTimer::GetStageName(Stage stage) {
+  //***************************************************
+
+  switch (stage) {
+  case kRWReconfigure:
+    return "rw_reconfigure";
+  case kEventReweight:
+    return "event_reweight";
+  case kEventLoop:
+    return "event_loop";
+  case kFill:
+    return "fill";
+  case kConvert:
+    return "convert";
+  case kLikelihood:
+    return "likelihood";
+  default:
+    return "unknown";
+  }
+}
+
+//***************************************************
+void FCNStageTimer::PrintSummary() const {
+  //***************************************************
+
+  double staged = 0.0;
+  for (int i = 0; i < kNStages; i++) {
+    staged += fTotal[i];
+  }
+  if (staged <= 0.0) {
+    return;
+  }
+
+  NUIS_LOG(FIT, "FCN stage timing over " << fNEvals << " evaluations ("
+                                         << fTotalTime << " s in DoEval, "
+                                         << staged << " s in timed stages)");
+  for (int i = 0; i < kNStages; i++) {
+    NUIS_LOG(FIT, " -> " << std::left << std::setw(20)
+                         << GetStageName(Stage(i)) << " : " << std::setw(12)
+                         << fTotal[i] << " s (" << std::setprecision(3)
+                         << 100.0 * fTotal[i] / staged << std::setprecision(6)
+                         << "%)");
+  }
+
+  // Slowest samples first, these are the ones worth optimising
+  std::vector<std::pair<double, int> > order;
+  for (size_t isample = 0; isample < fSampleNames.size(); isample++) {
+    double total = 0.0;
+    for (int i = 0; i < kNStages; i++) {
+      total += fTotalSample[isample * kNStages + i];
+    }
+    order.push_back(std::make_pair(-total, int(isample)));
+  }
+  std::sort(order.begin(), order.end());
+
+  NUIS_LOG(FIT, "Per sample fill / convert / likelihood time (s):");
+  for (size_t i = 0; i < order.size(); i++) {
+    int isample = order[i].second;
+    double const *times = &fTotalSample[isample * kNStages];
+    NUIS_LOG(FIT, " -> " << std::left << std::setw(49) << fSampleNames[isample]
+                         << " : " << times[kFill] << " / " << times[kConvert]
+                         << " / " << times[kLikelihood]);
+  }
+}
@@ -5,10 +5,13 @@
  *  @{
  */
 
+#include <chrono>
+#include <functional>
 #include <iostream>
 #include <vector>
 #include <fstream>
 #include <list>
+#include <mutex>
 
 // ROOT headers
 #include "TTree.h"
@@ -34,9 +37,110 @@
 #include "NuisKey.h"
 #include "MeasurementVariableBox.h"
 #include "MeasurementVariableBox1D.h"
+#include "OpenMPWrapper.h"
+#include "SplineCoeffStore.h"
+#include "FCNSocket.h"
+
+#include <sys/types.h>
 
 using namespace FitUtils;
 using namespace FitBase;
+
+//! Signal events saved for one subsample by a signal reconfigure, held as
+//! flat sample-major arrays that the fast reconfigure streams through.
+//! Samples with a custom variable box keep their box clones, all others
+//! only need the X, Y, Z variables the default boxes carry.
+struct SampleSignalCache {
+  SampleSignalCache() : fCustomBox(false){};
+
+  std::vector<int> fEvent;         //!< Signal event index into the weights
+  std::vector<double> fVars;       //!< X, Y, Z for each saved event
+  std::vector<double> fSampleWeight; //!< Sample weight for each saved event
+  std::vector<int> fBins;          //!< MC and fine MC bin for each saved event
+  std::vector<MeasurementVariableBox*> fBoxes; //!< Clones, custom boxes only
+  bool fCustomBox;
+
+  inline size_t GetNEvents() const { return fEvent.size(); };
+
+  //! True if box carries more than the default X, Y, Z variables
+  static bool IsCustomBox(MeasurementVariableBox* box);
+
+  //! Save a signal event from the sample's filled box and the histogram
+  //! bins from MeasurementBase::FindFillBins
+  void Add(int event, MeasurementVariableBox* box, int mcbin, int finebin);
+
+  //! Append another cache, offsetting its event indices
+  void Append(SampleSignalCache const& other, int offset);
+
+  //! Release spare capacity once filled
+  void Compact();
+
+  //! Bytes held by the flat arrays
+  size_t GetMemoryUsage() const;
+};
+
+//! Wall clock time spent in each stage of the FCN, kept for the current
+//! evaluation (for the iteration tree) and summed over the run (for the
+//! summary printed by the routines). Fill, convert and likelihood times are
+//! also kept per top level sample.
+class FCNStageTimer {
+public:
+  enum Stage {
+    kRWReconfigure = 0, //!< Weight engine and spline reader reconfigures
+    kEventReweight,     //!< Weights of the saved signal events
+    kEventLoop,         //!< Full event loops, reweighting and filling together
+    kFill,              //!< Sample resets and histogram fills
+    kConvert,           //!< ConvertEventRates and renormalisation
+    kLikelihood,        //!< Sample and pull likelihoods
+    kNStages
+  };
+
+  typedef std::chrono::steady_clock clock;
+
+  FCNStageTimer();
+
+  //! Size the per sample containers and clear all times
+  void Setup(std::vector<std::string> const& samplenames);
+
+  //! Zero the times of the current evaluation
+  void StartEval();
+
+  //! Close the current evaluation, which took seconds in total
+  void EndEval(double seconds);
+
+  //! Add time to a stage, and to a sample unless isample is -1
+  void Add(Stage stage, double seconds, int isample = -1);
+
+  inline double GetEval(Stage stage) const { return fEval[stage]; };
+  inline double GetEvalTotal() const { return fEvalTime; };
+  double GetEvalSample(Stage stage, int isample) const;
+
+  inline int GetNSamples() const { return fSampleNames.size(); };
+  inline std::string const& GetSampleName(int isample) const {
+    return fSampleNames[isample];
+  };
+
+  //! Short name used for iteration tree branches
+  static std::string GetStageName(Stage stage);
+
+  //! Log the run totals for each stage and sample, slowest samples first
+  void PrintSummary() const;
+
+  static inline clock::time_point Now() { return clock::now(); };
+  static inline double Since(clock::time_point const& start) {
+    return std::chrono::duration<double>(clock::now() - start).count();
+  };
+
+private:
+  std::vector<std::string> fSampleNames;
+  double fEval[kNStages];  //!< Current evaluation
+  double fTotal[kNStages]; //!< Whole run
+  std::vector<double> fEvalSample;  //!< Current evaluation, kNStages per sample
+  std::vector<double> fTotalSample; //!< Whole run, kNStages per sample
+  double fEvalTime;  //!< Wall time of the last closed evaluation
+  double fTotalTime; //!< Wall time of all closed evaluations
+  int fNEvals;       //!< Number of closed evaluations
+};
 //! Main FCN Class which ROOT's joint function needs to evaulate the chi2 at each stage of the fit.
 class JointFCN
 {
@@ -56,6 +160,24 @@ public:
   //! Main Likelihood evaluation FCN
   double DoEval(const double *x);
 
+  //! Likelihood and its gradient at x. Spline dials take the derivative of
+  //! every MC bin from one pass over the saved signal spline coefficients
+  //! and fill bins, which is chained through ConvertEventRates and the
+  //! sample likelihoods by differencing them along it. Other dials, and
+  //! every dial if CanUseAnalyticGradient() is false, use central
+  //! differences. If evaluated, the last DoEval was at x and is reused.
+  double DoEvalGradient(const double *x, double *grad, bool evaluated = false);
+
+  //! Whether DoEvalGradient can use analytic spline derivatives. This needs
+  //! spline inputs with the event manager and SignalReconfigures, with
+  //! every saved signal event filled by bin, and reconfigures once if
+  //! nothing has been filled yet.
+  bool CanUseAnalyticGradient();
+
+  //! Compare DoEvalGradient against central differences at x, logging any
+  //! component that disagrees. Returns false on a disagreement.
+  bool CheckGradient(const double *x);
+
   //! Func Wrapper for ROOT
   inline double operator() (const std::vector<double> & x) {
     double* x_array = new double[x.size()];
@@ -105,9 +227,19 @@ public:
   //! Return list of pointers to all the pulls
   inline std::list<ParamPull*> GetPullList() { return fPulls; };
 
+  //! Stage timings of the last evaluation and the run so far
+  inline FCNStageTimer const& GetStageTimer() const { return fTimer; };
+
+  //! Override the number of threads used for reconfigures
+  inline void SetNThreads(int nthreads) { fNThreads = nthreads > 0 ? nthreads : 1; };
+
   //! Write all samples to output DIR
   void Write();
 
+  //! Whether the samples are owned by worker processes, see
+  //! StartDistributedWorkers
+  inline bool IsDistributed() const { return !fWorkers.empty(); };
+
   //! Set Fake data from file/MC
   void SetFakeData(std::string fakeinput);
 
@@ -117,6 +249,58 @@ public:
   //! Reconfigure Fast looping over duplicate inputs
   void ReconfigureFastUsingManager();
 
+  //! Run the event manager loop over entries [first, last) of a single
+  //! input, read through reader (the input itself or one of its clones),
+  //! appending any saved signal information to the given containers.
+  //! Samples are filled under samplelock, if given. Returns N signal fills.
+  int ReconfigureInputUsingManager(
+      InputHandlerBase* curinput, InputHandlerBase* reader, int first,
+      int last, bool savesignal, std::vector<bool>& eventflags,
+      std::vector<SampleSignalCache>& samplecache, int& nsignal,
+      std::vector< std::vector<float> >& eventsplines,
+      std::mutex* samplelock);
+
+  //! Readers for up to nreaders chunks of input iinput, the input itself
+  //! first. Clones are opened on first use and kept, so fewer are returned
+  //! if the input cannot be cloned.
+  std::vector<InputHandlerBase*> const& GetInputReaders(int iinput,
+                                                        int nreaders);
+
+  //! Map each saved signal event back to its input and entry so the fast
+  //! reconfigure does not need to walk the full signal flag list.
+  void BuildSignalEventIndex();
+
+  //! Receives the derivatives of the signal weights [first, first + n),
+  //! derivs[k][i] for event first + i, from the thread that made them.
+  typedef std::function<void(int first, int n, double const *const *derivs)>
+      SignalDerivativeSink;
+
+  //! Weights of every saved signal event from the spline column stores,
+  //! with the other engines weighted per input. If sink is given, the
+  //! derivatives of each chunk of weights with respect to the dial moving
+  //! splines (*dialsplines)[input][k] are handed to it as they are made.
+  void CalcSignalSplineWeights(
+      double *weights,
+      std::vector<std::vector<std::vector<int> > > const *dialsplines = NULL,
+      SignalDerivativeSink const *sink = NULL);
+
+  //! Reset the samples, fill them from the saved signal events with the
+  //! given weights and, unless convert is false, convert the event rates.
+  //! Returns N signal fills.
+  int FillSignalEvents(double const *weights, bool convert = true);
+
+  //! ConvertEventRates for every sample
+  void ConvertSampleEventRates();
+
+  //! Fill curmeas from a cache of default boxes through the saved bins.
+  //! The caller finalises.
+  void FillSavedBins(MeasurementBase* curmeas, SampleSignalCache const& cache,
+                     double const* weights);
+
+  //! Move the saved signal spline rows into one column store per input.
+  void BuildSignalSplineStores();
+  void ClearSignalSplineStores();
+
 
   /// Throws data according to current stats
   void ThrowDataToy();
@@ -138,6 +322,14 @@ public:
   void SetNParams(int npar){
     fNPars = npar;
   }
+  int GetNParams() const { return fNPars; }
+
+  //! Number of sample reconfigures so far
+  UInt_t GetNReconfigures() const { return fCurIter; }
+  //! Fixed parameters get a zero gradient without being evaluated
+  void SetVariableFixed(int ipar, bool fixed){
+    fFixedParams[ipar] = fixed;
+  }
 
 private:
 
@@ -164,16 +356,26 @@ private:
   int *   fSampleNDOF;     //!< NDOF for each individual measurement in list
 
   bool fUsingEventManager; //!< Flag for doing joint comparisons
+  int  fNThreads;          //!< Worker threads for event manager reconfigures
 
   std::vector< std::vector<float> > fSignalEventSplines;
-  std::vector< std::vector<MeasurementVariableBox*> > fSignalEventBoxes;
   std::vector< bool > fSignalEventFlags;
-  std::vector< std::vector<bool> > fSampleSignalFlags;
+  std::vector< SampleSignalCache > fSignalCache; //!< Per subsample
+  int fNSignalEvents;                            //!< Events in fSignalCache
+  std::vector< int > fSignalEventInputs;  //!< fInputList index per signal event
+  std::vector< int > fSignalEventEntries; //!< Input entry per signal event
+  std::vector< int > fInputSignalStart;   //!< First signal event per input
+  std::vector< SplineCoeffStore* > fSignalSplineStores; //!< Per input
+  FitWeightCache fSignalWeightCache; //!< Per signal event engine weights
 
   std::vector<InputHandlerBase*> fInputList;
+  std::vector< std::vector<InputHandlerBase*> > fInputReaders; //!< Per input
   std::vector<MeasurementBase*> fSubSampleList;
+  std::vector<int> fSubSampleOwner; //!< fSamples index per subsample
   bool fIsAllSplines;
 
+  FCNStageTimer fTimer; //!< Time spent in each stage of the evaluation
+
 
   std::vector< int > fIterationCount;
   std::vector< double > fCurrentValues;
@@ -188,6 +390,58 @@ private:
     bool mirror_above;
   };
   std::map<int, mirror_param> fMirroredParams;
+  std::map<int, bool> fFixedParams;
+
+  //! Apply any mirroring to the minimizer values x, flagging which moved
+  void GetParameterValues(const double *x, double *par_vals,
+                          bool *mirrored = NULL);
+
+  //! Summed likelihood of the samples only, leaving the iteration tree
+  //! containers untouched
+  double GetSampleLikelihood();
+
+  //! Pull likelihood with dial ipar moved to val
+  double GetPullLikelihood(int ipar, double val);
+
+  //! Samples owned by worker index of nworkers, dealt round robin
+  static std::vector<nuiskey> GetWorkerSampleKeys(
+      std::vector<nuiskey> const &samplekeys, int index, int nworkers);
+
+  //! gRandom seed of worker index, derived from masterseed
+  static UInt_t GetWorkerSeed(ULong64_t masterseed, int index);
+
+  //! Fork the local workers, each loading its share of samplekeys, then
+  //! wait for them and any remote workers to connect on DistributedPort.
+  void StartDistributedWorkers(std::vector<nuiskey> const &samplekeys,
+                               int nworkers);
+
+  //! Serve the loaded samples to the coordinator on socket until told to
+  //! stop, then close the output file.
+  void ServeDistributed(FCNSocket *socket, int index);
+
+  //! Broadcast the dial values and collect every worker's likelihoods
+  void ReconfigureDistributed(bool fullconfig);
+
+  //! A worker's reply: its sample likelihoods followed by their NDOFs
+  std::vector<double> GetWorkerLikelihoods();
+
+  //! Store the likelihoods and NDOFs replied by every worker
+  void SetRemoteLikelihoods(std::vector<std::vector<double> > const &replies);
+
+  //! Send a request to every worker before waiting on any of the replies
+  void RequestAllWorkers(int type, std::vector<double> const &values,
+                         std::string const &text,
+                         std::vector<std::vector<double> > *replies = NULL);
+
+  //! Tell the workers to exit and wait for the local ones
+  void StopDistributedWorkers();
+
+  std::vector<FCNSocket *> fWorkers;    //!< Connection per worker index
+  std::vector<pid_t> fWorkerPids;       //!< Forked local workers
+  std::vector<int> fWorkerNSamples;     //!< Samples owned by each worker
+  std::vector<std::string> fRemoteNames; //!< Worker samples, worker order
+  std::vector<double> fRemoteLikes;     //!< Their last likelihoods
+  std::vector<int> fRemoteNDOF;         //!< Their NDOF
   //the number of pars added to the minimizer, should be the same as fNDials
   int fNPars;
 };
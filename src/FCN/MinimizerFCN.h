@@ -5,6 +5,7 @@
 *  @{  
 */
 
+#include <algorithm>
 #include <iostream>
 #include <vector>
 #include "FitLogger.h"
@@ -18,11 +19,13 @@ class MinimizerFCN{
   // Empty Construction
   MinimizerFCN(){
     fFCN = NULL;
+    fEvalIter = 0;
   }
 
   // Construct from function
   MinimizerFCN(JointFCN* f){
     SetFCN(f);
+    fEvalIter = 0;
   };
 
   // Destroy (Doesn't delete FCN)
@@ -56,8 +59,11 @@ class MinimizerFCN{
       NUIS_ERR(FTL,"No FCN Found in MinimizerFCN!");
       NUIS_ABORT("Exiting!");
     }
-    
-    return fFCN->DoEval(x);
+
+    double like = fFCN->DoEval(x);
+    fEvalX.assign(x, x + fFCN->GetNParams());
+    fEvalIter = fFCN->GetNReconfigures();
+    return like;
   };
 
   // Func Operator for vectors
@@ -72,10 +78,43 @@ class MinimizerFCN{
   {
     return this->DoEval(x);
   };
-  
+
+  // Gradient component for ROOT::Math::GradFunctor. The full gradient is
+  // computed once per point and cached, as minimizers ask for every
+  // component at the same x in turn, and reuses the evaluation if the
+  // minimizer has just asked for the value at x.
+  inline double Derivative(const double *x, unsigned int icoord) const
+  {
+
+    if (!fFCN){
+      NUIS_ERR(FTL,"No FCN Found in MinimizerFCN!");
+      NUIS_ABORT("Exiting!");
+    }
+
+    int npars = fFCN->GetNParams();
+    if (fGradX.size() != size_t(npars) ||
+        !std::equal(fGradX.begin(), fGradX.end(), x)){
+      bool evaluated = (fEvalIter == fFCN->GetNReconfigures() &&
+                        fEvalX.size() == size_t(npars) &&
+                        std::equal(fEvalX.begin(), fEvalX.end(), x));
+      fGradX.assign(x, x + npars);
+      fGrad.assign(npars, 0.0);
+      fFCN->DoEvalGradient(x, &fGrad[0], evaluated);
+      fEvalX = fGradX;
+      fEvalIter = fFCN->GetNReconfigures();
+    }
+
+    return fGrad[icoord];
+  };
+
  private:
-  
+
   JointFCN* fFCN;
+
+  mutable std::vector<double> fEvalX; //!< Where DoEval last left the FCN
+  mutable UInt_t fEvalIter;           //!< Its reconfigure count then
+  mutable std::vector<double> fGradX;
+  mutable std::vector<double> fGrad;
 };
 /*! @} */
 #endif // _MINIMIZER_FCN_H_
@@ -84,20 +84,35 @@ InputHandlerBase* EventManager::AddInput(std::string handle, std::string infile)
   InputUtils::InputType inpType =
       InputUtils::ParseInputType(file_descriptor[0]);
 
+  std::unique_lock<std::mutex> lock(finputmutex);
   int id = GetInputID(file_descriptor[1]);
   if ((uint)id != fid.size()) {
     NUIS_LOG(SAM,"Event manager already contains " << file_descriptor[1]);
+
+    // Another sample may still be opening it
+    while (!finputs[id]) {
+      finputready.wait(lock);
+    }
     return finputs[id];
   } 
 
   fid[file_descriptor[1]] = id;
-  finputs[id] = InputUtils::CreateInputHandler(handle, inpType, file_descriptor[1]);
-  frwneeded[id] = std::vector<bool>(finputs[id]->GetNEvents(), true);
-  calc_rw[id] = std::vector<double>(finputs[id]->GetNEvents(), 0.0);
+  finputs[id] = NULL;
+  lock.unlock();
+
+  InputHandlerBase* input =
+      InputUtils::CreateInputHandler(handle, inpType, file_descriptor[1]);
+
+  lock.lock();
+  finputs[id] = input;
+  frwneeded[id] = std::vector<bool>(input->GetNEvents(), true);
+  calc_rw[id] = std::vector<double>(input->GetNEvents(), 0.0);
+  lock.unlock();
+  finputready.notify_all();
   
   NUIS_LOG(SAM,"Registered " << handle << " with EventManager.");
 
-  return finputs[id];
+  return input;
 }
 
 // Reset the weight flags
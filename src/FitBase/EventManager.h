@@ -24,6 +24,9 @@
 #include "FitWeight.h"
 #include "InputUtils.h"
 #include "InputFactory.h"
+
+#include <condition_variable>
+#include <mutex>
 // This class is meant to manage one input file for many distributions
 class EventManager {
  public:
@@ -53,6 +56,12 @@ class EventManager {
   std::map< int, std::vector< bool > > frwneeded;
   std::map< int, std::vector< double > > calc_rw;
 
+  // AddInput may be called from several threads while samples are built.
+  // An input is registered under the lock but opened outside it, anyone
+  // else asking for it waits on finputready.
+  std::mutex finputmutex;
+  std::condition_variable finputready;
+
 };
 
 
@@ -25,6 +25,9 @@ Measurement1D::Measurement1D(void) {
   // XSec Scalings
   fScaleFactor = -1.0;
   fCurrentNorm = 1.0;
+  fNBinFills = 0;
+  fNResetBinFills = 0;
+  fSavedEntries = 0.0;
 
   // Histograms
   fDataHist = NULL;
@@ -509,6 +512,7 @@ void Measurement1D::ScaleCovar(double scale) {
   (*fFullCovar) *= scale;
   (*covar) *= 1.0 / scale;
   (*fDecomp) *= sqrt(scale);
+  fCovChi2.Reset();
 }
 
 //********************************************************************
@@ -647,6 +651,9 @@ void Measurement1D::FinaliseMeasurement() {
   }	
   // ***** end NS covar modifications *****
 
+  // covar may have been replaced above, drop any cached chi2 matrix
+  fCovChi2.Reset();
+
 
   // Setup fMCHist from data
   fMCHist = (TH1D *)fDataHist->Clone();
@@ -937,6 +944,8 @@ void Measurement1D::ResetAll() {
   fMCHist->Reset();
   fMCFine->Reset();
   fMCStat->Reset();
+  fNBinFills = 0;
+  fNResetBinFills = 0;
 
   return;
 };
@@ -949,6 +958,17 @@ void Measurement1D::FillHistograms() {
 
     NUIS_LOG(DEB, "Fill MCHist: " << fXVar << ", " << Weight);
 
+    // Signal reconfigures save the bins, skip the search if fXVar is the
+    // value they were found for.
+    MeasurementVariableBox *box = GetBox();
+    if (box->fMCBin != -1 && fXVar == box->GetX()) {
+      PlotUtils::FillBin(fMCHist, box->fMCBin, Weight);
+      PlotUtils::FillBin(fMCStat, box->fMCBin, 1.0);
+      PlotUtils::FillBin(fMCFine, box->fFineBin, Weight);
+      fNBinFills++;
+      return;
+    }
+
     // If it's single bin, whatever the limits on the plot are don't apply
     if (fIsSingleBin){
       fMCHist->Fill(fMCHist->GetBinCenter(1), Weight);
@@ -970,6 +990,65 @@ void Measurement1D::FillHistograms() {
   return;
 };
 
+//********************************************************************
+void Measurement1D::FindFillBins(int &mcbin, int &finebin) {
+  //********************************************************************
+
+  mcbin = -1;
+  finebin = -1;
+  if (fMCHist_Modes or fMCFine_Modes or
+      fMCStat->GetNcells() != fMCHist->GetNcells())
+    return;
+
+  mcbin = fIsSingleBin ? 1 : fMCHist->FindBin(fXVar);
+  finebin = fMCFine->FindBin(fXVar);
+}
+
+//********************************************************************
+void Measurement1D::FinaliseBinFills() {
+  //********************************************************************
+
+  if (!fNBinFills)
+    return;
+
+  fMCHist->SetEntries(fMCHist->GetEntries() + fNBinFills);
+  fMCFine->SetEntries(fMCFine->GetEntries() + fNBinFills);
+  fMCStat->SetEntries(fMCStat->GetEntries() + fNBinFills);
+  fNResetBinFills += fNBinFills;
+  fNBinFills = 0;
+}
+
+//********************************************************************
+int Measurement1D::SaveBinFills(int nfills) {
+  //********************************************************************
+
+  if (fMCHist_Modes or fMCFine_Modes or nfills != fNResetBinFills or
+      fMCStat->GetNcells() != fMCHist->GetNcells())
+    return -1;
+
+  PlotUtils::GetBinContents(fMCHist, fSavedMC, fSavedMCErr2);
+  PlotUtils::GetBinContents(fMCFine, fSavedFine, fSavedFineErr2);
+  PlotUtils::GetBinContents(fMCStat, fSavedStat, fSavedStatErr2);
+  fSavedEntries = fMCHist->GetEntries();
+
+  return fMCHist->GetNcells();
+}
+
+//********************************************************************
+void Measurement1D::RestoreBinFills(double const *shift,
+                                    double const *shifterr2) {
+  //********************************************************************
+
+  PlotUtils::SetBinContents(fMCHist, fSavedMC, fSavedMCErr2, shift,
+                            shifterr2);
+  PlotUtils::SetBinContents(fMCFine, fSavedFine, fSavedFineErr2);
+  PlotUtils::SetBinContents(fMCStat, fSavedStat, fSavedStatErr2);
+
+  fMCHist->SetEntries(fSavedEntries);
+  fMCFine->SetEntries(fSavedEntries);
+  fMCStat->SetEntries(fSavedEntries);
+}
+
 //********************************************************************
 void Measurement1D::ScaleEvents() {
   //********************************************************************
@@ -1158,8 +1237,11 @@ double Measurement1D::GetLikelihood() {
     } else if (fIsDiag) {
       stat = StatUtils::GetChi2FromDiag(fDataHist, fMCHist, fMaskHist);
     } else if (!fIsDiag and !fIsRawEvents) {
-      stat = StatUtils::GetChi2FromCov(fDataHist, fMCHist, covar, fMaskHist, 1,
-                                       1E76, fIsWriting ? fResidualHist : NULL);
+      if (!fCovChi2.IsSetup(covar, fMaskHist)) {
+        fCovChi2.Setup(fDataHist, covar, fMaskHist);
+      }
+      stat = fCovChi2.Eval(fDataHist, fMCHist, 1,
+                           fIsWriting ? fResidualHist : NULL);
       if (fChi2LessBinHist && fIsWriting) {
         for (int xi = 0; xi < fDataHist->GetNbinsX(); ++xi) {
           TH1I *binmask = fMaskHist
@@ -1292,6 +1374,7 @@ void Measurement1D::SetFakeDataValues(std::string fakeOption) {
   if (covar)
     delete covar;
   covar = StatUtils::GetInvert(fFullCovar, true);
+  fCovChi2.Reset();
 
   if (fDecomp)
     delete fDecomp;
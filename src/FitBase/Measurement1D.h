@@ -358,6 +358,23 @@ public:
   /// even if they have been set to auto process.
   virtual void FillHistograms(void);
 
+  /// \brief Saved bins for the standard MC histograms
+  ///
+  /// Used by signal reconfigures so that FillHistograms can add straight into
+  /// the saved bins. Returns -1 for both if mode stacks are being filled.
+  virtual void FindFillBins(int& mcbin, int& finebin);
+
+  /// Add the entries from fills by saved bin to the MC histograms.
+  virtual void FinaliseBinFills(void);
+
+  /// Keep the MC, fine MC and stat histograms as filled, if every fill
+  /// since ResetAll went into saved bins.
+  virtual int SaveBinFills(int nfills);
+
+  /// Put back the histograms kept by SaveBinFills, shifting the MC bins.
+  virtual void RestoreBinFills(double const* shift = NULL,
+                               double const* shifterr2 = NULL);
+
   // \brief Convert event rates to final histogram
   ///
   /// Apply standard scaling procedure to standard mc histograms to convert from
@@ -610,6 +627,8 @@ public:
   TMatrixDSym* fCovar;    ///< New FullCovar
   TMatrixDSym* fInvert;   ///< New covar
 
+  StatUtils::Chi2Evaluator fCovChi2; ///< Cached masked inverse for GetLikelihood
+
   double fNormError;        ///< Sample norm error
 
   double fLikelihood; ///< Likelihood value
@@ -640,6 +659,14 @@ public:
   bool fIsChi2;       ///< Flag : using Chi2 over LL methods
   bool fIsSmeared;    ///< Flag : Apply smearing?
   bool fIsSingleBin;  ///< Flag : Is the data and MC single bin?
+  int fNBinFills;     ///< Fills by saved bin since the last FinaliseBinFills
+  int fNResetBinFills; ///< Fills by saved bin since the last ResetAll
+
+  // Histograms as filled, kept by SaveBinFills
+  std::vector<double> fSavedMC, fSavedMCErr2;
+  std::vector<double> fSavedFine, fSavedFineErr2;
+  std::vector<double> fSavedStat, fSavedStatErr2;
+  double fSavedEntries;
   bool fIsWriting;
   bool fSaveFine;
 
@@ -55,6 +55,9 @@ Measurement2D::Measurement2D(void) {
   // XSec Scalings
   fScaleFactor = -1.0;
   fCurrentNorm = 1.0;
+  fNBinFills = 0;
+  fNResetBinFills = 0;
+  fSavedEntries = 0.0;
 
   // Fake Data
   fFakeDataInput = "";
@@ -525,6 +528,7 @@ void Measurement2D::ScaleCovar(double scale) {
   (*fFullCovar) *= scale;
   (*covar) *= 1.0 / scale;
   (*fDecomp) *= sqrt(scale);
+  fCovChi2.Reset();
 }
 
 //********************************************************************
@@ -668,6 +672,9 @@ void Measurement2D::FinaliseMeasurement() {
 
 
   // ***** end NS covar modifications *****
+
+  // covar may have been replaced above, drop any cached chi2 matrix
+  fCovChi2.Reset();
  
   // Setup fMCHist from data
   fMCHist = (TH2D *)fDataHist->Clone();
@@ -919,6 +926,8 @@ void Measurement2D::ResetAll() {
   fMCHist->Reset();
   fMCFine->Reset();
   fMCStat->Reset();
+  fNBinFills = 0;
+  fNResetBinFills = 0;
 
   return;
 };
@@ -928,6 +937,17 @@ void Measurement2D::FillHistograms() {
   //********************************************************************
 
   if (Signal) {
+    // Signal reconfigures save the bins, skip the search if the variables
+    // are the values they were found for.
+    MeasurementVariableBox *box = GetBox();
+    if (box->fMCBin != -1 && fXVar == box->GetX() && fYVar == box->GetY()) {
+      PlotUtils::FillBin(fMCHist, box->fMCBin, Weight);
+      PlotUtils::FillBin(fMCFine, box->fFineBin, Weight);
+      PlotUtils::FillBin(fMCStat, box->fMCBin, 1.0);
+      fNBinFills++;
+      return;
+    }
+
     fMCHist->Fill(fXVar, fYVar, Weight);
     fMCFine->Fill(fXVar, fYVar, Weight);
     fMCStat->Fill(fXVar, fYVar, 1.0);
@@ -939,6 +959,64 @@ void Measurement2D::FillHistograms() {
   return;
 };
 
+//********************************************************************
+void Measurement2D::FindFillBins(int &mcbin, int &finebin) {
+  //********************************************************************
+
+  mcbin = -1;
+  finebin = -1;
+  if (fMCHist_Modes or fMCStat->GetNcells() != fMCHist->GetNcells())
+    return;
+
+  mcbin = fMCHist->FindBin(fXVar, fYVar);
+  finebin = fMCFine->FindBin(fXVar, fYVar);
+}
+
+//********************************************************************
+void Measurement2D::FinaliseBinFills() {
+  //********************************************************************
+
+  if (!fNBinFills)
+    return;
+
+  fMCHist->SetEntries(fMCHist->GetEntries() + fNBinFills);
+  fMCFine->SetEntries(fMCFine->GetEntries() + fNBinFills);
+  fMCStat->SetEntries(fMCStat->GetEntries() + fNBinFills);
+  fNResetBinFills += fNBinFills;
+  fNBinFills = 0;
+}
+
+//********************************************************************
+int Measurement2D::SaveBinFills(int nfills) {
+  //********************************************************************
+
+  if (fMCHist_Modes or nfills != fNResetBinFills or
+      fMCStat->GetNcells() != fMCHist->GetNcells())
+    return -1;
+
+  PlotUtils::GetBinContents(fMCHist, fSavedMC, fSavedMCErr2);
+  PlotUtils::GetBinContents(fMCFine, fSavedFine, fSavedFineErr2);
+  PlotUtils::GetBinContents(fMCStat, fSavedStat, fSavedStatErr2);
+  fSavedEntries = fMCHist->GetEntries();
+
+  return fMCHist->GetNcells();
+}
+
+//********************************************************************
+void Measurement2D::RestoreBinFills(double const *shift,
+                                    double const *shifterr2) {
+  //********************************************************************
+
+  PlotUtils::SetBinContents(fMCHist, fSavedMC, fSavedMCErr2, shift,
+                            shifterr2);
+  PlotUtils::SetBinContents(fMCFine, fSavedFine, fSavedFineErr2);
+  PlotUtils::SetBinContents(fMCStat, fSavedStat, fSavedStatErr2);
+
+  fMCHist->SetEntries(fSavedEntries);
+  fMCFine->SetEntries(fSavedEntries);
+  fMCStat->SetEntries(fSavedEntries);
+}
+
 //********************************************************************
 void Measurement2D::ScaleEvents() {
   //********************************************************************
@@ -1135,9 +1213,11 @@ double Measurement2D::GetLikelihood() {
       chi2 =
           StatUtils::GetChi2FromDiag(fDataHist, fMCHist, fMapHist, fMaskHist);
     } else {
-      chi2 = StatUtils::GetChi2FromCov(fDataHist, fMCHist, covar, fMapHist,
-                                       fMaskHist,
-                                       fIsWriting ? fResidualHist : NULL);
+      if (!fCovChi2.IsSetup(covar, fMaskHist, fMapHist)) {
+        fCovChi2.Setup(fDataHist, covar, fMapHist, fMaskHist);
+      }
+      chi2 = fCovChi2.Eval(fDataHist, fMCHist,
+                           fIsWriting ? fResidualHist : NULL);
       if (fChi2LessBinHist && fIsWriting) {
         NUIS_LOG(SAM, "Building n-1 chi2 contribution plot for " << GetName());
         for (int xi = 0; xi < fDataHist->GetNbinsX(); ++xi) {
@@ -1283,6 +1363,7 @@ void Measurement2D::SetFakeDataValues(std::string fakeOption) {
   if (covar)
     delete covar;
   covar = StatUtils::GetInvert(fFullCovar,true);
+  fCovChi2.Reset();
 
   if (fDecomp)
     delete fDecomp;
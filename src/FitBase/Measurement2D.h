@@ -355,6 +355,23 @@ public:
   /// function, even if they have been set to auto process.
   virtual void FillHistograms(void);
 
+  /// \brief Saved bins for the standard MC histograms
+  ///
+  /// Used by signal reconfigures so that FillHistograms can add straight into
+  /// the saved bins. Returns -1 for both if mode stacks are being filled.
+  virtual void FindFillBins(int& mcbin, int& finebin);
+
+  /// Add the entries from fills by saved bin to the MC histograms.
+  virtual void FinaliseBinFills(void);
+
+  /// Keep the MC, fine MC and stat histograms as filled, if every fill
+  /// since ResetAll went into saved bins.
+  virtual int SaveBinFills(int nfills);
+
+  /// Put back the histograms kept by SaveBinFills, shifting the MC bins.
+  virtual void RestoreBinFills(double const* shift = NULL,
+                               double const* shifterr2 = NULL);
+
   // \brief Convert event rates to final histogram
   ///
   /// Apply standard scaling procedure to standard mc histograms to convert from
@@ -613,10 +630,20 @@ public:
   bool fIsWriting;
 
   TrueModeStack *fMCHist_Modes; ///< Optional True Mode Stack
+  int fNBinFills; ///< Fills by saved bin since the last FinaliseBinFills
+  int fNResetBinFills; ///< Fills by saved bin since the last ResetAll
+
+  // Histograms as filled, kept by SaveBinFills
+  std::vector<double> fSavedMC, fSavedMCErr2;
+  std::vector<double> fSavedFine, fSavedFineErr2;
+  std::vector<double> fSavedStat, fSavedStatErr2;
+  double fSavedEntries;
 
   TMatrixDSym *fCovar;  ///< New FullCovar
   TMatrixDSym *fInvert; ///< New covar
 
+  StatUtils::Chi2Evaluator fCovChi2; ///< Cached masked inverse for GetLikelihood
+
   // Fake Data
   std::string fFakeDataInput; ///< Input fake data file path
   TFile *fFakeDataFile;       ///< Input fake data file
@@ -378,13 +378,17 @@ void MeasurementBase::Renormalise() {
   // reweight dials
   // Means we don't have to call the time consuming reconfigure when this
   // happens.
-  double norm = fRW->GetDialValue(this->fName + "_norm");
-
-  if ((this->fCurrentNorm == 0.0 and norm != 0.0) or not fMCFilled) {
+  if (!CanRenormalise()) {
     this->ReconfigureFast();
     return;
   }
 
+  double norm = fRW->GetSampleNorm(this->fName);
+  // Same guard as ConvertEventRates so both paths agree
+  if (norm < 0.01 or norm > 10.0) {
+    norm = 1.0;
+  }
+
   if (this->fCurrentNorm == norm)
     return;
 
@@ -394,6 +398,18 @@ void MeasurementBase::Renormalise() {
   return;
 };
 
+//***********************************************
+bool MeasurementBase::CanRenormalise() {
+  //***********************************************
+
+  double norm = fRW->GetSampleNorm(this->fName);
+  if (norm < 0.01 or norm > 10.0) {
+    norm = 1.0;
+  }
+
+  return fMCFilled and not(this->fCurrentNorm == 0.0 and norm != 0.0);
+}
+
 //***********************************************
 void MeasurementBase::SetSignal(bool sig) {
   //***********************************************
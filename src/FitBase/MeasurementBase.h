@@ -127,6 +127,10 @@ public:
   //! do is update the normalisation.
   virtual void Renormalise(void);
 
+  //! True if Renormalise can rescale the filled MC for the current
+  //! normalisation without falling back to a reconfigure.
+  bool CanRenormalise(void);
+
   //! Call reconfigure only looping over signal events to save time.
   virtual void ReconfigureFast(void);
 
@@ -199,6 +203,33 @@ public:
   ///! Convert event rates to whatever distributions you need.
   virtual void ConvertEventRates(void);
 
+  ///! Global MC and fine MC histogram bins for the current fXVar/fYVar, or -1
+  /// if this measurement cannot be filled by bin.
+  virtual void FindFillBins(int& mcbin, int& finebin) {
+    mcbin = -1;
+    finebin = -1;
+  };
+
+  ///! Bring histogram entries up to date after fills by saved bin.
+  virtual void FinaliseBinFills(void) {};
+
+  ///! Keep the MC as filled, before ConvertEventRates, so that it can be
+  /// restored with shifted bins. Returns the number of MC bins (global bins,
+  /// as in FindFillBins), or -1 if this measurement cannot, or not all of
+  /// the nfills fills since ResetAll went into saved bins.
+  virtual int SaveBinFills(int nfills) {
+    (void)nfills;
+    return -1;
+  };
+
+  ///! Put back the MC kept by SaveBinFills, moving MC bin i by shift[i] and
+  /// its squared error by shifterr2[i] where given.
+  virtual void RestoreBinFills(double const* shift = NULL,
+                               double const* shifterr2 = NULL) {
+    (void)shift;
+    (void)shifterr2;
+  };
+
   ///! Call scale events after the plots have been filled at the end of
   /// reconfigure.
   virtual void ScaleEvents(void) {};
@@ -255,6 +286,8 @@ public:
   void SetWeight(double wght);
   void SetMode(int md);
   void SetNoData(bool isTrue = true) { fNoData = isTrue; };
+  //! Mark the MC as filled by an outside event loop (the event manager)
+  inline void SetMCFilled(bool filled = true) { fMCFilled = filled; };
 
   inline void SetXVar(double xvar) { fXVar = xvar; };
   inline void SetYVar(double yvar) { fYVar = yvar; };
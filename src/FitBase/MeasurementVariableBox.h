@@ -5,7 +5,7 @@
 class MeasurementVariableBox {
 public:
   
-  MeasurementVariableBox() {};
+  MeasurementVariableBox() : fMCBin(-1), fFineBin(-1) {};
   ~MeasurementVariableBox() {};
 
   virtual void Reset();
@@ -26,6 +26,15 @@ public:
   inline virtual void SetSampleWeight(double w){fSampleWeight = w;};
   inline virtual double GetSampleWeight(){return fSampleWeight;};
   double fSampleWeight;
+
+  /// Global bins in the MC and fine MC histograms saved by a signal
+  /// reconfigure, so fast fills can skip the bin search. -1 when unset.
+  inline void SetFillBins(int mcbin, int finebin) {
+    fMCBin = mcbin;
+    fFineBin = finebin;
+  };
+  int fMCBin;
+  int fFineBin;
 };
 
 #endif
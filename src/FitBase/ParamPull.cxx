@@ -563,11 +563,16 @@ void ParamPull::Reconfigure() {
 
   FitWeight *rw = FitBase::GetRW();
 
-  // Get Dial Names that are valid
-  std::vector<std::string> namevec = rw->GetDialNames();
-  std::vector<double> valuevec = rw->GetDialValues();
+  // Use the dial names and values currently set in RW
+  Reconfigure(rw->GetDialNames(), rw->GetDialValues());
+};
+
+//*******************************************************************************
+void ParamPull::Reconfigure(std::vector<std::string> const &namevec,
+                            std::vector<double> const &valuevec) {
+  //*******************************************************************************
 
-  // Set Bin Values from RW
+  // Set Bin Values from the dial values
   for (UInt_t i = 0; i < namevec.size(); i++) {
 
     // Loop over bins and check name matches
@@ -99,6 +99,10 @@ class ParamPull {
   //! Reconfigure function reads in current RW engine dials and sets their value to MC
   void Reconfigure(void);
 
+  //! Set the MC from the given dial names and values instead of the RW engine
+  void Reconfigure(std::vector<std::string> const& namevec,
+                   std::vector<double> const& valuevec);
+
   //! Get likelihood given the current values
   double GetLikelihood(void);
 
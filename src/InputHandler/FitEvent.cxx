@@ -20,8 +20,13 @@
 #include "TObjArray.h"
 #include <iostream>
 
+bool FitEvent::fUseParticleSummary = true;
+
 FitEvent::FitEvent() {
   fGenInfo = NULL;
+  fSummaryValid = false;
+  fSummaryIndexed = false;
+  fSummaryNParticles = -1;
   kRemoveFSIParticles = true;
   kRemoveUndefParticles = true;
 
@@ -130,6 +135,7 @@ void FitEvent::ResetEvent() {
   fTargetH = -1;
   fBound = false;
   fNParticles = 0;
+  InvalidateParticleSummary();
 
   if (fGenInfo)
     fGenInfo->Reset();
@@ -209,6 +215,7 @@ void FitEvent::OrderStack() {
     NUIS_ABORT("Dropped some particles when ordering the stack!");
   }
 
+  InvalidateParticleSummary();
   return;
 }
 
@@ -350,7 +357,84 @@ FitParticle *FitEvent::GetParticle(int const i) {
   return fParticleList[i];
 }
 
+bool FitEvent::UpdateParticleSummary() const {
+  if (fSummaryValid && fSummaryNParticles == fNParticles) {
+    return fSummaryIndexed;
+  }
+
+  fSummary.clear();
+  for (UInt_t s = 0; s < kNSummaryStates; s++) {
+    fSummaryStateCount[s] = 0;
+    fSummaryStateHM[s] = -1;
+    fSummaryStateHMMom2[s] = -9999999.9;
+    fSummaryMesons[s] = 0;
+    fSummaryLeptons[s] = 0;
+    fSummaryNucleons[s] = 0;
+  }
+
+  fSummaryValid = true;
+  fSummaryIndexed = true;
+  fSummaryNParticles = fNParticles;
+
+  for (int i = 0; i < fNParticles; i++) {
+    UInt_t state = fParticleState[i];
+    if (state >= kNSummaryStates) {
+      fSummaryIndexed = false;
+      return false;
+    }
+
+    int pdg = fParticlePDG[i];
+    double mom2 = GetParticleMom2(i);
+
+    // Events hold few distinct species so a short search is enough
+    ParticleSummaryEntry *entry = NULL;
+    for (size_t j = 0; j < fSummary.size(); j++) {
+      if (fSummary[j].pdg == pdg && fSummary[j].state == state) {
+        entry = &fSummary[j];
+        break;
+      }
+    }
+    if (!entry) {
+      ParticleSummaryEntry newentry = {pdg, state, 0, -1, -9999999.9};
+      fSummary.push_back(newentry);
+      entry = &fSummary.back();
+    }
+
+    // Strict comparisons keep the first index on ties, as the stack scans do
+    entry->count++;
+    if (mom2 > entry->hmmom2) {
+      entry->hmindex = i;
+      entry->hmmom2 = mom2;
+    }
+
+    fSummaryStateCount[state]++;
+    if (mom2 > fSummaryStateHMMom2[state]) {
+      fSummaryStateHM[state] = i;
+      fSummaryStateHMMom2[state] = mom2;
+    }
+
+    int apdg = abs(pdg);
+    if (apdg >= 111 && apdg <= 557)
+      fSummaryMesons[state]++;
+    if (apdg == 11 || apdg == 13 || apdg == 15)
+      fSummaryLeptons[state]++;
+    if (apdg == 2112 || apdg == 2212)
+      fSummaryNucleons[state]++;
+  }
+
+  return true;
+}
+
 bool FitEvent::HasParticle(int const pdg, int const state) const {
+  if (fUseParticleSummary && UpdateParticleSummary()) {
+    for (size_t j = 0; j < fSummary.size(); j++) {
+      if (fSummary[j].pdg == pdg &&
+          (state == -1 || fSummary[j].state == (uint)state))
+        return true;
+    }
+    return false;
+  }
+
   bool found = false;
   for (int i = 0; i < fNParticles; i++) {
     if (state != -1 && fParticleState[i] != (uint)state)
@@ -362,6 +446,22 @@ bool FitEvent::HasParticle(int const pdg, int const state) const {
 }
 
 int FitEvent::NumParticle(int const pdg, int const state) const {
+  if (fUseParticleSummary && UpdateParticleSummary()) {
+    if (pdg == 0) {
+      if (state == -1)
+        return fNParticles;
+      return ((uint)state < kNSummaryStates) ? fSummaryStateCount[state] : 0;
+    }
+
+    int nfound = 0;
+    for (size_t j = 0; j < fSummary.size(); j++) {
+      if (fSummary[j].pdg == pdg &&
+          (state == -1 || fSummary[j].state == (uint)state))
+        nfound += fSummary[j].count;
+    }
+    return nfound;
+  }
+
   int nfound = 0;
   for (int i = 0; i < fNParticles; i++) {
     if (state != -1 and fParticleState[i] != (uint)state)
@@ -399,6 +499,35 @@ std::vector<FitParticle *> FitEvent::GetAllParticle(int const pdg,
 int FitEvent::GetHMParticleIndex(int const pdg, int const state) const {
   double maxmom2 = -9999999.9;
   int maxind = -1;
+
+  if (fUseParticleSummary && UpdateParticleSummary()) {
+    if (pdg == 0 && state != -1) {
+      return ((uint)state < kNSummaryStates) ? fSummaryStateHM[state] : -1;
+    }
+
+    // Combine candidates, on equal momentum the lower index came first
+    for (UInt_t s = 0; s < kNSummaryStates && pdg == 0; s++) {
+      if (fSummaryStateHM[s] == -1)
+        continue;
+      if (fSummaryStateHMMom2[s] > maxmom2 ||
+          (fSummaryStateHMMom2[s] == maxmom2 && fSummaryStateHM[s] < maxind)) {
+        maxind = fSummaryStateHM[s];
+        maxmom2 = fSummaryStateHMMom2[s];
+      }
+    }
+    for (size_t j = 0; j < fSummary.size() && pdg != 0; j++) {
+      ParticleSummaryEntry const &entry = fSummary[j];
+      if (entry.pdg != pdg || (state != -1 && entry.state != (uint)state))
+        continue;
+      if (entry.hmmom2 > maxmom2 ||
+          (entry.hmmom2 == maxmom2 && entry.hmindex < maxind)) {
+        maxind = entry.hmindex;
+        maxmom2 = entry.hmmom2;
+      }
+    }
+    return maxind;
+  }
+
   for (int i = 0; i < fNParticles; i++) {
     if (state != -1 and fParticleState[i] != (uint)state)
       continue;
@@ -478,6 +607,10 @@ int FitEvent::GetBeamPartIndex(void) const {
 }
 
 int FitEvent::NumFSMesons() {
+  if (fUseParticleSummary && UpdateParticleSummary()) {
+    return fSummaryMesons[kFinalState];
+  }
+
   int nMesons = 0;
 
   for (int i = 0; i < fNParticles; i++) {
@@ -491,6 +624,10 @@ int FitEvent::NumFSMesons() {
 }
 
 int FitEvent::NumFSLeptons(void) const {
+  if (fUseParticleSummary && UpdateParticleSummary()) {
+    return fSummaryLeptons[kFinalState];
+  }
+
   int nLeptons = 0;
 
   for (int i = 0; i < fNParticles; i++) {
@@ -504,6 +641,13 @@ int FitEvent::NumFSLeptons(void) const {
   return nLeptons;
 }
 
+int FitEvent::NumFSNucleons(void) const {
+  if (fUseParticleSummary && UpdateParticleSummary()) {
+    return fSummaryNucleons[kFinalState];
+  }
+  return NumFSParticle(PhysConst::pdg_nucleons);
+}
+
 // Get the outgoing lepton PDG depending on if it's a CC or NC event
 int FitEvent::GetLeptonOutPDG() {
   // Make sure the outgoing lepton has the correct PDG
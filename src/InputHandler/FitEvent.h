@@ -27,6 +27,7 @@
 #include <iterator>
 #include <vector>
 #include "FitParticle.h"
+#include "FitParticleView.h"
 #include "TLorentzVector.h"
 #include "TSpline.h"
 
@@ -115,6 +116,7 @@ public:
     fParticleMom[index][2] = np3[2];
     fParticleMom[index][3] = nE;
 
+    InvalidateParticleSummary();
   }
 
   /// Allows the removal of KE up to total KE.
@@ -548,7 +550,7 @@ public:
   int NumFSLeptons      (void) const; // { return NumFSParticle(PhysConst::pdg_leptons);       };
   inline int NumFSPions        (void) const { return NumFSParticle(PhysConst::pdg_pions);         };
   inline int NumFSChargePions  (void) const { return NumFSParticle(PhysConst::pdg_charged_pions); };
-  inline int NumFSNucleons  (void) const { return NumFSParticle(PhysConst::pdg_nucleons); };
+  int NumFSNucleons  (void) const; // { return NumFSParticle(PhysConst::pdg_nucleons); };
 
   inline std::vector<int> GetAllFSNuElectronIndices (void) const { return GetAllFSParticleIndices(12);   };
   inline std::vector<int> GetAllFSNuMuonIndices     (void) const { return GetAllFSParticleIndices(14);   };
@@ -675,6 +677,67 @@ public:
   inline UInt_t Npart (void) const { return NPart(); };
   inline UInt_t NPart (void) const { return fNParticles; };
 
+  // ---- Allocation free particle access
+  // Views and ranges read the stack arrays directly and never create
+  // FitParticle objects. They are invalidated when the event is next filled.
+  inline FitParticleView GetParticleView(int const index) const {
+    if (index < 0 || index >= fNParticles) return FitParticleView();
+    return FitParticleView(fParticleMom[index], fParticlePDG[index],
+                           fParticleState[index], index);
+  };
+
+  inline FitParticleRange GetParticles(int const pdg = 0,
+                                       int const state = -1) const {
+    return FitParticleRange(fParticleMom, fParticlePDG, fParticleState,
+                            fNParticles, pdg, state);
+  };
+  template <size_t N>
+  inline FitParticleRange GetParticles(int const (&pdgs)[N],
+                                       int const state = -1) const {
+    return FitParticleRange(fParticleMom, fParticlePDG, fParticleState,
+                            fNParticles, pdgs, N, state);
+  };
+
+  inline FitParticleRange GetFSParticles(int const pdg = 0) const {
+    return GetParticles(pdg, kFinalState);
+  };
+  template <size_t N>
+  inline FitParticleRange GetFSParticles(int const (&pdgs)[N]) const {
+    return GetParticles(pdgs, kFinalState);
+  };
+
+  inline FitParticleView GetHMParticleView(int const pdg = 0,
+                                           int const state = -1) const {
+    return GetParticleView(GetHMParticleIndex(pdg, state));
+  };
+  template <size_t N>
+  inline FitParticleView GetHMParticleView(int const (&pdgs)[N],
+                                           int const state = -1) const {
+    return GetParticleView(GetHMParticleIndex(pdgs, state));
+  };
+
+  inline FitParticleView GetHMFSParticleView(int const pdg) const {
+    return GetParticleView(GetHMFSParticleIndex(pdg));
+  };
+  template <size_t N>
+  inline FitParticleView GetHMFSParticleView(int const (&pdgs)[N]) const {
+    return GetParticleView(GetHMFSParticleIndex(pdgs));
+  };
+
+  inline FitParticleView GetNeutrinoInView(void) const {
+    return GetParticleView(GetBeamNeutrinoIndex());
+  };
+
+  // ---- Particle stack summary
+  /// Mark the particle summary stale. Called by ResetEvent and OrderStack,
+  /// anything else that edits the stack arrays in place must call it.
+  inline void InvalidateParticleSummary() { fSummaryValid = false; };
+
+  /// Switch the pdg/state queries between the summary and a full stack scan.
+  /// Both give identical results, the scan is kept for validation.
+  static void SetUseParticleSummary(bool use) { fUseParticleSummary = use; };
+  static bool GetUseParticleSummary() { return fUseParticleSummary; };
+
   // Other Functions
   int NumFSMesons();
 
@@ -720,6 +783,38 @@ public:
   bool kRemoveFSIParticles;
   bool kRemoveUndefParticles;
 
+  /// Per (pdg, state) entry of the particle summary
+  struct ParticleSummaryEntry {
+    int pdg;
+    UInt_t state;
+    int count;
+    int hmindex;    ///< First index with the highest |p|^2
+    double hmmom2;
+  };
+
+  /// Number of particle_state values tracked by the summary
+  static const UInt_t kNSummaryStates = 6;
+
+  /// Build the summary if the stack changed since the last query. Returns
+  /// false if the stack holds states outside particle_state, in which case
+  /// queries fall back to scanning the stack.
+  bool UpdateParticleSummary() const;
+
+  // Summary of the particle stack, one entry per distinct (pdg, state) plus
+  // per state totals, built lazily by the first query after each fill.
+  mutable std::vector<ParticleSummaryEntry> fSummary;
+  mutable int fSummaryStateCount[kNSummaryStates];
+  mutable int fSummaryStateHM[kNSummaryStates];
+  mutable double fSummaryStateHMMom2[kNSummaryStates];
+  mutable int fSummaryMesons[kNSummaryStates];
+  mutable int fSummaryLeptons[kNSummaryStates];
+  mutable int fSummaryNucleons[kNSummaryStates];
+  mutable int fSummaryNParticles;
+  mutable bool fSummaryValid;
+  mutable bool fSummaryIndexed;
+
+  static bool fUseParticleSummary;
+
 
 
 };
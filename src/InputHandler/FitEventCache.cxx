@@ -0,0 +1,341 @@
+// Copyright 2016-2021 L. Pickering, P Stowell, R. Terri, C. Wilkinson, C. Wret
+
+/*******************************************************************************
+ *    This file is part of NUISANCE.
+ *
+ *    NUISANCE is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    NUISANCE is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with NUISANCE.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#include "FitEventCache.h"
+#include "NuisConfig.h"
+
+#include "TChain.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+const char kCacheMagic[8] = {'N', 'U', 'I', 'S', 'E', 'V', 'C', '\0'};
+const UInt_t kCacheVersion = 1;
+const ULong64_t kCacheAlign = 64;
+
+inline ULong64_t AlignUp(ULong64_t offset) {
+  return (offset + kCacheAlign - 1) & ~(kCacheAlign - 1);
+}
+
+// Bytes per entry of each FitEventCacheColumn
+const size_t kCacheElementSize[kNCacheColumns] = {
+    sizeof(int),       sizeof(UInt_t),   sizeof(double), sizeof(int),
+    sizeof(int),       sizeof(char),     sizeof(double), sizeof(double),
+    sizeof(ULong64_t), sizeof(UInt_t),   sizeof(int),    4 * sizeof(double)};
+} // namespace
+
+FitEventCache::FitEventCache() {
+  fMapping = NULL;
+  fMappedSize = 0;
+  fHeader = NULL;
+  memset(&fView, 0, sizeof(fView));
+}
+
+FitEventCache::~FitEventCache() { Close(); }
+
+std::string FitEventCache::GetCachePath(std::string const &source) {
+  std::string cachedir = FitPar::Config().GetParS("FitEventCacheDir");
+  if (cachedir.empty()) {
+    return source + ".nuiscache";
+  }
+
+  std::string filename = source;
+  size_t slash = filename.find_last_of('/');
+  if (slash != std::string::npos) {
+    filename = filename.substr(slash + 1);
+  }
+  return cachedir + "/" + filename + ".nuiscache";
+}
+
+void FitEventCache::Build(std::string const &source, std::string const &path) {
+  NUIS_LOG(SAM, "Building FitEvent cache " << path << " from " << source);
+
+  TChain *tn = new TChain("nuisance_events");
+  tn->Add(source.c_str());
+  ULong64_t nevents = tn->GetEntries();
+
+  // First pass only reads the particle counts to size the columns
+  int npart = 0;
+  int maxpart = 0;
+  ULong64_t nparticles = 0;
+  tn->SetBranchStatus("*", 0);
+  tn->SetBranchStatus("NParticles", 1);
+  tn->SetBranchAddress("NParticles", &npart);
+  for (ULong64_t i = 0; i < nevents; i++) {
+    tn->GetEntry(i);
+    nparticles += npart;
+    maxpart = std::max(maxpart, npart);
+  }
+  tn->SetBranchStatus("*", 1);
+
+  // Lay the columns out back to back after the header
+  FitEventCacheHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, kCacheMagic, sizeof(kCacheMagic));
+  header.version = kCacheVersion;
+  header.headersize = sizeof(FitEventCacheHeader);
+  header.nevents = nevents;
+  header.nparticles = nparticles;
+
+  ULong64_t offset = AlignUp(sizeof(FitEventCacheHeader));
+  for (int c = 0; c < kNCacheColumns; c++) {
+    ULong64_t nentries = nevents;
+    if (c == kCachePartOffset)
+      nentries = nevents + 1;
+    else if (c > kCachePartOffset)
+      nentries = nparticles;
+
+    header.columns[c] = offset;
+    offset = AlignUp(offset + nentries * kCacheElementSize[c]);
+  }
+  header.filesize = offset;
+
+  struct stat sourcestat;
+  if (stat(source.c_str(), &sourcestat) == 0) {
+    header.sourcesize = sourcestat.st_size;
+    header.sourcemtime = sourcestat.st_mtime;
+  }
+
+  // Write through a writable mapping of a temporary file, renamed into place
+  // once complete so a partial cache is never picked up.
+  std::string tmppath = path + Form(".tmp%i", int(getpid()));
+  int fd = open(tmppath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    NUIS_ABORT("Could not create FitEvent cache file " << tmppath);
+  }
+  if (ftruncate(fd, header.filesize) != 0) {
+    close(fd);
+    NUIS_ABORT("Could not allocate " << header.filesize
+                                     << " bytes for FitEvent cache "
+                                     << tmppath);
+  }
+  void *mapping = mmap(NULL, header.filesize, PROT_READ | PROT_WRITE,
+                       MAP_SHARED, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    NUIS_ABORT("Could not map FitEvent cache file " << tmppath);
+  }
+
+  char *base = static_cast<char *>(mapping);
+  memcpy(base, &header, sizeof(header));
+
+  int *mode = reinterpret_cast<int *>(base + header.columns[kCacheMode]);
+  UInt_t *eventno =
+      reinterpret_cast<UInt_t *>(base + header.columns[kCacheEventNo]);
+  double *totcrs =
+      reinterpret_cast<double *>(base + header.columns[kCacheTotCrs]);
+  int *targeta = reinterpret_cast<int *>(base + header.columns[kCacheTargetA]);
+  int *targeth = reinterpret_cast<int *>(base + header.columns[kCacheTargetH]);
+  unsigned char *bound =
+      reinterpret_cast<unsigned char *>(base + header.columns[kCacheBound]);
+  double *rwweight =
+      reinterpret_cast<double *>(base + header.columns[kCacheRWWeight]);
+  double *inputweight =
+      reinterpret_cast<double *>(base + header.columns[kCacheInputWeight]);
+  ULong64_t *partoffset =
+      reinterpret_cast<ULong64_t *>(base + header.columns[kCachePartOffset]);
+  UInt_t *partstate =
+      reinterpret_cast<UInt_t *>(base + header.columns[kCachePartState]);
+  int *partpdg = reinterpret_cast<int *>(base + header.columns[kCachePartPDG]);
+  double *partmom =
+      reinterpret_cast<double *>(base + header.columns[kCachePartMom]);
+
+  // Second pass reads everything, using the same branches as FitEvent
+  int readmode = 0;
+  UInt_t readeventno = 0;
+  double readtotcrs = 0.0;
+  int readtargeta = 0;
+  int readtargeth = 0;
+  bool readbound = false;
+  double readrwweight = 1.0;
+  double readinputweight = 1.0;
+  std::vector<UInt_t> readstate(maxpart + 1);
+  std::vector<int> readpdg(maxpart + 1);
+  std::vector<double> readmom(4 * (maxpart + 1));
+
+  tn->SetBranchAddress("Mode", &readmode);
+  tn->SetBranchAddress("EventNo", &readeventno);
+  tn->SetBranchAddress("TotCrs", &readtotcrs);
+  tn->SetBranchAddress("TargetA", &readtargeta);
+  tn->SetBranchAddress("TargetH", &readtargeth);
+  tn->SetBranchAddress("Bound", &readbound);
+  tn->SetBranchAddress("RWWeight", &readrwweight);
+  tn->SetBranchAddress("InputWeight", &readinputweight);
+  tn->SetBranchAddress("NParticles", &npart);
+  tn->SetBranchAddress("ParticleState", &readstate[0]);
+  tn->SetBranchAddress("ParticlePDG", &readpdg[0]);
+  tn->SetBranchAddress("ParticleMom", &readmom[0]);
+
+  ULong64_t curpart = 0;
+  for (ULong64_t i = 0; i < nevents; i++) {
+    tn->GetEntry(i);
+
+    mode[i] = readmode;
+    eventno[i] = readeventno;
+    totcrs[i] = readtotcrs;
+    targeta[i] = readtargeta;
+    targeth[i] = readtargeth;
+    bound[i] = readbound;
+    rwweight[i] = readrwweight;
+    inputweight[i] = readinputweight;
+
+    partoffset[i] = curpart;
+    memcpy(&partstate[curpart], &readstate[0], npart * sizeof(UInt_t));
+    memcpy(&partpdg[curpart], &readpdg[0], npart * sizeof(int));
+    memcpy(&partmom[4 * curpart], &readmom[0], 4 * npart * sizeof(double));
+    curpart += npart;
+  }
+  partoffset[nevents] = curpart;
+
+  delete tn;
+
+  msync(mapping, header.filesize, MS_SYNC);
+  munmap(mapping, header.filesize);
+
+  if (rename(tmppath.c_str(), path.c_str()) != 0) {
+    unlink(tmppath.c_str());
+    NUIS_ABORT("Could not move FitEvent cache into place at " << path);
+  }
+
+  NUIS_LOG(SAM, "Wrote FitEvent cache with " << nevents << " events and "
+                                             << nparticles << " particles ("
+                                             << header.filesize / 1.E6
+                                             << " MB)");
+}
+
+bool FitEventCache::Open(std::string const &path, std::string const &source) {
+  Close();
+
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+
+  struct stat cachestat;
+  if (fstat(fd, &cachestat) != 0 ||
+      size_t(cachestat.st_size) < sizeof(FitEventCacheHeader)) {
+    close(fd);
+    return false;
+  }
+
+  void *mapping =
+      mmap(NULL, cachestat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    return false;
+  }
+
+  const FitEventCacheHeader *header =
+      static_cast<const FitEventCacheHeader *>(mapping);
+  bool valid = !memcmp(header->magic, kCacheMagic, sizeof(kCacheMagic)) &&
+               header->version == kCacheVersion &&
+               header->headersize == sizeof(FitEventCacheHeader) &&
+               header->filesize == ULong64_t(cachestat.st_size);
+
+  // Rebuild if the source file has changed since the cache was made
+  if (valid && !source.empty()) {
+    struct stat sourcestat;
+    valid = (stat(source.c_str(), &sourcestat) == 0) &&
+            (header->sourcesize == ULong64_t(sourcestat.st_size)) &&
+            (header->sourcemtime == Long64_t(sourcestat.st_mtime));
+  }
+
+  if (!valid) {
+    NUIS_LOG(SAM, "FitEvent cache " << path << " is out of date.");
+    munmap(mapping, cachestat.st_size);
+    return false;
+  }
+
+  fPath = path;
+  fMapping = mapping;
+  fMappedSize = cachestat.st_size;
+  fHeader = header;
+
+  const char *base = static_cast<const char *>(mapping);
+  fView.Mode = reinterpret_cast<const int *>(base + header->columns[kCacheMode]);
+  fView.EventNo =
+      reinterpret_cast<const UInt_t *>(base + header->columns[kCacheEventNo]);
+  fView.TotCrs =
+      reinterpret_cast<const double *>(base + header->columns[kCacheTotCrs]);
+  fView.TargetA =
+      reinterpret_cast<const int *>(base + header->columns[kCacheTargetA]);
+  fView.TargetH =
+      reinterpret_cast<const int *>(base + header->columns[kCacheTargetH]);
+  fView.Bound = reinterpret_cast<const unsigned char *>(
+      base + header->columns[kCacheBound]);
+  fView.RWWeight =
+      reinterpret_cast<const double *>(base + header->columns[kCacheRWWeight]);
+  fView.InputWeight = reinterpret_cast<const double *>(
+      base + header->columns[kCacheInputWeight]);
+  fView.PartOffset = reinterpret_cast<const ULong64_t *>(
+      base + header->columns[kCachePartOffset]);
+  fView.PartState =
+      reinterpret_cast<const UInt_t *>(base + header->columns[kCachePartState]);
+  fView.PartPDG =
+      reinterpret_cast<const int *>(base + header->columns[kCachePartPDG]);
+  fView.PartMom = reinterpret_cast<const double(*)[4]>(
+      base + header->columns[kCachePartMom]);
+
+  return true;
+}
+
+void FitEventCache::Close() {
+  if (fMapping) {
+    munmap(fMapping, fMappedSize);
+  }
+  fMapping = NULL;
+  fMappedSize = 0;
+  fHeader = NULL;
+  memset(&fView, 0, sizeof(fView));
+}
+
+void FitEventCache::FillEvent(ULong64_t entry, FitEvent *evt) const {
+  evt->ResetEvent();
+
+  evt->Mode = fView.Mode[entry];
+  evt->fEventNo = fView.EventNo[entry];
+  evt->fTotCrs = fView.TotCrs[entry];
+  evt->fTargetA = fView.TargetA[entry];
+  evt->fTargetH = fView.TargetH[entry];
+  evt->fBound = fView.Bound[entry];
+  evt->SavedRWWeight = fView.RWWeight[entry];
+  evt->InputWeight = fView.InputWeight[entry];
+
+  ULong64_t first = fView.PartOffset[entry];
+  UInt_t npart = GetNParticles(entry);
+  if (npart > evt->kMaxParticles) {
+    evt->ExpandParticleStack(npart);
+  }
+
+  memcpy(evt->fParticleState, &fView.PartState[first], npart * sizeof(UInt_t));
+  memcpy(evt->fParticlePDG, &fView.PartPDG[first], npart * sizeof(int));
+  for (UInt_t i = 0; i < npart; i++) {
+    const double *mom = fView.PartMom[first + i];
+    evt->fParticleMom[i][0] = mom[0];
+    evt->fParticleMom[i][1] = mom[1];
+    evt->fParticleMom[i][2] = mom[2];
+    evt->fParticleMom[i][3] = mom[3];
+  }
+  evt->fNParticles = npart;
+}
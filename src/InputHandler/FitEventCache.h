@@ -0,0 +1,125 @@
+// Copyright 2016-2021 L. Pickering, P Stowell, R. Terri, C. Wilkinson, C. Wret
+
+/*******************************************************************************
+*    This file is part of NUISANCE.
+*
+*    NUISANCE is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    NUISANCE is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with NUISANCE.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#ifndef FITEVENTCACHE_H
+#define FITEVENTCACHE_H
+/*!
+ *  \addtogroup InputHandler
+ *  @{
+ */
+#include "FitEvent.h"
+
+#include <string>
+
+/// Columns stored in a FitEvent cache file. Event columns hold one entry
+/// per event, particle columns one entry per particle with kPartOffset
+/// giving the first particle of each event (nevents + 1 entries).
+enum FitEventCacheColumn {
+  kCacheMode = 0,
+  kCacheEventNo,
+  kCacheTotCrs,
+  kCacheTargetA,
+  kCacheTargetH,
+  kCacheBound,
+  kCacheRWWeight,
+  kCacheInputWeight,
+  kCachePartOffset,
+  kCachePartState,
+  kCachePartPDG,
+  kCachePartMom,
+  kNCacheColumns
+};
+
+/// Fixed size header at the start of a cache file
+struct FitEventCacheHeader {
+  char magic[8];
+  UInt_t version;
+  UInt_t headersize;
+  ULong64_t nevents;
+  ULong64_t nparticles;
+  ULong64_t filesize;
+  ULong64_t sourcesize;  ///< Size of the nuisance_events file it was built from
+  Long64_t sourcemtime;  ///< Modification time of that file
+  ULong64_t columns[kNCacheColumns]; ///< Byte offset of each column
+};
+
+/// Read-only pointers to every column of a mapped cache file
+struct FitEventCacheView {
+  const int *Mode;
+  const UInt_t *EventNo;
+  const double *TotCrs;
+  const int *TargetA;
+  const int *TargetH;
+  const unsigned char *Bound;
+  const double *RWWeight;
+  const double *InputWeight;
+  const ULong64_t *PartOffset;
+  const UInt_t *PartState;
+  const int *PartPDG;
+  const double (*PartMom)[4];
+};
+
+/// Memory mapped, column-oriented copy of a nuisance_events tree.
+///
+/// The cache is a plain binary file with one contiguous, 64 byte aligned
+/// array per branch and the particle arrays flattened into offset-indexed
+/// columns. Reading an event is then a handful of array lookups into the
+/// mapping rather than a TTree::GetEntry.
+class FitEventCache {
+public:
+  FitEventCache();
+  ~FitEventCache();
+
+  /// Default cache location for a FitEvent file, placed in the
+  /// FitEventCacheDir config folder if set, next to the input otherwise.
+  static std::string GetCachePath(std::string const &source);
+
+  /// Convert the nuisance_events tree in source into a cache at path.
+  static void Build(std::string const &source, std::string const &path);
+
+  /// Map an existing cache file. Returns false if it is missing, corrupt or
+  /// was built from a different version of source.
+  bool Open(std::string const &path, std::string const &source = "");
+
+  /// Unmap the cache
+  void Close();
+
+  /// Number of events in the cache
+  inline ULong64_t GetNEvents() const { return fHeader ? fHeader->nevents : 0; };
+
+  /// Direct column access into the mapping
+  inline const FitEventCacheView &GetView() const { return fView; };
+
+  /// Number of particles stored for an event
+  inline UInt_t GetNParticles(ULong64_t entry) const {
+    return fView.PartOffset[entry + 1] - fView.PartOffset[entry];
+  };
+
+  /// Fill a FitEvent from the columns, the equivalent of reading the entry
+  /// through FitEvent::SetBranchAddress and FitEventInputHandler.
+  void FillEvent(ULong64_t entry, FitEvent *evt) const;
+
+private:
+  std::string fPath;
+  void *fMapping;
+  size_t fMappedSize;
+  const FitEventCacheHeader *fHeader;
+  FitEventCacheView fView;
+};
+/*! @} */
+#endif
@@ -0,0 +1,106 @@
+// Copyright 2016-2021 L. Pickering, P Stowell, R. Terri, C. Wilkinson, C. Wret
+
+/*******************************************************************************
+ *    This file is part of NUISANCE.
+ *
+ *    NUISANCE is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    NUISANCE is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with NUISANCE.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#include "FitEventCacheInputHandler.h"
+#include "InputUtils.h"
+
+FitEventCacheInputHandler::FitEventCacheInputHandler(
+    std::string const &handle, std::string const &rawinputs) {
+  NUIS_LOG(SAM, "Creating FitEventCacheInputHandler : " << handle);
+
+  // Run a joint input handling
+  fName = handle;
+
+  std::vector<std::string> inputs = InputUtils::ParseInputFileList(rawinputs);
+  for (size_t inp_it = 0; inp_it < inputs.size(); ++inp_it) {
+    // Open File for histogram access
+    TFile *inp_file = new TFile(inputs[inp_it].c_str(), "READ");
+    if (!inp_file or inp_file->IsZombie()) {
+      NUIS_ABORT("FitEvent File IsZombie() at " << inputs[inp_it]);
+    }
+
+    // Get Flux/Event hist
+    TH1D *fluxhist = (TH1D *)inp_file->Get("nuisance_fluxhist");
+    TH1D *eventhist = (TH1D *)inp_file->Get("nuisance_eventhist");
+    if (!fluxhist or !eventhist) {
+      NUIS_ABORT("FitEvent FILE doesn't contain flux/xsec info");
+    }
+
+    // Map the cache, building it if it is missing or stale
+    std::string cachepath = FitEventCache::GetCachePath(inputs[inp_it]);
+    FitEventCache *cache = new FitEventCache();
+    if (!cache->Open(cachepath, inputs[inp_it])) {
+      FitEventCache::Build(inputs[inp_it], cachepath);
+      if (!cache->Open(cachepath, inputs[inp_it])) {
+        NUIS_ABORT("Failed to open FitEvent cache " << cachepath);
+      }
+    }
+    NUIS_LOG(SAM, "Using FitEvent cache " << cachepath << " with "
+                                          << cache->GetNEvents() << " events");
+
+    // Register input to form flux/event rate hists
+    fCacheStart.push_back(fNEvents);
+    fCaches.push_back(cache);
+    RegisterJointInput(inputs[inp_it], cache->GetNEvents(), fluxhist,
+                       eventhist);
+  }
+
+  // Registor all our file inputs
+  SetupJointInputs();
+
+  // Assign to tree
+  fEventType = kINPUTFITEVENT;
+
+  // Create Fit Event
+  fNUISANCEEvent = new FitEvent();
+  fNUISANCEEvent->HardReset();
+}
+
+FitEventCacheInputHandler::~FitEventCacheInputHandler() {
+  for (size_t i = 0; i < fCaches.size(); i++) {
+    delete fCaches[i];
+  }
+  fCaches.clear();
+}
+
+FitEvent *FitEventCacheInputHandler::GetNuisanceEvent(const UInt_t entry,
+                                                      const bool lightweight) {
+  // Return NULL if out of bounds
+  if (entry >= (UInt_t)fNEvents)
+    return NULL;
+
+  // Find the cache holding this entry
+  size_t cache_it = fCaches.size() - 1;
+  while (cache_it > 0 && entry < fCacheStart[cache_it]) {
+    cache_it--;
+  }
+
+  fCaches[cache_it]->FillEvent(entry - fCacheStart[cache_it], fNUISANCEEvent);
+
+  // Setup Input scaling for joint inputs
+  fNUISANCEEvent->InputWeight = GetInputWeight(entry);
+
+  return fNUISANCEEvent;
+}
+
+double FitEventCacheInputHandler::GetInputWeight(int entry) {
+  double w = InputHandlerBase::GetInputWeight(entry);
+  return w * fNUISANCEEvent->SavedRWWeight;
+}
+
+void FitEventCacheInputHandler::Print() {}
@@ -0,0 +1,54 @@
+// Copyright 2016-2021 L. Pickering, P Stowell, R. Terri, C. Wilkinson, C. Wret
+
+/*******************************************************************************
+*    This file is part of NUISANCE.
+*
+*    NUISANCE is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    NUISANCE is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with NUISANCE.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#ifndef FITEVENTCACHE_INPUTHANDLER_H
+#define FITEVENTCACHE_INPUTHANDLER_H
+/*!
+ *  \addtogroup InputHandler
+ *  @{
+ */
+#include "InputHandler.h"
+#include "FitEvent.h"
+#include "FitEventCache.h"
+
+/// Class to read NUISANCE FitEvent files through a memory mapped column
+/// cache. Inputs are given as the usual FitEvent ROOT files
+/// (FEVENTCACHE:file.root); the cache for each one is built on first use
+/// and rebuilt whenever the ROOT file changes.
+class FitEventCacheInputHandler : public InputHandlerBase {
+public:
+
+	/// Standard constructor given name and inputs
+	FitEventCacheInputHandler(std::string const& handle, std::string const& rawinputs);
+	virtual ~FitEventCacheInputHandler();
+
+	/// Returns NUISANCE FitEvent filled from the cache. If lightweight does nothing.
+	FitEvent* GetNuisanceEvent(const UInt_t entry, const bool lightweight=false);
+
+	/// Alongside InputWeight also returns any saved RWWeights
+	double GetInputWeight(int entry);
+
+	/// Print out event information
+	void Print();
+
+	std::vector<FitEventCache*> fCaches; ///< One mapped cache per input file
+	std::vector<UInt_t> fCacheStart;     ///< First entry of each cache
+
+};
+/*! @} */
+#endif
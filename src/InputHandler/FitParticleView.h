@@ -0,0 +1,198 @@
+// Copyright 2016-2021 L. Pickering, P Stowell, R. Terri, C. Wilkinson, C. Wret
+
+/*******************************************************************************
+*    This file is part of NUISANCE.
+*
+*    NUISANCE is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    NUISANCE is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with NUISANCE.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#ifndef FITPARTICLEVIEW_H_SEEN
+#define FITPARTICLEVIEW_H_SEEN
+/*!
+ *  \addtogroup InputHandler
+ *  @{
+ */
+
+#include "FitParticle.h"
+
+#include "TLorentzVector.h"
+#include "TVector3.h"
+
+#include <cmath>
+#include <cstddef>
+
+/// Non-owning view of a single particle in a FitEvent stack.
+///
+/// Reads straight from the event's fParticleMom/fParticlePDG/fParticleState
+/// arrays, so it costs nothing to create but is only valid until the event
+/// is next filled. An invalid view (index -1) stands in for a NULL
+/// FitParticle* and reports zero momentum.
+class FitParticleView {
+ public:
+  FitParticleView() : fMom(NULL), fPDG(0), fState(kUndefinedState), fIndex(-1){};
+  FitParticleView(double const *mom, int pdg, UInt_t state, int index)
+      : fMom(mom), fPDG(pdg), fState(state), fIndex(index){};
+
+  /// Whether this points at a particle
+  inline bool IsValid(void) const { return fMom; };
+
+  /// Position in the event's particle stack
+  inline int Index(void) const { return fIndex; };
+
+  /// Get Particle PDG
+  inline int PDG(void) const { return fPDG; };
+
+  /// Return Status Code according to particle_state enum
+  inline int Status(void) const { return fState; };
+
+  inline bool IsFinalState(void) const { return (fState == kFinalState); };
+  inline bool IsFSIState(void) const { return (fState == kFSIState); };
+  inline bool IsInitialState(void) const { return (fState == kInitialState); };
+
+  inline double Px(void) const { return fMom ? fMom[0] : 0.0; };
+  inline double Py(void) const { return fMom ? fMom[1] : 0.0; };
+  inline double Pz(void) const { return fMom ? fMom[2] : 0.0; };
+
+  /// Get Total Energy
+  inline double E(void) const { return fMom ? fMom[3] : 0.0; };
+
+  /// Get 3 momentum magnitude squared
+  inline double p2(void) const { return Px() * Px() + Py() * Py() + Pz() * Pz(); };
+
+  /// Get 3 momentum magnitude
+  inline double p(void) const { return std::sqrt(p2()); };
+
+  /// Get Mass, signed like TLorentzVector::Mag for space-like momenta
+  inline double M(void) const {
+    double m2 = E() * E() - p2();
+    return (m2 < 0.0) ? -std::sqrt(-m2) : std::sqrt(m2);
+  };
+
+  /// Get Kinetic Energy
+  inline double KE(void) const { return E() - M(); };
+
+  /// Cosine of the opening angle to another particle, equivalent to
+  /// cos(P3().Angle(other.P3())) without the acos/cos round trip
+  inline double CosTheta(FitParticleView const &other) const {
+    double norm = std::sqrt(p2() * other.p2());
+    if (norm == 0.0) return 1.0;
+    double cost =
+        (Px() * other.Px() + Py() * other.Py() + Pz() * other.Pz()) / norm;
+    return (cost > 1.0) ? 1.0 : ((cost < -1.0) ? -1.0 : cost);
+  };
+
+  /// Get 3 Momentum
+  inline TVector3 P3(void) const { return TVector3(Px(), Py(), Pz()); };
+
+  /// Get 4 Momentum
+  inline TLorentzVector P4(void) const {
+    return TLorentzVector(Px(), Py(), Pz(), E());
+  };
+
+  /// Copy into an owning FitParticle, for code still using the old API
+  inline FitParticle ToFitParticle(void) const {
+    return FitParticle(Px(), Py(), Pz(), E(), fPDG, fState);
+  };
+
+ private:
+  double const *fMom;
+  int fPDG;
+  UInt_t fState;
+  int fIndex;
+};
+
+/// Range over the particles of an event matching a state and set of PDG
+/// codes, iterated without building a list. A pdg of 0 matches everything,
+/// a state of -1 matches every state. A PDG set is not copied and must
+/// outlive the range (the PhysConst lists always do).
+class FitParticleRange {
+ public:
+  class iterator {
+   public:
+    iterator(FitParticleRange const *range, int index)
+        : fRange(range), fIndex(index) {
+      Skip();
+    };
+
+    inline FitParticleView operator*() const { return fRange->View(fIndex); };
+    inline iterator &operator++() {
+      fIndex++;
+      Skip();
+      return *this;
+    };
+    inline bool operator==(iterator const &other) const {
+      return fIndex == other.fIndex;
+    };
+    inline bool operator!=(iterator const &other) const {
+      return fIndex != other.fIndex;
+    };
+
+   private:
+    inline void Skip() {
+      while (fIndex < fRange->fN && !fRange->Matches(fIndex)) fIndex++;
+    };
+
+    FitParticleRange const *fRange;
+    int fIndex;
+  };
+
+  /// Select a single pdg
+  FitParticleRange(double *const *mom, int const *pdg, UInt_t const *state,
+                   int n, int selpdg, int selstate)
+      : fMom(mom), fPDG(pdg), fState(state), fN(n), fSelPDG(selpdg),
+        fSelPDGs(NULL), fNSelPDGs(0), fSelState(selstate){};
+
+  /// Select any of npdgs codes
+  FitParticleRange(double *const *mom, int const *pdg, UInt_t const *state,
+                   int n, int const *pdgs, size_t npdgs, int selstate)
+      : fMom(mom), fPDG(pdg), fState(state), fN(n), fSelPDG(0),
+        fSelPDGs(pdgs), fNSelPDGs(npdgs), fSelState(selstate){};
+
+  inline iterator begin() const { return iterator(this, 0); };
+  inline iterator end() const { return iterator(this, fN); };
+
+  /// Number of matching particles
+  inline int size() const {
+    int n = 0;
+    for (int i = 0; i < fN; i++) n += Matches(i);
+    return n;
+  };
+
+  inline bool empty() const { return !(begin() != end()); };
+
+  inline FitParticleView View(int i) const {
+    return FitParticleView(fMom[i], fPDG[i], fState[i], i);
+  };
+
+  inline bool Matches(int i) const {
+    if (fSelState != -1 && fState[i] != (UInt_t)fSelState) return false;
+    if (!fSelPDGs) return (fSelPDG == 0 || fSelPDG == fPDG[i]);
+    for (size_t j = 0; j < fNSelPDGs; j++) {
+      if (fSelPDGs[j] == 0 || fSelPDGs[j] == fPDG[i]) return true;
+    }
+    return false;
+  };
+
+ private:
+  double *const *fMom;
+  int const *fPDG;
+  UInt_t const *fState;
+  int fN;
+  int fSelPDG;
+  int const *fSelPDGs;
+  size_t fNSelPDGs;
+  int fSelState;
+};
+
+/*! @} */
+#endif
@@ -19,6 +19,7 @@
 
 #include "DummyInputHandler.h"
 #include "FitEventInputHandler.h"
+#include "FitEventCacheInputHandler.h"
 #include "GIBUUInputHandler.h"
 #include "GiBUUNativeInputHandler.h"
 #include "HistogramInputHandler.h"
@@ -48,11 +49,43 @@
 
 #include "TFile.h"
 
+#include <mutex>
+
+namespace {
+// Generator handlers set up the generators' own singletons (messengers,
+// registries, flux and cross-section tables), none of which are thread
+// safe, so they are only ever constructed one at a time.
+std::mutex gGeneratorInputMutex;
+
+// Handlers that only read NUISANCE's own formats through ROOT, and can be
+// constructed concurrently once ROOT::EnableThreadSafety() has been called.
+bool IsThreadSafeInput(InputUtils::InputType inpType) {
+  switch (inpType) {
+  case InputUtils::kFEVENT_Input:
+  case InputUtils::kFEVENTCACHE_Input:
+  case InputUtils::kEVSPLN_Input:
+  case InputUtils::kSIGMAQ0HIST_Input:
+  case InputUtils::kHISTO_Input:
+  case InputUtils::kGenericVectors_Input:
+  case InputUtils::kDummy_Input:
+    return true;
+  default:
+    return false;
+  }
+}
+} // namespace
+
 namespace InputUtils {
 
 InputHandlerBase *CreateInputHandler(std::string const &handle,
                                      InputUtils::InputType inpType,
                                      std::string const &inputs) {
+  std::unique_lock<std::mutex> generatorlock(gGeneratorInputMutex,
+                                             std::defer_lock);
+  if (!IsThreadSafeInput(inpType)) {
+    generatorlock.lock();
+  }
+
   InputHandlerBase *input = NULL;
   std::string newinputs = InputUtils::ExpandInputDirectories(inputs);
 
@@ -120,6 +153,10 @@ InputHandlerBase *CreateInputHandler(std::string const &handle,
     input = new FitEventInputHandler(handle, newinputs);
     break;
 
+  case (kFEVENTCACHE_Input):
+    input = new FitEventCacheInputHandler(handle, newinputs);
+    break;
+
   case (kEVSPLN_Input):
     input = new SplineInputHandler(handle, newinputs);
     break;
@@ -148,6 +185,23 @@ InputHandlerBase *CreateInputHandler(std::string const &handle,
                                                 << " not enabled!");
   }
 
+  input->fInputType = inpType;
+  input->fInputFiles = inputs;
   return input;
 };
+
+InputHandlerBase *CloneInputHandler(InputHandlerBase *input) {
+  if (!input || input->fInputType < 0 || input->fInputFiles.empty() ||
+      !IsThreadSafeInput(InputUtils::InputType(input->fInputType))) {
+    return NULL;
+  }
+
+  InputHandlerBase *clone =
+      CreateInputHandler(input->fName,
+                         InputUtils::InputType(input->fInputType),
+                         input->fInputFiles);
+  // Preload into the one store of the input, under its memory cap
+  clone->SharePreloadStore(input->GetPreloadStore());
+  return clone;
+};
 } // namespace InputUtils
@@ -30,6 +30,12 @@ InputHandlerBase* CreateInputHandler(std::string const& handle,
                                      InputUtils::InputType inpType,
                                      std::string const& inputs);
 
+/// Open a second, independent handler on the same input so that separate
+/// threads can read events from it at once. Returns NULL for inputs that
+/// cannot be read concurrently (generator inputs). The copy preloads into the
+/// same store as input.
+InputHandlerBase* CloneInputHandler(InputHandlerBase* input);
+
 }
 
 
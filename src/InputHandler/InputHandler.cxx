@@ -19,6 +19,8 @@
 #include "InputHandler.h"
 #include "InputUtils.h"
 
+#include <algorithm>
+
 InputHandlerBase::InputHandlerBase() {
   fName = "";
   fFluxHist = NULL;
@@ -32,9 +34,16 @@ InputHandlerBase::InputHandlerBase() {
   fMaxEvents = FitPar::Config().GetParI("MAXEVENTS");
   fTTreePerformance = NULL;
   fSkip = 0;
+  fInputType = -1;
+  fInputFiles = "";
   if (FitPar::Config().HasConfig("NSKIPEVENTS")) {
     fSkip = FitPar::Config().GetParI("NSKIPEVENTS");
   }
+
+  fPreload = FitPar::Config().GetParB("EventPreload");
+  fPreloadGeneratorRead = FitPar::Config().GetParB("EventPreloadGeneratorRead");
+  fPreloadMaxBytes = size_t(FitPar::Config().GetParI("EventPreloadMaxMB")) *
+                     1024 * 1024;
 };
 
 InputHandlerBase::~InputHandlerBase() {
@@ -50,6 +59,7 @@ InputHandlerBase::~InputHandlerBase() {
   jointindexhigh.clear();
   jointindexallowed.clear();
   jointindexscale.clear();
+  ClearPreload();
 
   //  if (fTTreePerformance) {
   //    fTTreePerformance->SaveAs(("ttreeperfstats_" + fName +
@@ -168,7 +178,7 @@ std::vector<TH1 *> InputHandlerBase::GetXSecList(void) {
 
 FitEvent *InputHandlerBase::FirstNuisanceEvent() {
   fCurrentIndex = 0;
-  return GetNuisanceEvent(fCurrentIndex);
+  return ReadNuisanceEvent(fCurrentIndex);
 };
 
 FitEvent *InputHandlerBase::NextNuisanceEvent() {
@@ -177,9 +187,151 @@ FitEvent *InputHandlerBase::NextNuisanceEvent() {
     return NULL;
   }
 
-  return GetNuisanceEvent(fCurrentIndex);
+  return ReadNuisanceEvent(fCurrentIndex);
 };
 
+FitEvent *InputHandlerBase::ReadNuisanceEvent(const UInt_t entry) {
+  // Spline inputs point the event at per-entry coefficient buffers, so
+  // there is nothing to gain from keeping the kinematics.
+  if (!fPreload || fEventType == kEVTSPLINE || fEventType == kNEWSPLINE) {
+    return GetNuisanceEvent(entry);
+  }
+
+  EventPreloadStore *store = GetPreloadStore().get();
+  bool inrange = (entry < store->fEvents.size());
+
+  if (inrange && store->fEvents[entry]) {
+    // Generator inputs still read their record without rebuilding the
+    // particle stack, so engines working from the raw event get the right one.
+    bool hasgenerator = (fEventType == kNEUT || fEventType == kGENIE ||
+                         fEventType == kNuWro || fEventType == kGiBUU ||
+                         fEventType == kNUANCE || fEventType == kNuHepMC);
+    if (fPreloadGeneratorRead && hasgenerator) {
+      if (!GetNuisanceEvent(entry, true))
+        return NULL;
+    }
+
+    FillFromPreload(entry);
+    return fNUISANCEEvent;
+  }
+
+  FitEvent *evt = GetNuisanceEvent(entry);
+  if (evt && inrange && !store->fFull) {
+    AddToPreload(entry, evt);
+  }
+  return evt;
+}
+
+std::shared_ptr<EventPreloadStore> InputHandlerBase::GetPreloadStore() {
+  if (fPreload && !fPreloadStore) {
+    fPreloadStore = std::make_shared<EventPreloadStore>(
+        std::max(GetNEvents(), 0), fPreloadMaxBytes);
+  }
+  return fPreloadStore;
+}
+
+void InputHandlerBase::AddToPreload(const UInt_t entry, FitEvent *evt) {
+  EventPreloadStore *store = fPreloadStore.get();
+
+  size_t nbytes = sizeof(EventPreloadStore::Event) +
+                  evt->fNParticles * sizeof(PreloadedParticle);
+  size_t held = store->fBytes.fetch_add(nbytes) + nbytes;
+  if (held > store->fMaxBytes) {
+    store->fBytes -= nbytes;
+    if (!store->fFull.exchange(true)) {
+      NUIS_LOG(SAM, fName << " : event preload reached the "
+                          << store->fMaxBytes / (1024 * 1024)
+                          << " MB cap after " << store->fNEvents.load()
+                          << " events, later events are read from the input.");
+    }
+    return;
+  }
+
+  EventPreloadStore::Event *stored = new EventPreloadStore::Event;
+  PreloadedEventInfo &info = stored->Info;
+  info.Mode = evt->Mode;
+  info.EventNo = evt->fEventNo;
+  info.TotCrs = evt->fTotCrs;
+  info.TargetA = evt->fTargetA;
+  info.TargetZ = evt->fTargetZ;
+  info.TargetH = evt->fTargetH;
+  info.TargetPDG = evt->fTargetPDG;
+  info.ResCode = evt->fResCode;
+  info.Bound = evt->fBound;
+  info.probe_E = evt->probe_E;
+  info.probe_pdg = evt->probe_pdg;
+  info.InputWeight = evt->InputWeight;
+  info.SavedRWWeight = evt->SavedRWWeight;
+
+  stored->Particles.resize(evt->fNParticles);
+  for (int i = 0; i < evt->fNParticles; i++) {
+    PreloadedParticle &part = stored->Particles[i];
+    part.State = evt->fParticleState[i];
+    part.PDG = evt->fParticlePDG[i];
+    part.Mom[0] = evt->fParticleMom[i][0];
+    part.Mom[1] = evt->fParticleMom[i][1];
+    part.Mom[2] = evt->fParticleMom[i][2];
+    part.Mom[3] = evt->fParticleMom[i][3];
+    part.Primary = evt->fPrimaryVertex[i];
+  }
+  store->fEvents[entry] = stored;
+
+  if (++store->fNEvents == store->fEvents.size()) {
+    NUIS_LOG(SAM, fName << " : preloaded all " << store->fEvents.size()
+                        << " events (" << held / 1.E6 << " MB)");
+  }
+}
+
+void InputHandlerBase::FillFromPreload(const UInt_t entry) {
+  FitEvent *evt = fNUISANCEEvent;
+  evt->ResetEvent();
+
+  EventPreloadStore::Event const *stored = fPreloadStore->fEvents[entry];
+  const PreloadedEventInfo &info = stored->Info;
+  evt->Mode = info.Mode;
+  evt->fEventNo = info.EventNo;
+  evt->fTotCrs = info.TotCrs;
+  evt->fTargetA = info.TargetA;
+  evt->fTargetZ = info.TargetZ;
+  evt->fTargetH = info.TargetH;
+  evt->fTargetPDG = info.TargetPDG;
+  evt->fResCode = info.ResCode;
+  evt->fBound = info.Bound;
+  evt->probe_E = info.probe_E;
+  evt->probe_pdg = info.probe_pdg;
+  evt->InputWeight = info.InputWeight;
+  evt->SavedRWWeight = info.SavedRWWeight;
+
+  UInt_t npart = stored->Particles.size();
+  if (npart > evt->kMaxParticles) {
+    evt->ExpandParticleStack(npart);
+  }
+
+  for (UInt_t i = 0; i < npart; i++) {
+    PreloadedParticle const &part = stored->Particles[i];
+    evt->fParticleState[i] = part.State;
+    evt->fParticlePDG[i] = part.PDG;
+    evt->fParticleMom[i][0] = part.Mom[0];
+    evt->fParticleMom[i][1] = part.Mom[1];
+    evt->fParticleMom[i][2] = part.Mom[2];
+    evt->fParticleMom[i][3] = part.Mom[3];
+    evt->fPrimaryVertex[i] = part.Primary;
+  }
+  evt->fNParticles = npart;
+}
+
+void InputHandlerBase::ClearPreload() { fPreloadStore.reset(); }
+
+EventPreloadStore::EventPreloadStore(size_t nevents, size_t maxbytes)
+    : fEvents(nevents, (Event *)NULL), fMaxBytes(maxbytes),
+      fBytes(nevents * sizeof(Event *)), fNEvents(0), fFull(false) {}
+
+EventPreloadStore::~EventPreloadStore() {
+  for (size_t i = 0; i < fEvents.size(); i++) {
+    delete fEvents[i];
+  }
+}
+
 BaseFitEvt *InputHandlerBase::FirstBaseEvent() {
   fCurrentIndex = 0;
   return GetBaseEvent(fCurrentIndex);
@@ -27,6 +27,56 @@
 #include "TH1D.h"
 #include "TTreePerfStats.h"
 
+#include <atomic>
+#include <memory>
+
+/// Per-event header stored by the InputHandlerBase preload
+struct PreloadedEventInfo {
+  int Mode;
+  UInt_t EventNo;
+  double TotCrs;
+  int TargetA;
+  int TargetZ;
+  int TargetH;
+  int TargetPDG;
+  int ResCode;
+  bool Bound;
+  double probe_E;
+  double probe_pdg;
+  double InputWeight;
+  double SavedRWWeight;
+};
+
+/// Particle stack entry stored by the InputHandlerBase preload
+struct PreloadedParticle {
+  double Mom[4];
+  UInt_t State;
+  int PDG;
+  bool Primary;
+};
+
+/// Preloaded events of one input, keyed by entry. Shared between an input
+/// and its clones (see InputUtils::CloneInputHandler), so each event is kept
+/// once, by whichever reader reads it first, under a single memory cap.
+/// Readers only ever write the entries of their own range, so slots are
+/// filled without locking.
+struct EventPreloadStore {
+  EventPreloadStore(size_t nevents, size_t maxbytes);
+  ~EventPreloadStore();
+
+  /// Header and particles, one allocation per preloaded entry
+  struct Event {
+    PreloadedEventInfo Info;
+    std::vector<PreloadedParticle> Particles;
+  };
+
+  std::vector<Event *> fEvents;   ///< NULL until the entry is preloaded
+  size_t fMaxBytes;               ///< EventPreloadMaxMB for the whole input
+  std::atomic<size_t> fBytes;     ///< Held across every reader
+  std::atomic<size_t> fNEvents;   ///< Entries preloaded
+  std::atomic<bool> fFull;        ///< Memory cap reached, stop adding
+};
+
 /// Base InputHandler class defining how events are requested and setup.
 class InputHandlerBase {
 public:
@@ -73,6 +123,29 @@ public:
   /// Placeholder to remove optional cache to free up memory
   inline virtual void RemoveCache(){};
 
+  /// Return the NUISANCE event for entry, serving it from the preloaded
+  /// event store when it holds the entry (see EventPreload). Events read
+  /// from the generator are added to the store, in any order, until the
+  /// EventPreloadMaxMB cap is reached.
+  FitEvent *ReadNuisanceEvent(const UInt_t entry);
+
+  /// Release this handler's reference to the preloaded event store
+  void ClearPreload();
+
+  /// The preloaded event store, made on first use. NULL if preloading is
+  /// off for this input.
+  std::shared_ptr<EventPreloadStore> GetPreloadStore();
+
+  /// Read and fill the given store instead of this handler's own, so that
+  /// clones of one input preload into a single store.
+  inline void SharePreloadStore(std::shared_ptr<EventPreloadStore> store) {
+    fPreloadStore = store;
+  };
+
+  /// Set whether events served from the store still read the generator
+  /// record (lightweight) so reweight engines see the right event.
+  inline void SetPreloadGeneratorRead(bool read) { fPreloadGeneratorRead = read; };
+
   /// Return starting NUISANCE event pointer (entry=0)
   FitEvent *FirstNuisanceEvent();
   /// Iterate to next NUISANCE event. Returns NULL when entry > fNEvents.
@@ -130,6 +203,20 @@ public:
   bool kRemoveNuclearParticles;
   TTreePerfStats *fTTreePerformance;
   int fSkip;
+  int fInputType;          ///< InputUtils::InputType this was created as
+  std::string fInputFiles; ///< Input descriptor this was created from
+
+  // Preloaded event store
+  bool fPreload;              ///< Serve repeated reads from memory
+  bool fPreloadGeneratorRead; ///< Refresh the generator record on reads
+  size_t fPreloadMaxBytes;
+  std::shared_ptr<EventPreloadStore> fPreloadStore;
+
+private:
+  /// Add the event read for entry to the preloaded store
+  void AddToPreload(const UInt_t entry, FitEvent *evt);
+  /// Fill fNUISANCEEvent from the preloaded store
+  void FillFromPreload(const UInt_t entry);
 };
 /*! @} */
 #endif
@@ -62,6 +62,7 @@ enum InputType {
   kHISTO_Input,
   kGenericVectors_Input,
   kDummy_Input,
+  kFEVENTCACHE_Input,
   kInvalid_Input,
   kBNSPLN_Input,  // Not sure if this are currently used.
 };
@@ -159,6 +160,9 @@ inline std::ostream &operator<<(std::ostream &os, InputUtils::InputType it) {
   case InputUtils::kGenericVectors_Input: {
     return os << "kGenericVectors_Input";
   }
+  case InputUtils::kFEVENTCACHE_Input: {
+    return os << "kFEVENTCACHE_Input";
+  }
   case InputUtils::kInvalid_Input:
   case InputUtils::kBNSPLN_Input:
   default: { return os << "kInvalid_Input"; }
@@ -278,21 +278,6 @@ void StartTalking() {
   dup2(Logger::savedstderrfd, fileno(stderr));
 }
 
-//******************************************
-bool LOG_LEVEL(int level) {
-  //******************************************
-
-  if (Logger::log_verb == (int)DEB) {
-    return true;
-  }
-
-  if (Logger::log_verb < (int)level) {
-    return false;
-  }
-
-  return true;
-}
-
 void SET_TRACE(bool val) { Logger::showtrace = val; }
 
 //******************************************
@@ -98,10 +98,19 @@ extern std::ostream *__LOG_outstream;
 /// was made
 enum __LOG_levels { QUIET = 0, FIT, MIN, SAM, REC, SIG, EVT, DEB };
 
+/// Compile time verbosity ceiling, set with -DNUIS_LOG_MAX_LEVEL at
+/// configure time. NUIS_LOG statements above it are compiled out entirely,
+/// whatever the runtime verbosity.
+#ifndef NUIS_LOG_MAX_LEVEL
+#define NUIS_LOG_MAX_LEVEL 7
+#endif
+
 /// Returns log level for a given file/function
 int __GETLOG_LEVEL(int level, const char *filename, const char *funct);
 
-bool LOG_LEVEL(int level);
+/// Whether a message at level passes the current verbosity. DEB is the
+/// highest level so a DEB verbosity passes everything.
+inline bool LOG_LEVEL(int level) { return (Logger::log_verb >= level); }
 
 /// Actually runs the logger
 std::ostream &__OUTLOG(int level, const char *filename, const char *funct,
@@ -110,7 +119,7 @@ std::ostream &__OUTLOG(int level, const char *filename, const char *funct,
 /// Global Logging Definitions
 #define NUIS_LOGN(level, stream)                                               \
   {                                                                            \
-    if (LOG_LEVEL(level)) {                                                    \
+    if (((level) <= NUIS_LOG_MAX_LEVEL) && LOG_LEVEL(level)) {                \
       __OUTLOG(level, __FILENAME__, __FUNCTION__, __LINE__) << stream;         \
     }                                                                          \
   };
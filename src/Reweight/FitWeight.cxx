@@ -1,5 +1,7 @@
 #include "FitWeight.h"
 
+#include <iterator>
+
 #include "LikelihoodWeightEngine.h"
 #include "ModeNormEngine.h"
 #include "NUISANCEWeightEngine.h"
@@ -102,6 +104,18 @@ void FitWeight::AddRWEngine(int type) {
       NUIS_ABORT("CANNOT ADD RW Engine for unknown dial type: " << type);
       break;
   }
+
+  // Engine positions have shifted, nothing cached can be reused.
+  fRWVersion.resize(fAllRW.size());
+  for (size_t i = 0; i < fRWVersion.size(); i++) {
+    fRWVersion[i] = ++fRWVersionCount;
+  }
+}
+
+void FitWeight::MarkEngineChanged(int type) {
+  std::map<int, WeightEngineBase *>::iterator iter = fAllRW.find(type);
+  if (iter == fAllRW.end()) return;
+  fRWVersion[std::distance(fAllRW.begin(), iter)] = ++fRWVersionCount;
 }
 
 WeightEngineBase *FitWeight::GetRWEngine(int type) {
@@ -175,6 +189,7 @@ void FitWeight::IncludeDial(std::string name, int dialtype, double val) {
 
   // Include the dial
   rw->IncludeDial(name, val);
+  MarkEngineChanged(dialtype);
 
   // Set Dial Value
   if (val != -9999.9) {
@@ -227,6 +242,7 @@ void FitWeight::SetDialValue(int nuisenum, double val) {
 
   // Get RW Engine for this dial
   fAllRW[dialtype]->SetDialValue(nuisenum, val);
+  if (fAllValues[nuisenum] != val) MarkEngineChanged(dialtype);
   fAllValues[nuisenum] = val;
 
   // Update ValueList
@@ -285,6 +301,38 @@ double FitWeight::CalcWeight(BaseFitEvt *evt) {
   return rwweight;
 }
 
+double FitWeight::CalcWeight(BaseFitEvt *evt, FitWeightCache *cache,
+                             size_t slot) {
+  if (!cache || !cache->IsCached(slot) ||
+      cache->fNEngines != fAllRW.size()) {
+    return CalcWeight(evt);
+  }
+
+  double *weights = &cache->fWeights[slot * cache->fNEngines];
+  UInt_t *versions = &cache->fVersions[slot * cache->fNEngines];
+
+  double rwweight = 1.0;
+  size_t i = 0;
+  for (std::map<int, WeightEngineBase *>::iterator iter = fAllRW.begin();
+       iter != fAllRW.end(); iter++, i++) {
+    if (versions[i] != fRWVersion[i]) {
+      weights[i] = (*iter).second->CalcWeight(evt);
+      versions[i] = fRWVersion[i];
+    }
+    rwweight *= weights[i];
+  }
+  return rwweight;
+}
+
+bool FitWeight::IsThreadSafe() {
+  for (std::map<int, WeightEngineBase *>::iterator iter = fAllRW.begin();
+       iter != fAllRW.end(); iter++) {
+    if (!(*iter).second->IsThreadSafe())
+      return false;
+  }
+  return true;
+}
+
 void FitWeight::UpdateWeightEngine(const double *x) {
   size_t count = 0;
   for (std::vector<int>::iterator iter = fEnumList.begin();
@@ -300,30 +348,41 @@ void FitWeight::GetAllDials(double *x, int n) {
   }
 }
 
-// bool FitWeight::NeedsEventReWeight(const double* x) {
-//   bool haschange = false;
-//   size_t count = 0;
+bool FitWeight::HasRWDialChanged(const double *x) {
+  if (fEvaluatedValues.size() != fEnumList.size()) return true;
 
-//   // Compare old to new and decide if RW needed.
-//   for (std::vector<int>::iterator iter = fEnumList.begin();
-//        iter != fEnumList.end(); iter++) {
-//     int nuisenum = (*iter);
-//     int type = (nuisenum / NUIS_DIAL_OFFSET) - (nuisenum % NUIS_DIAL_OFFSET);
+  for (size_t i = 0; i < fEnumList.size(); i++) {
+    if (x[i] != fEvaluatedValues[i]) return true;
+  }
+  return false;
+}
+
+bool FitWeight::HasRWDialChanged() {
+  return fValueList.empty() ? false : HasRWDialChanged(&fValueList[0]);
+}
 
-//     // Compare old to new
-//     double oldval = GetDialValue(nuisenum);
-//     double newval = x[count];
-//     if (oldval != newval) {
-//       if (fAllRW[type]->NeedsEventReWeight()) {
-//         haschange = true;
-//       }
-//     }
+bool FitWeight::IsEngineDirty(int type) {
+  if (!fAllRW.count(type)) return false;
+  if (fEvaluatedValues.size() != fEnumList.size()) return true;
 
-//     count++;
-//   }
+  for (size_t i = 0; i < fEnumList.size(); i++) {
+    if (Reweight::GetDialType(fEnumList[i]) != type) continue;
+    if (fValueList[i] != fEvaluatedValues[i]) return true;
+  }
+  return false;
+}
 
-//   return haschange;
-// }
+bool FitWeight::NeedsEventReWeight() {
+  for (std::map<int, WeightEngineBase *>::iterator iter = fAllRW.begin();
+       iter != fAllRW.end(); iter++) {
+    if ((*iter).second->NeedsEventReWeight() && IsEngineDirty((*iter).first)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void FitWeight::SetDialsEvaluated() { fEvaluatedValues = fValueList; }
 
 double FitWeight::GetSampleNorm(std::string name) {
   if (name.empty()) return 1.0;
@@ -347,3 +406,34 @@ void FitWeight::Print() {
              "|-> Par " << i << ". " << fNameList[i] << " " << fValueList[i]);
   }
 }
+
+void FitWeightCache::Setup(size_t nslots, size_t nengines, double maxmb) {
+  Clear();
+  if (!nengines || maxmb <= 0.0) return;
+
+  size_t slotsize = nengines * (sizeof(double) + sizeof(UInt_t));
+  size_t maxslots = size_t(maxmb * 1E6) / slotsize;
+  if (nslots > maxslots) {
+    NUIS_LOG(FIT, "Event weight cache limited to " << maxslots << " of "
+                                                    << nslots << " events.");
+    nslots = maxslots;
+  }
+
+  fNEngines = nengines;
+  fNSlots = nslots;
+  fWeights.assign(fNSlots * fNEngines, 1.0);
+  // Engine versions start at 1 so every slot is stale
+  fVersions.assign(fNSlots * fNEngines, 0);
+}
+
+void FitWeightCache::Clear() {
+  fNEngines = 0;
+  fNSlots = 0;
+  std::vector<double>().swap(fWeights);
+  std::vector<UInt_t>().swap(fVersions);
+}
+
+size_t FitWeightCache::GetMemoryUsage() const {
+  return fWeights.capacity() * sizeof(double) +
+         fVersions.capacity() * sizeof(UInt_t);
+}
@@ -9,9 +9,33 @@
 #include <map>
 #include <vector>
 
+/// Per-event, per-engine weights kept between reconfigures so that only
+/// engines whose dials moved need recalculating. Slots past the memory limit
+/// given to Setup are not cached and always use the full calculation.
+class FitWeightCache {
+public:
+  FitWeightCache() : fNEngines(0), fNSlots(0) {};
+
+  /// Size the cache for nslots events of nengines engines, capped at maxmb
+  /// megabytes. Every slot starts out stale.
+  void Setup(size_t nslots, size_t nengines, double maxmb);
+  void Clear();
+
+  inline bool IsCached(size_t slot) const { return slot < fNSlots; };
+  inline size_t GetNSlots() const { return fNSlots; };
+
+  /// Bytes held by the cache
+  size_t GetMemoryUsage() const;
+
+  size_t fNEngines;
+  size_t fNSlots;
+  std::vector<double> fWeights;  ///< fNSlots x fNEngines weights
+  std::vector<UInt_t> fVersions; ///< Engine version each weight was made at
+};
+
 class FitWeight {
 public:
-  FitWeight(std::string name = "") {};
+  FitWeight(std::string name = "") : fRWVersionCount(0) {};
 
   // Add a new RW engine given type
   void AddRWEngine(int rwtype);
@@ -38,8 +62,26 @@ public:
   bool DialIncluded(int rwenum);
 
   double CalcWeight(BaseFitEvt* evt);
-  bool HasRWDialChanged(const double* x) { return true; };
-  // bool NeedsEventReWeight(const double* x);
+  /// CalcWeight reusing the weights saved in slot for engines whose dials
+  /// have not moved since they were calculated.
+  double CalcWeight(BaseFitEvt* evt, FitWeightCache* cache, size_t slot);
+  inline size_t GetNEngines() { return fAllRW.size(); };
+  bool IsThreadSafe();
+
+  /// Whether x, ordered as GetDialEnums, differs from the dial values at
+  /// the last SetDialsEvaluated call.
+  bool HasRWDialChanged(const double* x);
+  /// Whether the current dial values differ from the last evaluated ones.
+  bool HasRWDialChanged();
+  /// Whether any dial belonging to engine type has moved since the last
+  /// evaluation.
+  bool IsEngineDirty(int type);
+  /// Whether any engine with moved dials changes event weights. False when
+  /// only normalisation-type engines changed, in which case the samples
+  /// only need renormalising.
+  bool NeedsEventReWeight();
+  /// Record the current dial values as the last evaluated set.
+  void SetDialsEvaluated();
 
   void SetAllDials(const double* x, int n);
 
@@ -62,6 +104,14 @@ public:
   std::map<int, double> fAllValues;
   std::map<int, WeightEngineBase*> fAllRW;
 
+  std::vector<double> fEvaluatedValues; //!< fValueList at last evaluation
+
+  /// Mark cached weights from engine type as stale
+  void MarkEngineChanged(int type);
+
+  std::vector<UInt_t> fRWVersion; //!< Per engine in fAllRW order
+  UInt_t fRWVersionCount;
+
 };
 
 #endif
@@ -50,7 +50,8 @@ public:
                       << ", weight = " << fDialValues[fDialEnumIndex[mode]]);
     return fDialValues[fDialEnumIndex[mode]];
   };
-  bool NeedsEventReWeight() { return false; };
+  bool NeedsEventReWeight() { return true; };
+  bool IsThreadSafe() { return true; };
 
   double GetDialValue(std::string name) {
     int rwenum = Reweight::ConvDial(name, kMODENORM);
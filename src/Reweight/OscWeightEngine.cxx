@@ -225,12 +225,9 @@ double OscWeightEngine::GetDialValue(int nuisenum) {
 
 void OscWeightEngine::Reconfigure(bool silent) { fHasChanged = false; };
 
-bool OscWeightEngine::NeedsEventReWeight() {
-  if (fHasChanged) {
-    return true;
-  }
-  return false;
-}
+// FitWeight tracks which engines have moved dials, any change here needs
+// the events reweighting.
+bool OscWeightEngine::NeedsEventReWeight() { return true; }
 
 double OscWeightEngine::CalcWeight(BaseFitEvt* evt) {
   static bool Warned = false;
@@ -17,6 +17,7 @@ class SampleNormEngine : public WeightEngineBase {
 		void Reconfigure(bool silent = false);
 		inline double CalcWeight(BaseFitEvt* evt) {return 1.0;};
 		inline bool NeedsEventReWeight(){ return false; };
+		inline bool IsThreadSafe(){ return true; };
 
 		double GetDialValue(std::string name);
 };
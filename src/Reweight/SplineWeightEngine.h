@@ -17,6 +17,7 @@ class SplineWeightEngine : public WeightEngineBase {
 		void Reconfigure(bool silent = false);
 		inline double CalcWeight(BaseFitEvt* evt);
 		inline bool NeedsEventReWeight(){ return true; };
+		inline bool IsThreadSafe(){ return true; };
 
 		std::map< std::string, double > fSplineValueMap;
 		std::vector<int> fSingleEnums;
@@ -40,8 +40,17 @@ class WeightEngineBase {
   virtual void Reconfigure(bool silent){};
 
   virtual double CalcWeight(BaseFitEvt* evt) { return 1.0; };
+
+  /// Whether moving this engine's dials changes event weights. Engines that
+  /// only act on sample normalisations return false so that FitWeight can
+  /// skip the event loop when nothing else changed.
   virtual bool NeedsEventReWeight() = 0;
 
+  /// Whether CalcWeight can be called concurrently for events belonging to
+  /// different inputs. Engines wrapping generator reweighting libraries keep
+  /// global state and must leave this false.
+  virtual bool IsThreadSafe() { return false; };
+
   std::string GetNameFromEnum(int nuisenum);
 
   bool fHasChanged;
@@ -146,12 +146,9 @@ void nusystematicsWeightEngine::Reconfigure(bool silent) {
   fHasChanged = false;
 };
 
-bool nusystematicsWeightEngine::NeedsEventReWeight() {
-  if (fHasChanged) {
-    return true;
-  }
-  return false;
-}
+// FitWeight tracks which engines have moved dials, any change here needs
+// the events reweighting.
+bool nusystematicsWeightEngine::NeedsEventReWeight() { return true; }
 
 double nusystematicsWeightEngine::CalcWeight(BaseFitEvt *evt) {
 
@@ -53,6 +53,7 @@ void MinimizerRoutines::Init() {
   fMinimizer = NULL;
   fMinimizerFCN = NULL;
   fCallFunctor = NULL;
+  fGradFunctor = NULL;
 
   fAllowedRoutines = ("Migrad,Simplex,Combined,"
                       "Brute,Fumili,ConjugateFR,"
@@ -403,6 +404,13 @@ void MinimizerRoutines::SetupFCN() {
 
   fMinimizerFCN = new MinimizerFCN(fSampleFCN);
   fCallFunctor = new ROOT::Math::Functor(*fMinimizerFCN, fParams.size());
+  if (fGradFunctor)
+    delete fGradFunctor;
+  fGradFunctor = NULL;
+  if (FitPar::Config().GetParB("AnalyticGradient")) {
+    fGradFunctor =
+        new ROOT::Math::GradFunctor(*fMinimizerFCN, fParams.size());
+  }
 
   fSampleFCN->CreateIterationTree("fit_iterations", FitBase::GetRW());
 
@@ -463,7 +471,21 @@ void MinimizerRoutines::SetupFitter(std::string routine) {
     delete fMinimizer;
 
   if (UseMCMC) {
-    fMinimizer = new Simple_MH_Sampler();
+    Simple_MH_Sampler *sampler = new Simple_MH_Sampler();
+    fMinimizer = sampler;
+
+    // Forked chains would share the FCN's worker connections
+    if (FitPar::Config().GetParI("MCMC.NChains") > 1 &&
+        fSampleFCN->IsDistributed()) {
+      NUIS_ERR(WRN, "MCMC.NChains is ignored with DistributedWorkers, "
+                    "running a single chain.");
+      sampler->SetNChains(1);
+    }
+
+    // Chains run in forked processes, where OpenMP pools do not survive
+    if (sampler->GetNChains() > 1) {
+      fSampleFCN->SetNThreads(1);
+    }
   } else {
     fMinimizer = ROOT::Math::Factory::CreateMinimizer(fitclass, fittype);
   }
@@ -481,6 +503,7 @@ void MinimizerRoutines::SetupFitter(std::string routine) {
   fMinimizer->SetFunction(*fCallFunctor);
 
   int ipar = 0;
+  std::vector<double> startvals;
   // Add Fit Parameters
   for (UInt_t i = 0; i < fParams.size(); i++) {
     std::string syst = fParams.at(i);
@@ -511,6 +534,9 @@ void MinimizerRoutines::SetupFitter(std::string routine) {
                                       fMirroredParams[syst].mirror_above);
     }
 
+    fSampleFCN->SetVariableFixed(ipar, fixed);
+    startvals.push_back(vstart);
+
     if (fixed) {
       fMinimizer->FixVariable(ipar);
       NUIS_LOG(FIT, "Fixed Param: " << syst);
@@ -525,6 +551,21 @@ void MinimizerRoutines::SetupFitter(std::string routine) {
   }
   fSampleFCN->SetNParams(ipar);
 
+  // Hand gradient based minimizers the spline gradient, once it has been
+  // shown to agree with finite differences at the start point
+  if (fGradFunctor && !UseMCMC) {
+    if (!fSampleFCN->CanUseAnalyticGradient()) {
+      NUIS_ERR(WRN, "AnalyticGradient needs spline inputs with "
+                        "SignalReconfigures, using numeric derivatives.");
+    } else if (!fSampleFCN->CheckGradient(&startvals[0])) {
+      NUIS_ERR(WRN, "Analytic gradient disagrees with finite differences, "
+                        "using numeric derivatives.");
+    } else {
+      NUIS_LOG(FIT, "Using analytic spline gradient for " << routine);
+      fMinimizer->SetFunction(*fGradFunctor);
+    }
+  }
+
   NUIS_LOG(FIT, "Setup Minimizer: " << fMinimizer->NDim() << "(NDim) "
                                     << fMinimizer->NFree() << "(NFree)");
 
@@ -634,6 +675,10 @@ void MinimizerRoutines::Run() {
     }
   }
 
+  if (fSampleFCN) {
+    fSampleFCN->GetStageTimer().PrintSummary();
+  }
+
   return;
 }
 
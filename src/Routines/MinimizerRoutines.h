@@ -231,6 +231,7 @@ protected:
   JointFCN* fSampleFCN;
   MinimizerFCN* fMinimizerFCN;
   ROOT::Math::Functor* fCallFunctor;
+  ROOT::Math::GradFunctor* fGradFunctor; ///< Set if AnalyticGradient is on
 
   int nfreepars;
 
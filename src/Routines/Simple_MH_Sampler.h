@@ -2,6 +2,22 @@
 
 #include "FitLogger.h"
 
+#include "TDecompChol.h"
+#include "TFile.h"
+#include "TGraph.h"
+#include "TMatrixD.h"
+#include "TMatrixDSym.h"
+#include "TRandom3.h"
+#include "TTree.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <sstream>
+#include <sys/wait.h>
+#include <unistd.h>
+
 using ROOT::Math::Minimizer;
 
 class Simple_MH_Sampler : public Minimizer {
@@ -15,6 +31,23 @@ class Simple_MH_Sampler : public Minimizer {
 
   size_t discard;
 
+  // Independent chains, each run in a forked process with its own copy of
+  // the FCN and samples
+  size_t nchains;
+  ULong64_t seed;
+  std::string chain_tag;
+
+  // Adaptive proposal: the covariance of the free parameters is learnt from
+  // the chain after burn-in and refreshed every adapt_interval steps
+  bool adaptive;
+  size_t adapt_interval;
+  std::vector<size_t> free_params;
+  size_t adapt_n;
+  std::vector<double> adapt_mean;
+  TMatrixDSym adapt_sum;
+  TMatrixD prop_chol;
+  bool use_adapted;
+
   struct Param {
     Param()
         : IsFixed(false),
@@ -53,6 +86,7 @@ class Simple_MH_Sampler : public Minimizer {
   }
 
   TTree *StepTree;
+  TDirectory *OutDir;
 
   void Write();
 
@@ -61,12 +95,46 @@ class Simple_MH_Sampler : public Minimizer {
  public:
   Simple_MH_Sampler() : Minimizer(), RNJesus(), trace() {
     thin = Config::GetParI("MCMC.thin");
+    if (thin < 1) {
+      thin = 1;
+    }
     thin_ctr = 0;
     discard = Config::GetParI("MCMC.BurnInSteps");
+
+    int nc = Config::GetParI("MCMC.NChains");
+    nchains = (nc > 1) ? nc : 1;
+    seed = Config::GetParI("MCMC.Seed");
+
+    adaptive = Config::GetParB("MCMC.Adaptive");
+    int ai = Config::GetParI("MCMC.AdaptInterval");
+    adapt_interval = (ai > 0) ? ai : 100;
+    adapt_n = 0;
+    use_adapted = false;
+
+    StepTree = NULL;
+    OutDir = NULL;
+    FCN = NULL;
+  }
+
+  /// SplitMix64 of the master seed and chain index, so chains are
+  /// reproducible and unrelated to one another.
+  static UInt_t GetChainSeed(ULong64_t masterseed, size_t chain) {
+    ULong64_t z = masterseed + 0x9E3779B97F4A7C15ULL * ULong64_t(chain + 1);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z = z ^ (z >> 31);
+
+    // TRandom3 treats a zero seed as a request for a random one
+    UInt_t chainseed = UInt_t(z & 0xFFFFFFFFULL);
+    return chainseed ? chainseed : 1;
   }
 
   void SetFunction(ROOT::Math::IMultiGenFunction const &func) { FCN = &func; }
 
+  /// Chains are forked, so an FCN that cannot be copied by fork needs 1
+  void SetNChains(size_t nc) { nchains = (nc > 1) ? nc : 1; }
+  size_t GetNChains() const { return nchains; }
+
   bool SetVariable(unsigned int ivar, std::string const &name, double val,
                    double step) {
     if (start_params.size() <= ivar) {
@@ -177,13 +245,15 @@ class Simple_MH_Sampler : public Minimizer {
     return NFree;
   }
 
-  void AddBranches() {
+  void AddBranches(std::string const &treename = "MCMChain") {
     TFile *ogf = gFile;
-    if (Config::Get().out && Config::Get().out->IsOpen()) {
+    if (OutDir) {
+      OutDir->cd();
+    } else if (Config::Get().out && Config::Get().out->IsOpen()) {
       Config::Get().out->cd();
     }
 
-    StepTree = new TTree("MCMChain", "");
+    StepTree = new TTree(treename.c_str(), "");
     StepTree->Branch("Step", &step_i, "Step/I");
     StepTree->Branch("Value", &curr_value, "Value/D");
     StepTree->Branch("Moved", &moved, "Moved/I");
@@ -204,6 +274,11 @@ class Simple_MH_Sampler : public Minimizer {
   void Fill() { StepTree->Fill(); }
 
   void Propose() {
+    if (use_adapted) {
+      ProposeAdapted();
+      return;
+    }
+
     for (size_t p_it = 0; p_it < start_params.size(); ++p_it) {
       double propose_param = curr_params[p_it];
 
@@ -243,9 +318,109 @@ class Simple_MH_Sampler : public Minimizer {
     }
   }
 
+  /// Correlated step from the adapted covariance of the free parameters
+  void ProposeAdapted() {
+    size_t nfree = free_params.size();
+    std::vector<double> z(nfree);
+
+    for (size_t attempts = 0; attempts <= 1000; ++attempts) {
+      for (size_t i = 0; i < nfree; ++i) {
+        z[i] = RNJesus.Gaus(0.0, 1.0);
+      }
+
+      propose_params = curr_params;
+      bool inside = true;
+      for (size_t i = 0; i < nfree && inside; ++i) {
+        size_t p_it = free_params[i];
+        double thr = curr_params[p_it];
+        for (size_t j = 0; j <= i; ++j) {
+          thr += prop_chol(j, i) * z[j];
+        }
+
+        if (((start_params[p_it].LowLim != 0xdeadbeef) &&
+             (thr < start_params[p_it].LowLim)) ||
+            ((start_params[p_it].UpLim != 0xdeadbeef) &&
+             (thr > start_params[p_it].UpLim))) {
+          inside = false;
+        }
+        propose_params[p_it] = thr;
+      }
+
+      if (inside) {
+        return;
+      }
+    }
+
+    NUIS_ABORT("After 1000 attempts, failed to throw an adapted proposal "
+               "inside the parameter limits.");
+  }
+
+  /// Add the current point to the running mean and covariance sums
+  void Accumulate() {
+    size_t nfree = free_params.size();
+    adapt_n++;
+
+    std::vector<double> delta(nfree);
+    for (size_t i = 0; i < nfree; ++i) {
+      delta[i] = curr_params[free_params[i]] - adapt_mean[i];
+      adapt_mean[i] += delta[i] / double(adapt_n);
+    }
+    for (size_t i = 0; i < nfree; ++i) {
+      for (size_t j = 0; j <= i; ++j) {
+        double d = delta[i] * (curr_params[free_params[j]] - adapt_mean[j]);
+        adapt_sum(i, j) += d;
+        if (i != j) {
+          adapt_sum(j, i) += d;
+        }
+      }
+    }
+  }
+
+  /// Rebuild the proposal from the chain covariance, scaled by 2.38^2/d
+  /// (Haario et al.), keeping the previous one if it is not positive
+  /// definite yet.
+  void UpdateProposal() {
+    size_t nfree = free_params.size();
+    if (adapt_n <= nfree + 1) {
+      return;
+    }
+
+    TMatrixDSym cov(adapt_sum);
+    cov *= (2.38 * 2.38 / double(nfree)) / double(adapt_n - 1);
+    for (size_t i = 0; i < nfree; ++i) {
+      cov(i, i) += 1E-10 + 1E-6 * cov(i, i);
+    }
+
+    TDecompChol chol(cov);
+    if (!chol.Decompose()) {
+      NUIS_LOG(REC, chain_tag << "Adapted covariance is not positive "
+                              "definite, keeping the previous proposal.");
+      return;
+    }
+
+    prop_chol.ResizeTo(nfree, nfree);
+    prop_chol = chol.GetU();
+    use_adapted = true;
+  }
+
+  void RestartAdaptation() {
+    free_params.clear();
+    for (size_t p_it = 0; p_it < start_params.size(); ++p_it) {
+      if (!start_params[p_it].IsFixed) {
+        free_params.push_back(p_it);
+      }
+    }
+    adapt_n = 0;
+    adapt_mean.assign(free_params.size(), 0.0);
+    adapt_sum.ResizeTo(free_params.size(), free_params.size());
+    adapt_sum.Zero();
+    use_adapted = false;
+  }
+
   void Evaluate() {
     propose_value = exp(-(*FCN)(propose_params.data()) / 10000.0);
-    if (propose_value < min_value) {
+    if (propose_value > min_value) {
+      min_value = propose_value;
       min_params = propose_params;
     }
   }
@@ -270,7 +445,7 @@ class Simple_MH_Sampler : public Minimizer {
       NUIS_ABORT("Proposed a NAN value.");
     }
 
-    std::cout << "[" << step_i << "] proposed: " << propose_value
+    std::cout << chain_tag << "[" << step_i << "] proposed: " << propose_value
               << " | current: " << curr_value << std::endl;
     double a = propose_value / curr_value;
     std::cout << "\ta = " << a << std::endl;
@@ -293,20 +468,22 @@ class Simple_MH_Sampler : public Minimizer {
     }
   }
 
-  bool Minimize() {
-    if (!start_params.size()) {
-      NUIS_ERR(FTL, "No Parameters passed to Simple_MH_Sampler.");
-      return false;
-    }
-
+  /// Run one chain from the start parameters, writing its steps and trace
+  void RunChain(std::string const &treename, std::string const &tracename) {
     RestartParams();
+    RestartAdaptation();
 
-    AddBranches();
+    // Likelihood at the start, so the first step has something to compare
+    curr_value = exp(-(*FCN)(curr_params.data()) / 10000.0);
+    min_value = curr_value;
+
+    AddBranches(treename);
 
     size_t NSteps = Options().MaxIterations();
     trace.Set(NSteps);
-    NUIS_LOG(FIT, "Running chain for " << NSteps << " steps.");
+    NUIS_LOG(FIT, chain_tag << "Running chain for " << NSteps << " steps.");
     step_i = 0;
+    thin_ctr = 0;
     while (step_i < NSteps) {
       Propose();
 
@@ -322,13 +499,310 @@ class Simple_MH_Sampler : public Minimizer {
           Fill();
           thin_ctr = 0;
         }
+
+        if (adaptive && !free_params.empty()) {
+          Accumulate();
+          if ((adapt_n % adapt_interval) == 0) {
+            UpdateProposal();
+          }
+        }
       }
       step_i++;
     }
 
+    if (OutDir) {
+      OutDir->cd();
+    }
     StepTree->Write();
-    trace.Write("MCMCTrace");
+    trace.Write(tracename.c_str());
+  }
 
-    return true;
+  bool Minimize() {
+    if (!start_params.size()) {
+      NUIS_ERR(FTL, "No Parameters passed to Simple_MH_Sampler.");
+      return false;
+    }
+
+    if (nchains == 1) {
+      if (seed) {
+        RNJesus.SetSeed(GetChainSeed(seed, 0));
+      }
+      RunChain("MCMChain", "MCMCTrace");
+      return true;
+    }
+
+    return RunChains();
   };
+
+  /// Fork one process per chain, each sampling with its own copy of the FCN
+  /// into its own file, then collect the chains and their diagnostics into
+  /// the output file.
+  bool RunChains() {
+    TFile *outfile = Config::Get().out;
+    std::string outname = (outfile && outfile->IsOpen())
+                              ? std::string(outfile->GetName())
+                              : std::string("nuisance_mcmc");
+    if (outfile && outfile->IsOpen()) {
+      outfile->Flush();
+    }
+
+    ULong64_t masterseed = seed ? seed : ULong64_t(time(NULL));
+    NUIS_LOG(FIT, "Running " << nchains << " MCMC chains with seed "
+                             << masterseed);
+
+    std::vector<std::string> chainfiles;
+    std::vector<pid_t> chainpids;
+    for (size_t c = 0; c < nchains; ++c) {
+      std::stringstream ss("");
+      ss << outname << ".chain" << c << ".root";
+      chainfiles.push_back(ss.str());
+
+      pid_t pid = fork();
+      if (pid < 0) {
+        NUIS_ABORT("Failed to fork MCMC chain " << c);
+      }
+
+      if (pid == 0) {
+        ss.str("");
+        ss << "[chain " << c << "] ";
+        chain_tag = ss.str();
+        RNJesus.SetSeed(GetChainSeed(masterseed, c));
+
+        TFile *chainfile = new TFile(chainfiles[c].c_str(), "RECREATE");
+        OutDir = chainfile;
+        RunChain("MCMChain", "MCMCTrace");
+        chainfile->Close();
+
+        // Skip the parent's exit handlers and open files
+        _exit(0);
+      }
+
+      chainpids.push_back(pid);
+    }
+
+    for (size_t c = 0; c < nchains; ++c) {
+      int status = 0;
+      waitpid(chainpids[c], &status, 0);
+      if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        NUIS_ABORT("MCMC chain " << c << " (pid " << chainpids[c]
+                                 << ") did not finish cleanly.");
+      }
+    }
+
+    MergeChains(chainfiles);
+    return true;
+  }
+
+  /// Copy each chain into the output as MCMChain_<c>, keep the best point
+  /// seen by any chain, and write the convergence diagnostics.
+  void MergeChains(std::vector<std::string> const &chainfiles) {
+    TFile *ogf = gFile;
+    TFile *outfile = Config::Get().out;
+
+    RestartAdaptation();
+    size_t nfree = free_params.size();
+
+    // samples[param][chain][step]
+    std::vector<std::vector<std::vector<double> > > samples(
+        nfree, std::vector<std::vector<double> >(nchains));
+
+    min_value = -1;
+    for (size_t c = 0; c < nchains; ++c) {
+      TFile *chainfile = new TFile(chainfiles[c].c_str(), "READ");
+      if (!chainfile || chainfile->IsZombie()) {
+        NUIS_ABORT("Could not open MCMC chain output " << chainfiles[c]);
+      }
+
+      TTree *chain = (TTree *)chainfile->Get("MCMChain");
+      TGraph *chaintrace = (TGraph *)chainfile->Get("MCMCTrace");
+      if (!chain) {
+        NUIS_ABORT("No MCMChain in " << chainfiles[c]);
+      }
+
+      double value = 0.0;
+      std::vector<double> vals(start_params.size(), 0.0);
+      chain->SetBranchAddress("Value", &value);
+      std::stringstream ss("");
+      for (size_t p_it = 0; p_it < start_params.size(); ++p_it) {
+        ss.str("");
+        ss << "param_" << p_it;
+        chain->SetBranchAddress(ss.str().c_str(), &vals[p_it]);
+      }
+
+      for (Long64_t i = 0; i < chain->GetEntries(); ++i) {
+        chain->GetEntry(i);
+        for (size_t j = 0; j < nfree; ++j) {
+          samples[j][c].push_back(vals[free_params[j]]);
+        }
+        if (value > min_value) {
+          min_value = value;
+          min_params = vals;
+        }
+      }
+      chain->ResetBranchAddresses();
+
+      if (outfile && outfile->IsOpen()) {
+        outfile->cd();
+      }
+      ss.str("");
+      ss << "MCMChain_" << c;
+      TTree *copy = chain->CloneTree(-1, "fast");
+      copy->Write(ss.str().c_str());
+      delete copy;
+      if (chaintrace) {
+        ss.str("");
+        ss << "MCMCTrace_" << c;
+        chaintrace->Write(ss.str().c_str());
+      }
+
+      chainfile->Close();
+      delete chainfile;
+      std::remove(chainfiles[c].c_str());
+    }
+
+    if (min_value < 0) {
+      NUIS_ERR(WRN, "No MCMC steps were saved, keeping the start point.");
+      RestartParams();
+    }
+    curr_params = min_params;
+
+    WriteDiagnostics(samples);
+
+    if (ogf && ogf->IsOpen()) {
+      ogf->cd();
+    }
+  }
+
+  /// Gelman-Rubin R-hat over chains truncated to a common length
+  static double GetRHat(std::vector<std::vector<double> > const &chains) {
+    size_t m = chains.size();
+    size_t n = chains[0].size();
+    for (size_t c = 1; c < m; ++c) {
+      n = std::min(n, chains[c].size());
+    }
+    if (m < 2 || n < 2) {
+      return -1;
+    }
+
+    std::vector<double> means(m, 0.0);
+    double grandmean = 0.0;
+    double W = 0.0;
+    for (size_t c = 0; c < m; ++c) {
+      for (size_t i = 0; i < n; ++i) {
+        means[c] += chains[c][i];
+      }
+      means[c] /= double(n);
+      grandmean += means[c] / double(m);
+
+      double var = 0.0;
+      for (size_t i = 0; i < n; ++i) {
+        var += (chains[c][i] - means[c]) * (chains[c][i] - means[c]);
+      }
+      W += var / double(n - 1) / double(m);
+    }
+
+    double B = 0.0;
+    for (size_t c = 0; c < m; ++c) {
+      B += (means[c] - grandmean) * (means[c] - grandmean);
+    }
+    B *= double(n) / double(m - 1);
+
+    if (W <= 0) {
+      return -1;
+    }
+    double V = (double(n - 1) / double(n)) * W + B / double(n);
+    return std::sqrt(V / W);
+  }
+
+  /// Effective sample size of one chain, summing autocorrelations in pairs
+  /// until a pair goes negative (Geyer's initial positive sequence).
+  static double GetESS(std::vector<double> const &chain) {
+    size_t n = chain.size();
+    if (n < 4) {
+      return double(n);
+    }
+
+    double mean = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+      mean += chain[i];
+    }
+    mean /= double(n);
+
+    double var = 0.0;
+    for (size_t i = 0; i < n; ++i) {
+      var += (chain[i] - mean) * (chain[i] - mean);
+    }
+    if (var <= 0) {
+      return 0.0;
+    }
+
+    double tau = -1.0;
+    for (size_t lag = 0; lag + 1 < n; lag += 2) {
+      double pair = 0.0;
+      for (size_t l = lag; l <= lag + 1; ++l) {
+        double acf = 0.0;
+        for (size_t i = 0; i + l < n; ++i) {
+          acf += (chain[i] - mean) * (chain[i + l] - mean);
+        }
+        pair += acf / var;
+      }
+      if (pair < 0) {
+        break;
+      }
+      tau += 2.0 * pair;
+    }
+
+    return double(n) / std::max(tau, 1.0);
+  }
+
+  void WriteDiagnostics(
+      std::vector<std::vector<std::vector<double> > > const &samples) {
+    TFile *outfile = Config::Get().out;
+    if (outfile && outfile->IsOpen()) {
+      outfile->cd();
+    }
+
+    TTree diag("MCMCDiagnostics", "");
+    std::string name;
+    int index;
+    double rhat, ess, mean, sigma;
+    diag.Branch("Name", &name);
+    diag.Branch("Param", &index, "Param/I");
+    diag.Branch("RHat", &rhat, "RHat/D");
+    diag.Branch("ESS", &ess, "ESS/D");
+    diag.Branch("Mean", &mean, "Mean/D");
+    diag.Branch("Sigma", &sigma, "Sigma/D");
+
+    NUIS_LOG(FIT, "MCMC convergence over " << nchains << " chains:");
+    for (size_t j = 0; j < samples.size(); ++j) {
+      index = free_params[j];
+      name = start_params[index].name;
+      rhat = GetRHat(samples[j]);
+
+      ess = 0.0;
+      double sum = 0.0, sum2 = 0.0;
+      size_t n = 0;
+      for (size_t c = 0; c < samples[j].size(); ++c) {
+        ess += GetESS(samples[j][c]);
+        for (size_t i = 0; i < samples[j][c].size(); ++i) {
+          sum += samples[j][c][i];
+          sum2 += samples[j][c][i] * samples[j][c][i];
+        }
+        n += samples[j][c].size();
+      }
+      mean = n ? sum / double(n) : 0.0;
+      sigma = n ? std::sqrt(std::max(sum2 / double(n) - mean * mean, 0.0))
+                : 0.0;
+
+      NUIS_LOG(FIT, "\t" << name << " : mean = " << mean << " +- " << sigma
+                         << ", R-hat = " << rhat << ", ESS = " << ess);
+      if (rhat > 1.1) {
+        NUIS_ERR(WRN, name << " has R-hat " << rhat
+                           << " > 1.1, chains have not converged.");
+      }
+      diag.Fill();
+    }
+
+    diag.Write();
+  }
 };
@@ -420,6 +420,12 @@ void SplineRoutines::GenerateEventWeightChunks(int procchunk) {
   }
   splwrite->SetupSplineSet();
 
+  // Reweighting libraries are not thread safe, so extra workers are forked
+  // processes each owning a copy of the engine and its own input files.
+  int nworkers = FitPar::Config().GetParI("spline_weight_workers");
+  if (nworkers <= 0)
+    nworkers = 1;
+
   // Event Loop
   // Loop over all events and calculate weights for each parameter set.
 
@@ -443,10 +449,6 @@ void SplineRoutines::GenerateEventWeightChunks(int procchunk) {
     }
     outputfilename += ".weights.root";
 
-    // Make new outputfile
-    TFile *outputfile = new TFile(outputfilename.c_str(), "RECREATE");
-    outputfile->cd();
-
     // Make a new input handler
     std::vector<std::string> file_descriptor =
         GeneralUtils::ParseToStr(inputfilename, ":");
@@ -462,116 +464,120 @@ void SplineRoutines::GenerateEventWeightChunks(int procchunk) {
 
     // Get info from inputhandler
     int nevents = input->GetNEvents();
-    // int countwidth = (nevents / 1000);
-    FitEvent *nuisevent = input->FirstNuisanceEvent();
 
-    // Setup a TTree to save the event
-    outputfile->cd();
-    TTree *eventtree = new TTree("nuisance_events", "nuisance_events");
-
-    // Add a flag that allows just splines to be saved.
-    nuisevent->AddBranchesToTree(eventtree);
-
-    // Save the spline reader
-    splwrite->Write("spline_reader");
-
-    // Setup the spline TTree
-    TTree *weighttree = new TTree("weight_tree", "weight_tree");
-    splwrite->AddWeightsToTree(weighttree);
-
-    // Make container for all weights
-    int nweights = splwrite->GetNWeights();
-    // int npar = splwrite->GetNPars();
-    // double* weightcont = new double[nweights];
-
-    int lasttime = time(NULL);
-
-    // Load N Chunks of the Weights into Memory
-    // Split into N processing chunks
+    // Split into N processing chunks, only used to select a single one
     int nchunks = FitPar::Config().GetParI("spline_chunks");
     if (nchunks <= 0)
       nchunks = 1;
     if (nchunks >= nevents / 2)
       nchunks = nevents / 2;
+    if (nchunks <= 0)
+      nchunks = 1;
 
-    std::cout << "Starting NChunks " << nchunks << std::endl;
-    for (int ichunk = 0; ichunk < nchunks; ichunk++) {
-
-      // Skip to only do one processing chunk
-      if (procchunk != -1 and procchunk != ichunk)
-        continue;
-
-      NUIS_LOG(FIT, "On Processing Chunk " << ichunk);
-      int neventsinchunk = nevents / nchunks;
-      int loweventinchunk = neventsinchunk * ichunk;
-      // int higheventinchunk = neventsinchunk * (ichunk + 1);
+    int firstevent = 0;
+    int lastevent = nevents;
+    if (procchunk != -1) {
+      firstevent = (nevents / nchunks) * procchunk;
+      lastevent = (procchunk == nchunks - 1) ? nevents
+                                             : firstevent + nevents / nchunks;
+      NUIS_LOG(FIT, "On Processing Chunk " << procchunk << "/" << nchunks
+                                           << ", events " << firstevent
+                                           << " to " << lastevent);
+    }
+    if (nworkers > lastevent - firstevent)
+      nworkers = std::max(1, lastevent - firstevent);
 
-      double **allweightcont = new double *[neventsinchunk];
-      for (int k = 0; k < neventsinchunk; k++) {
-        allweightcont[k] = new double[nweights];
-      }
+    if (nworkers == 1) {
+      // Make new outputfile
+      TFile *outputfile = new TFile(outputfilename.c_str(), "RECREATE");
+      FillEventWeights(input, splwrite, outputfile, firstevent, lastevent);
 
-      // Start Set Processing Here.
-      for (int iset = 0; iset < nweights; iset++) {
+      outputfile->cd();
+      input->GetFluxHistogram()->Write("nuisance_fluxhist");
+      input->GetEventHistogram()->Write("nuisance_eventhist");
+      splwrite->Write("spline_reader");
+      outputfile->Close();
 
-        splwrite->ReconfigureSet(iset);
+      // Delete Inputs
+      delete input;
+      continue;
+    }
 
-        // Could reorder this to save the weightconts in order instead of
-        // reconfiguring per event. Loop over all events and fill the TTree
-        for (int i = 0; i < neventsinchunk; i++) {
+    // Fork the workers over contiguous event ranges
+    std::vector<std::string> workerfiles;
+    std::vector<pid_t> workerpids;
+    int neventsperworker = (lastevent - firstevent) / nworkers;
+    for (int w = 0; w < nworkers; w++) {
+      workerfiles.push_back(outputfilename + Form(".worker%i.root", w));
+      int workerfirst = firstevent + w * neventsperworker;
+      int workerlast =
+          (w == nworkers - 1) ? lastevent : workerfirst + neventsperworker;
 
-          nuisevent = input->GetNuisanceEvent(i + loweventinchunk);
-          double w = splwrite->GetWeightForThisSet(nuisevent);
+      pid_t pid = fork();
+      if (pid < 0) {
+        NUIS_ABORT("Failed to fork weight worker " << w);
+      }
 
-          if (iset == 0) {
-            allweightcont[i][0] = w;
-          } else {
-            allweightcont[i][iset] = w / allweightcont[i][0];
-          }
+      if (pid == 0) {
+        // The parent's handler shares file offsets with us, open our own
+        InputHandlerBase *workerinput = InputUtils::CreateInputHandler(
+            "eventsaver", inptype, file_descriptor[1]);
 
-          // Save everything
-          if (iset == 0) {
-            eventtree->Fill();
-          }
-        }
+        TFile *workerfile = new TFile(workerfiles[w].c_str(), "RECREATE");
+        FillEventWeights(workerinput, splwrite, workerfile, workerfirst,
+                         workerlast);
+        workerfile->Close();
 
-        std::ostringstream timestring;
-        int timeelapsed = time(NULL) - lasttime;
-        if (timeelapsed) {
-          lasttime = time(NULL);
+        // Skip the parent's exit handlers and open files
+        _exit(0);
+      }
 
-          int setsleft =
-              (nweights - iset - 1) + (nweights * (nchunks - ichunk - 1));
-          float proj = (float(setsleft) * timeelapsed) / 60 / 60;
-          timestring << setsleft << " sets remaining. Last one took "
-                     << timeelapsed << ". " << proj << " hours remaining.";
-        }
+      workerpids.push_back(pid);
+    }
 
-        NUIS_LOG(REC, "Processed Set " << iset << "/" << nweights << " in chunk "
-                                   << ichunk << "/" << nchunks << " "
-                                   << timestring.str());
+    for (int w = 0; w < nworkers; w++) {
+      int status = 0;
+      waitpid(workerpids[w], &status, 0);
+      if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        NUIS_ABORT("Weight worker " << w << " (pid " << workerpids[w]
+                                    << ") did not finish cleanly.");
       }
+    }
 
-      // Fill weights for this chunk into the TTree
-      for (int k = 0; k < neventsinchunk; k++) {
-        splwrite->SetWeights(allweightcont[k]);
-        weighttree->Fill();
+    // Append the worker trees in event order
+    NUIS_LOG(FIT, "Merging event weights from " << nworkers << " workers");
+    std::vector<TFile *> infiles;
+    TList eventtrees;
+    TList weighttrees;
+    for (int w = 0; w < nworkers; w++) {
+      TFile *infile = new TFile(workerfiles[w].c_str(), "READ");
+      if (!infile || infile->IsZombie()) {
+        NUIS_ABORT("Could not open weight worker output " << workerfiles[w]);
       }
+      infiles.push_back(infile);
+      eventtrees.Add(infile->Get("nuisance_events"));
+      weighttrees.Add(infile->Get("weight_tree"));
     }
 
-    // at end of the chunk, when all sets have been done
-    // loop over the container and fill weights to ttree
-
+    TFile *outputfile = new TFile(outputfilename.c_str(), "RECREATE");
     outputfile->cd();
+    TTree *eventtree = TTree::MergeTrees(&eventtrees);
+    eventtree->SetName("nuisance_events");
     eventtree->Write();
+    TTree *weighttree = TTree::MergeTrees(&weighttrees);
+    weighttree->SetName("weight_tree");
     weighttree->Write();
+
     input->GetFluxHistogram()->Write("nuisance_fluxhist");
     input->GetEventHistogram()->Write("nuisance_eventhist");
     splwrite->Write("spline_reader");
     outputfile->Close();
 
-    // Close Output
-    outputfile->Close();
+    for (int w = 0; w < nworkers; w++) {
+      infiles[w]->Close();
+      delete infiles[w];
+      gSystem->Unlink(workerfiles[w].c_str());
+    }
 
     // Delete Inputs
     delete input;
@@ -581,6 +587,58 @@ void SplineRoutines::GenerateEventWeightChunks(int procchunk) {
   eventkeys.clear();
 }
 
+void SplineRoutines::FillEventWeights(InputHandlerBase *input,
+                                      SplineWriter *splwrite,
+                                      TFile *outputfile, int firstevent,
+                                      int lastevent) {
+  FitEvent *nuisevent = input->GetNuisanceEvent(firstevent);
+
+  // Setup a TTree to save the event
+  outputfile->cd();
+  TTree *eventtree = new TTree("nuisance_events", "nuisance_events");
+  nuisevent->AddBranchesToTree(eventtree);
+
+  // Setup the spline TTree
+  TTree *weighttree = new TTree("weight_tree", "weight_tree");
+  splwrite->AddWeightsToTree(weighttree);
+
+  int nevents = lastevent - firstevent;
+  int countwidth = std::max(1, nevents / 100);
+  int lasttime = time(NULL);
+
+  // Event-major: each event is read and converted once and then weighted
+  // for every parameter set before moving on.
+  for (int i = firstevent; i < lastevent; i++) {
+    nuisevent = input->GetNuisanceEvent(i);
+    splwrite->GetWeightsForEvent(nuisevent);
+
+    eventtree->Fill();
+    weighttree->Fill();
+
+    // Logging
+    int ndone = i - firstevent;
+    if (ndone % countwidth == 0) {
+      std::ostringstream timestring;
+      int timeelapsed = time(NULL) - lasttime;
+      if (ndone != 0 and timeelapsed) {
+        lasttime = time(NULL);
+
+        int eventsleft = nevents - ndone;
+        float speed = float(countwidth) / float(timeelapsed);
+        float proj = (float(eventsleft) / float(speed)) / 60 / 60;
+        timestring << proj << " hours remaining.";
+      }
+      NUIS_LOG(REC, "Saved " << ndone << "/" << nevents
+                             << " nuisance spline weights. "
+                             << timestring.str());
+    }
+  }
+
+  outputfile->cd();
+  eventtree->Write();
+  weighttree->Write();
+}
+
 //*************************************
 void SplineRoutines::GenerateEventWeights() {
   //*************************************
@@ -32,6 +32,7 @@
 #include "TSystem.h"
 #include "TFile.h"
 #include "TProfile.h"
+#include "TList.h"
 
 
 #include <vector>
@@ -39,6 +40,9 @@
 #include <iostream>
 #include <sstream>
 #include <cstring>
+#include <algorithm>
+#include <sys/wait.h>
+#include <unistd.h>
 
 #include "FitEvent.h"
 #include "JointFCN.h"
@@ -105,6 +109,10 @@ public:
   void GenerateEventSplines();
   void GenerateEventWeights();
   void GenerateEventWeightChunks(int procchunk = -1);
+  //! Weight every parameter set for events [firstevent, lastevent) of input
+  //! and write the nuisance_events and weight_tree trees to outputfile.
+  void FillEventWeights(InputHandlerBase* input, SplineWriter* splwrite,
+                        TFile* outputfile, int firstevent, int lastevent);
   void BuildEventSplines(int procchunk = -1);
   void MergeEventSplinesChunks();
   /* 
@@ -878,6 +878,10 @@ void SystematicRoutines::Run() {
       break;
     }
   }
+
+  if (fSampleFCN) {
+    fSampleFCN->GetStageTimer().PrintSummary();
+  }
 }
 
 void SystematicRoutines::GenerateErrorBands() {
@@ -905,18 +909,37 @@ void SystematicRoutines::GenerateThrows() {
   if (endthrows < 0)
     endthrows = startthrows + nthrows;
 
+  int nworkers = Config::GetParI("error_throw_workers");
+  if (nworkers < 1)
+    nworkers = 1;
+
+  // Forked throw workers would share the FCN's worker connections
+  if (nworkers > 1 && fSampleFCN->IsDistributed()) {
+    NUIS_ERR(WRN, "error_throw_workers is ignored with DistributedWorkers, "
+                  "running the throws serially.");
+    nworkers = 1;
+  }
+
   // Setting Seed
-  // Matteo Mazzanti's Fix
-  struct timeval mytime;
-  gettimeofday(&mytime, NULL);
-  Double_t seed = time(NULL) + int(getpid()) + (mytime.tv_sec * 1000.) +
-                  (mytime.tv_usec / 1000.);
-  gRandom->SetSeed(seed);
-
-  NUIS_LOG(FIT, "Using Seed : " << seed);
+  // Each throw reseeds gRandom from the master seed and its index, so a
+  // given error_seed reproduces the same throws for any number of workers
+  // or -s offset.
+  ULong64_t masterseed = Config::GetParI("error_seed");
+  if (masterseed == 0) {
+    // Matteo Mazzanti's Fix
+    struct timeval mytime;
+    gettimeofday(&mytime, NULL);
+    Double_t seed = time(NULL) + int(getpid()) + (mytime.tv_sec * 1000.) +
+                    (mytime.tv_usec / 1000.);
+    masterseed = ULong64_t(seed);
+  }
+  gRandom->SetSeed(GetThrowSeed(masterseed, 0));
+
+  NUIS_LOG(FIT, "Using Seed : " << masterseed);
   NUIS_LOG(FIT, "nthrows = " << nthrows);
   NUIS_LOG(FIT, "startthrows = " << startthrows);
   NUIS_LOG(FIT, "endthrows = " << endthrows);
+  NUIS_LOG(FIT, "nworkers = " << nworkers);
 
   UpdateRWEngine(fStartVals);
   fSampleFCN->ReconfigureAllEvents();
@@ -942,19 +965,81 @@ void SystematicRoutines::GenerateThrows() {
   // Would anybody actually want to do uniform throws of any parameter??
   bool uniformly = FitPar::Config().GetParB("error_uniform");
 
+  if (nworkers == 1) {
+    RunThrows(tempfile, startthrows, endthrows, 0, 1, uniformly, masterseed);
+
+    tempfile->cd();
+    fSampleFCN->WriteIterationTree();
+    tempfile->Close();
+    return;
+  }
+
+  // Fork the workers. Each one gets a copy of the loaded samples and writes
+  // its share of the throws to its own file, which are merged below.
+  tempfile->Flush();
+  std::vector<std::string> workerfiles;
+  std::vector<pid_t> workerpids;
+  for (int w = 0; w < nworkers; w++) {
+    workerfiles.push_back(fOutputFile + Form(".throws.worker%i.root", w));
+
+    pid_t pid = fork();
+    if (pid < 0) {
+      NUIS_ABORT("Failed to fork throw worker " << w);
+    }
+
+    if (pid == 0) {
+      // OpenMP thread pools do not survive fork, keep the worker serial
+      fSampleFCN->SetNThreads(1);
+
+      TFile *workerfile = new TFile(workerfiles[w].c_str(), "RECREATE");
+      RunThrows(workerfile, startthrows, endthrows, w, nworkers, uniformly,
+                masterseed);
+
+      workerfile->cd();
+      fSampleFCN->WriteIterationTree();
+      workerfile->Close();
+
+      // Skip the parent's exit handlers and open files
+      _exit(0);
+    }
+
+    workerpids.push_back(pid);
+  }
+
+  for (int w = 0; w < nworkers; w++) {
+    int status = 0;
+    waitpid(workerpids[w], &status, 0);
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+      NUIS_ABORT("Throw worker " << w << " (pid " << workerpids[w]
+                                 << ") did not finish cleanly.");
+    }
+  }
+
+  MergeWorkerThrows(tempfile, workerfiles, startthrows, endthrows);
+  tempfile->Close();
+}
+
+//*************************************
+void SystematicRoutines::RunThrows(TFile *outfile, int startthrows,
+                                   int endthrows, int worker, int nworkers,
+                                   bool uniformly, ULong64_t masterseed) {
+  //*************************************
+
   // Run Throws and save
   for (Int_t i = 0; i < endthrows + 1; i++) {
 
     if (i < startthrows) continue;
     if (i == 0) continue;
+    if (i % nworkers != worker) continue;
     NUIS_LOG(FIT, "Throw " << i << "/" << endthrows
                        << " ================================");
 
     TDirectory *throwfolder =
-        (TDirectory *)tempfile->mkdir(Form("throw_%i", i));
+        (TDirectory *)outfile->mkdir(Form("throw_%i", i));
     throwfolder->cd();
 
     // Generate Random Parameter Throw
+    gRandom->SetSeed(GetThrowSeed(masterseed, i));
     ThrowCovariance(uniformly);
 
     // Run Eval
@@ -965,10 +1050,158 @@ void SystematicRoutines::GenerateThrows() {
     // Save the FCN
     fSampleFCN->Write();
   }
+}
 
-  tempfile->cd();
-  fSampleFCN->WriteIterationTree();
-  tempfile->Close();
+// Copy every object in from into to, recursing into sub-directories.
+static void CopyDirectoryContents(TDirectory *from, TDirectory *to) {
+  std::set<std::string> copied;
+
+  TIter next(from->GetListOfKeys());
+  TKey *key;
+  while ((key = (TKey *)next())) {
+
+    // Keys are ordered newest cycle first, only keep that one
+    std::string name = key->GetName();
+    if (copied.count(name))
+      continue;
+    copied.insert(name);
+
+    TClass *cl = gROOT->GetClass(key->GetClassName());
+    if (cl && cl->InheritsFrom("TDirectory")) {
+      TDirectory *subdir = to->mkdir(name.c_str());
+      CopyDirectoryContents((TDirectory *)key->ReadObj(), subdir);
+      continue;
+    }
+
+    TObject *obj = key->ReadObj();
+    to->cd();
+    if (cl && cl->InheritsFrom("TTree")) {
+      TTree *tree = ((TTree *)obj)->CloneTree(-1, "fast");
+      tree->Write(name.c_str());
+      delete tree;
+    } else {
+      obj->Write(name.c_str());
+    }
+    delete obj;
+  }
+}
+
+//*************************************
+void SystematicRoutines::MergeWorkerThrows(TFile *outfile,
+                                           std::vector<std::string> workerfiles,
+                                           int startthrows, int endthrows) {
+  //*************************************
+
+  int nworkers = workerfiles.size();
+  std::vector<TFile *> infiles;
+  for (int w = 0; w < nworkers; w++) {
+    TFile *infile = new TFile(workerfiles[w].c_str(), "READ");
+    if (!infile || infile->IsZombie()) {
+      NUIS_ABORT("Could not open throw worker output " << workerfiles[w]);
+    }
+    infiles.push_back(infile);
+  }
+
+  // Copy in throw order so the output matches a single process run
+  NUIS_LOG(FIT, "Merging throws from " << nworkers << " workers");
+  for (Int_t i = 0; i < endthrows + 1; i++) {
+    if (i < startthrows) continue;
+    if (i == 0) continue;
+
+    std::string dirname = Form("throw_%i", i);
+    TDirectory *indir =
+        (TDirectory *)infiles[i % nworkers]->Get(dirname.c_str());
+    if (!indir) {
+      NUIS_ERR(WRN, "Missing " << dirname << " in " << workerfiles[i % nworkers]);
+      continue;
+    }
+
+    CopyDirectoryContents(indir, outfile->mkdir(dirname.c_str()));
+  }
+
+  // Iteration trees are interleaved back into throw order too. Entry k of a
+  // worker's tree is its k-th throw, as every throw is one evaluation.
+  std::vector<TTree *> itrees(nworkers, NULL);
+  for (int w = 0; w < nworkers; w++) {
+    itrees[w] = (TTree *)infiles[w]->Get("error_iterations");
+  }
+
+  if (itrees[0]) {
+    std::vector<std::string> names;
+    TObjArray *branches = itrees[0]->GetListOfBranches();
+    for (int b = 0; b < branches->GetEntries(); b++) {
+      std::string name = branches->At(b)->GetName();
+      if (name != "iteration")
+        names.push_back(name);
+    }
+
+    int iteration = 0;
+    std::vector<double> vals(names.size(), 0.0);
+
+    outfile->cd();
+    TTree *merged = new TTree("error_iterations", "error_iterations");
+    merged->Branch("iteration", &iteration, "Iteration/I");
+    for (size_t b = 0; b < names.size(); b++) {
+      merged->Branch(names[b].c_str(), &vals[b], (names[b] + "/D").c_str());
+    }
+
+    for (int w = 0; w < nworkers; w++) {
+      if (!itrees[w])
+        continue;
+      itrees[w]->SetBranchAddress("iteration", &iteration);
+      for (size_t b = 0; b < names.size(); b++) {
+        itrees[w]->SetBranchAddress(names[b].c_str(), &vals[b]);
+      }
+    }
+
+    std::vector<Long64_t> nextentry(nworkers, 0);
+    int position = 0;
+    for (Int_t i = 0; i < endthrows + 1; i++) {
+      if (i < startthrows) continue;
+      if (i == 0) continue;
+
+      int w = i % nworkers;
+      if (!itrees[w] || nextentry[w] >= itrees[w]->GetEntries()) {
+        NUIS_ERR(WRN, "Missing iteration for throw " << i << " in "
+                                                     << workerfiles[w]);
+        continue;
+      }
+      itrees[w]->GetEntry(nextentry[w]);
+
+      // Every worker counts iterations on from the same point, renumber
+      // them as a single process would have
+      iteration += position - nextentry[w];
+      nextentry[w]++;
+      position++;
+
+      merged->Fill();
+    }
+
+    merged->Write();
+    delete merged;
+  }
+
+  for (int w = 0; w < nworkers; w++) {
+    infiles[w]->Close();
+    delete infiles[w];
+    gSystem->Unlink(workerfiles[w].c_str());
+  }
+}
+
+//*************************************
+UInt_t SystematicRoutines::GetThrowSeed(ULong64_t masterseed,
+                                        int throwindex) {
+  //*************************************
+
+  // SplitMix64 finaliser, so neighbouring throw indices give unrelated seeds
+  ULong64_t z = masterseed + 0x9E3779B97F4A7C15ULL * ULong64_t(throwindex + 1);
+  z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+  z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+  z = z ^ (z >> 31);
+
+  // TRandom3 treats a zero seed as a request for a random one
+  UInt_t seed = UInt_t(z & 0xFFFFFFFFULL);
+  return seed ? seed : 1;
 }
 
 // Merge throws together into one summary
@@ -32,8 +32,14 @@
 #include "TSystem.h"
 #include "TFile.h"
 #include "TProfile.h"
+#include "TKey.h"
+#include "TList.h"
+#include "TTree.h"
 
 #include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <set>
 #include <vector>
 #include <string>
 #include <iostream>
@@ -165,8 +171,26 @@ void SetupSystematicsFromXML();
   //! Currently only supports TH1D plots.
   void GenerateErrorBands();
   
+  //! Generate the throw_%i folders used by MergeThrows.
+  //! The FitPar config "error_throw_workers" sets how many forked worker
+  //! processes share the throws, and "error_seed" the master seed each
+  //! throw's RNG seed is derived from (time based if 0).
   void GenerateThrows();
   void MergeThrows();
+
+  //! Run the throws in [startthrows, endthrows] assigned to this worker,
+  //! writing each one into a throw_%i folder of outfile.
+  void RunThrows(TFile *outfile, int startthrows, int endthrows, int worker,
+                 int nworkers, bool uniformly, ULong64_t masterseed);
+
+  //! Copy the throw folders and iteration trees from the worker files into
+  //! outfile, keeping the same layout as a single process run.
+  void MergeWorkerThrows(TFile *outfile, std::vector<std::string> workerfiles,
+                         int startthrows, int endthrows);
+
+  //! Derive an independent, reproducible RNG seed for a throw index
+  static UInt_t GetThrowSeed(ULong64_t masterseed, int throwindex);
+
   //! Step through each parameter one by one and create folders containing the MC predictions at each step.
   //! Doesn't handle correlated parameters well
   void PlotLimits();
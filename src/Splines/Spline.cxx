@@ -10,6 +10,7 @@ Spline::Spline(std::string splname, std::string form, std::string points) {
   fForm = form;
   fPoints = points;
   fROOTFunction = NULL;
+  fOutsideLimits = false;
 
   // Setup Min Max for each Parameter
   fSplitNames = GeneralUtils::ParseToStr(splname, ";");
@@ -37,14 +38,6 @@ Spline::Spline(std::string splname, std::string form, std::string points) {
     fVal.push_back(0.0);
     fValMin.push_back(xmin);
     fValMax.push_back(xmax);
-
-    // Define TSpline3 1D iterators here
-    if (i == 0) {
-      iter_low = fXScan.begin();
-      iter_high = fXScan.begin();
-      iter_high++;
-      off = 0;
-    }
   }
 
   // Set form from list
@@ -77,6 +70,10 @@ Spline::Spline(std::string splname, std::string form, std::string points) {
     NUIS_ABORT("Spline Dim:Names mismatch!");
   }
 
+  fKnotOffset = 0;
+  fKnotDX = 0.0;
+  UpdateKnot();
+
   NUIS_LOG(SAM, "Setup Spline " << fForm << " = " << fType << " " << fNPar);
 };
 
@@ -94,11 +91,33 @@ void Spline::Reconfigure(float x, int index) {
   fVal[index] = x;
   fOutsideLimits = false;
 
-  if (fVal[index] > fValMax[index])
+  // The weight is held flat outside the scanned range
+  if (fVal[index] > fValMax[index]) {
     fVal[index] = fValMax[index];
-  if (fVal[index] < fValMin[index])
+    fOutsideLimits = true;
+  }
+  if (fVal[index] < fValMin[index]) {
     fVal[index] = fValMin[index];
+    fOutsideLimits = true;
+  }
   // std::cout << "Set at edge = " << fVal[index] << " " << index << std::endl;
+
+  UpdateKnot();
+}
+
+void Spline::UpdateKnot() const {
+  if (fType != k1DTSpline3 or fXScan.empty())
+    return;
+
+  // Find matching point, stopping on the final knot if beyond the scan.
+  size_t knot = 0;
+  while (knot + 1 < fXScan.size() and
+         (fVal[0] < fXScan[knot] or fVal[0] >= fXScan[knot + 1])) {
+    knot++;
+  }
+
+  fKnotOffset = knot * 4;
+  fKnotDX = fVal[0] - fXScan[knot];
 }
 
 void Spline::Reconfigure(std::string name, float x) {
@@ -175,6 +194,7 @@ float Spline::DoEval(const Float_t *x, const Float_t *par) const {
     if (fVal[i] < fValMin[i])
       fVal[i] = fValMin[i];
   }
+  UpdateKnot();
 
   double w = DoEval(&par[0], false);
 
@@ -246,6 +266,128 @@ float Spline::DoEval(const Float_t *par, bool checkresponse) const {
   return 1.0;
 };
 
+void Spline::DoEvalColumns(const float *const *coeff, size_t n,
+                           float *w) const {
+
+  switch (fType) {
+  case k1DPol1:
+  case k1DPol2:
+  case k1DPol3:
+  case k1DPol4:
+  case k1DPol5:
+  case k1DPol6: {
+    // Horner's rule across the columns, highest order first.
+    const float xp = fVal[0];
+    const float *c = coeff[fNPar - 1];
+    for (size_t e = 0; e < n; e++) {
+      w[e] = c[e];
+    }
+    for (int i = fNPar - 2; i >= 0; i--) {
+      c = coeff[i];
+#ifdef __USE_OPENMP__
+#pragma omp simd
+#endif
+      for (size_t e = 0; e < n; e++) {
+        w[e] = w[e] * xp + c[e];
+      }
+    }
+    return;
+  }
+  case k1DTSpline3: {
+    // The dial value is shared by every event so the knot is found once.
+    const float dx = fKnotDX;
+    const float *c0 = coeff[fKnotOffset];
+    const float *c1 = coeff[fKnotOffset + 1];
+    const float *c2 = coeff[fKnotOffset + 2];
+    const float *c3 = coeff[fKnotOffset + 3];
+#ifdef __USE_OPENMP__
+#pragma omp simd
+#endif
+    for (size_t e = 0; e < n; e++) {
+      w[e] = c0[e] + dx * (c1[e] + dx * (c2[e] + dx * c3[e]));
+    }
+    return;
+  }
+  }
+
+  std::vector<float> par(fNPar);
+  for (size_t e = 0; e < n; e++) {
+    for (int i = 0; i < fNPar; i++) {
+      par[i] = coeff[i][e];
+    }
+    w[e] = DoEval(&par[0], false);
+  }
+}
+
+bool Spline::HasColumnDerivative() const {
+  switch (fType) {
+  case k1DPol1:
+  case k1DPol2:
+  case k1DPol3:
+  case k1DPol4:
+  case k1DPol5:
+  case k1DPol6:
+  case k1DTSpline3:
+    return true;
+  }
+  return false;
+}
+
+void Spline::DoEvalColumnsDerivative(const float *const *coeff, size_t n,
+                                     float *w, float *dw) const {
+
+  switch (fType) {
+  case k1DPol1:
+  case k1DPol2:
+  case k1DPol3:
+  case k1DPol4:
+  case k1DPol5:
+  case k1DPol6: {
+    // Horner's rule for the polynomial and its derivative together.
+    const float xp = fVal[0];
+    const float *c = coeff[fNPar - 1];
+    for (size_t e = 0; e < n; e++) {
+      w[e] = c[e];
+      dw[e] = 0.0;
+    }
+    for (int i = fNPar - 2; i >= 0; i--) {
+      c = coeff[i];
+#ifdef __USE_OPENMP__
+#pragma omp simd
+#endif
+      for (size_t e = 0; e < n; e++) {
+        dw[e] = dw[e] * xp + w[e];
+        w[e] = w[e] * xp + c[e];
+      }
+    }
+    break;
+  }
+  case k1DTSpline3: {
+    const float dx = fKnotDX;
+    const float *c0 = coeff[fKnotOffset];
+    const float *c1 = coeff[fKnotOffset + 1];
+    const float *c2 = coeff[fKnotOffset + 2];
+    const float *c3 = coeff[fKnotOffset + 3];
+#ifdef __USE_OPENMP__
+#pragma omp simd
+#endif
+    for (size_t e = 0; e < n; e++) {
+      w[e] = c0[e] + dx * (c1[e] + dx * (c2[e] + dx * c3[e]));
+      dw[e] = c1[e] + dx * (2.0f * c2[e] + 3.0f * dx * c3[e]);
+    }
+    break;
+  }
+  default:
+    NUIS_ABORT("No analytic derivative for spline form : " << fForm);
+  }
+
+  if (fOutsideLimits) {
+    for (size_t e = 0; e < n; e++) {
+      dw[e] = 0.0;
+    }
+  }
+}
+
 // Spline Functions
 // ----------------------------------------------
 
@@ -292,25 +434,10 @@ float Spline::Spline1DPol6(const Float_t *par) const {
 
 float Spline::Spline1DTSpline3(const Float_t *par) const {
 
-  // Find matching point
-  iter_low = fXScan.begin();
-  iter_high = fXScan.begin();
-  iter_high++;
-  off = 0;
-  fX = fVal[0];
-
-  while (iter_high != fXScan.end() and
-         (fX < (*iter_low) or fX >= (*iter_high))) {
-    off += 4;
-    iter_low++;
-    iter_high++;
-  }
-
-  float dx = fX - (*iter_low);
-  float weight = (par[off] + dx * (par[off + 1] +
-                                   dx * (par[off + 2] + dx * par[off + 3])));
-
-  return weight;
+  // Knot found in UpdateKnot
+  const Float_t *p = par + fKnotOffset;
+  float dx = fKnotDX;
+  return p[0] + dx * (p[1] + dx * (p[2] + dx * p[3]));
 };
 
 // 2D Functions
@@ -390,19 +517,19 @@ float Spline::Spline2DGaus(const Float_t *par) const {
 float Spline::Spline2DTSpline3(const Float_t *par) const {
 
   // Find matching point
-  std::vector<float>::iterator iter_low_x = fXScan.begin();
-  std::vector<float>::iterator iter_high_x = fXScan.begin();
-  std::vector<float>::iterator iter_low_y = fYScan.begin();
-  std::vector<float>::iterator iter_high_y = fYScan.begin();
+  std::vector<float>::const_iterator iter_low_x = fXScan.begin();
+  std::vector<float>::const_iterator iter_high_x = fXScan.begin();
+  std::vector<float>::const_iterator iter_low_y = fYScan.begin();
+  std::vector<float>::const_iterator iter_high_y = fYScan.begin();
   iter_high_x++;
   iter_high_y++;
 
-  off = 0;
-  fX = fVal[0];
-  fY = fVal[1];
+  int off = 0;
+  float fX = fVal[0];
+  float fY = fVal[1];
 
   while ((iter_high_x != fXScan.end() and iter_high_y != fYScan.end()) and
-         (fX < (*iter_low_y) or fX >= (*iter_high) or fY < (*iter_low_y) or
+         (fX < (*iter_low_y) or fX >= (*iter_high_x) or fY < (*iter_low_y) or
           fY >= (*iter_low_y))) {
     off += 9;
     iter_low_x++;
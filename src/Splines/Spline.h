@@ -60,6 +60,19 @@ public:
   float DoEval(const Float_t* x, const Float_t* par) const;
   float DoEval(const Float_t* par, bool checkresponse = true) const;
 
+  /// Evaluate n events at once. coeff[i] points to the n values of
+  /// parameter i. No response check is applied. Forms without a
+  /// vectorised kernel fall back to DoEval event by event.
+  void DoEvalColumns(const float* const* coeff, size_t n, float* w) const;
+
+  /// As DoEvalColumns, also filling dw with the derivative of each weight
+  /// with respect to the dial. Only valid if HasColumnDerivative().
+  void DoEvalColumnsDerivative(const float* const* coeff, size_t n, float* w,
+                               float* dw) const;
+
+  /// Whether DoEvalColumnsDerivative supports this form
+  bool HasColumnDerivative() const;
+
   //  void FitCoeff(int n, double* x, double* y, double* par, bool draw);
   void FitCoeff(std::vector< std::vector<double> > v, std::vector<double> w, float* coeff, bool draw);
 
@@ -105,21 +118,20 @@ public:
   mutable std::vector< std::vector<float> > fSplitScan;
 
   mutable std::vector<float> fXScan;
-  mutable float fX;
   mutable float fXMin;
   mutable float fXMax;
 
   mutable std::vector<float> fYScan;
-  mutable float fY;
   mutable float fYMin;
   mutable float fYMax;
 
   int  fSplineOffset;
 
-  // TSpline3 Objects.
-  mutable std::vector<float>::iterator iter_low;
-  mutable std::vector<float>::iterator iter_high;
-  mutable int off;
+  // TSpline3 knot interval for the current dial value. Updated whenever
+  // fVal changes so per-event evaluation is a plain polynomial.
+  mutable int fKnotOffset;
+  mutable float fKnotDX;
+  void UpdateKnot() const;
 
   // Create a new function for fitting.
   ROOT::Math::Minimizer* minimizer;
@@ -0,0 +1,228 @@
+#include "SplineCoeffStore.h"
+
+#include <algorithm>
+#include <iterator>
+#include <stdlib.h>
+#include <string.h>
+
+// Columns are padded and aligned to a cache line so every column starts on
+// a vector boundary.
+#define SPLINECOEFF_ALIGN 64
+#define SPLINECOEFF_PAD 16
+// Events evaluated per pass, small enough to keep the scratch in L1.
+#define SPLINECOEFF_TILE 1024
+
+static float *AllocColumns(size_t n) {
+  if (!n)
+    return NULL;
+  void *mem = NULL;
+  if (posix_memalign(&mem, SPLINECOEFF_ALIGN, n * sizeof(float))) {
+    NUIS_ABORT("Failed to allocate " << n * sizeof(float)
+                                     << " bytes for spline coefficients.");
+  }
+  memset(mem, 0, n * sizeof(float));
+  return static_cast<float *>(mem);
+}
+
+SplineCoeffStore::SplineCoeffStore(SplineReader *reader) {
+  fReader = reader;
+  fNEvents = 0;
+  fStride = 0;
+  fCoeff = NULL;
+  fResponse = NULL;
+
+  fNSplines = fReader->fAllSplines.size();
+  fNCoeff = fReader->GetNPar();
+  fOffsets = fReader->fOffsets;
+  fOffsets.push_back(fNCoeff);
+}
+
+SplineCoeffStore::~SplineCoeffStore() { Clear(); }
+
+void SplineCoeffStore::Clear() {
+  free(fCoeff);
+  free(fResponse);
+  fCoeff = NULL;
+  fResponse = NULL;
+  fNEvents = 0;
+  fStride = 0;
+}
+
+void SplineCoeffStore::Fill(
+    std::vector<std::vector<float> >::const_iterator first,
+    std::vector<std::vector<float> >::const_iterator last) {
+  Clear();
+
+  fNEvents = std::distance(first, last);
+  fStride = (fNEvents + SPLINECOEFF_PAD - 1) / SPLINECOEFF_PAD *
+            SPLINECOEFF_PAD;
+  fCoeff = AllocColumns(fNCoeff * fStride);
+  fResponse = AllocColumns(fNSplines * fStride);
+
+  size_t ievt = 0;
+  for (; first != last; first++, ievt++) {
+    if ((int)first->size() != fNCoeff) {
+      NUIS_ABORT("Spline coefficient row has " << first->size()
+                                               << " entries, reader expects "
+                                               << fNCoeff);
+    }
+
+    for (int i = 0; i < fNCoeff; i++) {
+      fCoeff[i * fStride + ievt] = (*first)[i];
+    }
+
+    // Splines with all zero coefficients are treated as having no
+    // response, as in Spline::DoEval. Coefficients never change so this
+    // is decided once here.
+    for (int s = 0; s < fNSplines; s++) {
+      bool hasresponse = false;
+      for (int i = fOffsets[s]; i < fOffsets[s + 1]; i++) {
+        if ((*first)[i] != 0.0) {
+          hasresponse = true;
+          break;
+        }
+      }
+      fResponse[s * fStride + ievt] = hasresponse ? 1.0 : 0.0;
+    }
+  }
+}
+
+void SplineCoeffStore::GetEventCoeff(size_t ievt, float *coeff) const {
+  for (int i = 0; i < fNCoeff; i++) {
+    coeff[i] = fCoeff[i * fStride + ievt];
+  }
+}
+
+void SplineCoeffStore::CalcWeights(double *weights, size_t first,
+                                   size_t last) const {
+
+  std::vector<float> splweight(SPLINECOEFF_TILE);
+  std::vector<const float *> cols(fNCoeff > 0 ? fNCoeff : 1);
+
+  for (size_t start = first; start < last; start += SPLINECOEFF_TILE) {
+    size_t n = std::min<size_t>(SPLINECOEFF_TILE, last - start);
+    double *w = weights + (start - first);
+
+    for (size_t e = 0; e < n; e++) {
+      w[e] = 1.0;
+    }
+
+    for (int s = 0; s < fNSplines; s++) {
+      int npar = fOffsets[s + 1] - fOffsets[s];
+      for (int i = 0; i < npar; i++) {
+        cols[i] = Column(fOffsets[s] + i) + start;
+      }
+
+      fReader->fAllSplines[s].DoEvalColumns(&cols[0], n, &splweight[0]);
+
+      const float *resp = fResponse + s * fStride + start;
+      float *sw = &splweight[0];
+#ifdef __USE_OPENMP__
+#pragma omp simd
+#endif
+      for (size_t e = 0; e < n; e++) {
+        w[e] *= (resp[e] != 0.0f) ? sw[e] : 1.0f;
+      }
+    }
+
+    // Match SplineReader::CalcWeight for unphysical weights
+    for (size_t e = 0; e < n; e++) {
+      if (w[e] <= 0.0)
+        w[e] = 1.0;
+    }
+  }
+}
+
+void SplineCoeffStore::CalcWeightDerivatives(
+    double *weights, double *const *derivs,
+    std::vector<std::vector<int> > const &dialsplines, size_t first,
+    size_t last) const {
+
+  // Splines that move with one of the dials keep their per event values so
+  // the product of the others can be formed for the derivative.
+  size_t ndials = dialsplines.size();
+  std::vector<int> slot(fNSplines, -1);
+  int nslots = 0;
+  for (size_t k = 0; k < ndials; k++) {
+    for (size_t i = 0; i < dialsplines[k].size(); i++) {
+      int s = dialsplines[k][i];
+      if (slot[s] == -1)
+        slot[s] = nslots++;
+    }
+  }
+
+  std::vector<float> splweight(SPLINECOEFF_TILE);
+  std::vector<float> values(nslots * SPLINECOEFF_TILE);
+  std::vector<float> slopes(nslots * SPLINECOEFF_TILE);
+  std::vector<const float *> cols(fNCoeff > 0 ? fNCoeff : 1);
+
+  for (size_t start = first; start < last; start += SPLINECOEFF_TILE) {
+    size_t n = std::min<size_t>(SPLINECOEFF_TILE, last - start);
+    double *w = weights + (start - first);
+
+    for (size_t e = 0; e < n; e++) {
+      w[e] = 1.0;
+    }
+
+    for (int s = 0; s < fNSplines; s++) {
+      int npar = fOffsets[s + 1] - fOffsets[s];
+      for (int i = 0; i < npar; i++) {
+        cols[i] = Column(fOffsets[s] + i) + start;
+      }
+
+      const float *resp = fResponse + s * fStride + start;
+      if (slot[s] == -1) {
+        fReader->fAllSplines[s].DoEvalColumns(&cols[0], n, &splweight[0]);
+        for (size_t e = 0; e < n; e++) {
+          w[e] *= (resp[e] != 0.0f) ? splweight[e] : 1.0f;
+        }
+        continue;
+      }
+
+      float *val = &values[slot[s] * SPLINECOEFF_TILE];
+      float *slope = &slopes[slot[s] * SPLINECOEFF_TILE];
+      fReader->fAllSplines[s].DoEvalColumnsDerivative(&cols[0], n, val, slope);
+      for (size_t e = 0; e < n; e++) {
+        if (resp[e] == 0.0f) {
+          val[e] = 1.0f;
+          slope[e] = 0.0f;
+        }
+        w[e] *= val[e];
+      }
+    }
+
+    // d/dx prod_j S_j = sum over the dial's splines of S'_s prod_{j!=s} S_j.
+    // A zero S_s makes the product zero, which is reset to one below with
+    // no derivative, so dividing it out is safe.
+    for (size_t k = 0; k < ndials; k++) {
+      double *d = derivs[k] + (start - first);
+      for (size_t e = 0; e < n; e++) {
+        d[e] = 0.0;
+      }
+      for (size_t i = 0; i < dialsplines[k].size(); i++) {
+        int s = dialsplines[k][i];
+        const float *val = &values[slot[s] * SPLINECOEFF_TILE];
+        const float *slope = &slopes[slot[s] * SPLINECOEFF_TILE];
+        for (size_t e = 0; e < n; e++) {
+          if (val[e] != 0.0f)
+            d[e] += slope[e] * (w[e] / val[e]);
+        }
+      }
+    }
+
+    // Match SplineReader::CalcWeight for unphysical weights
+    for (size_t e = 0; e < n; e++) {
+      if (w[e] <= 0.0) {
+        w[e] = 1.0;
+        for (size_t k = 0; k < ndials; k++) {
+          derivs[k][start - first + e] = 0.0;
+        }
+      }
+    }
+  }
+}
+
+size_t SplineCoeffStore::GetMemoryUsage() const {
+  return (fNCoeff + fNSplines) * fStride * sizeof(float) +
+         fOffsets.size() * sizeof(int);
+}
@@ -0,0 +1,60 @@
+#ifndef SPLINECOEFFSTORE_H
+#define SPLINECOEFFSTORE_H
+#include "SplineReader.h"
+
+/// Dial-major store of spline coefficients for a set of events that share
+/// one SplineReader. Coefficient i of every event lives in one contiguous,
+/// aligned column so weights for the whole set are evaluated in vectorised
+/// passes over the columns rather than one Spline::DoEval call per event.
+class SplineCoeffStore {
+public:
+  SplineCoeffStore(SplineReader* reader);
+  ~SplineCoeffStore();
+
+  /// Copy coefficient rows (one per event, reader->GetNPar() long) into
+  /// the column store, replacing any previous contents.
+  void Fill(std::vector<std::vector<float> >::const_iterator first,
+            std::vector<std::vector<float> >::const_iterator last);
+
+  /// Evaluate the total spline weight for events [first, last) into
+  /// weights[0 .. last - first). The reader must already be reconfigured.
+  void CalcWeights(double* weights, size_t first, size_t last) const;
+
+  /// As CalcWeights, also filling derivs[k][0 .. last - first) with the
+  /// derivative of each weight with respect to the dial that moves splines
+  /// dialsplines[k]. Those splines must support HasColumnDerivative().
+  void CalcWeightDerivatives(double* weights, double* const* derivs,
+                             std::vector<std::vector<int> > const& dialsplines,
+                             size_t first, size_t last) const;
+
+  /// Copy the coefficients of one event back into row form.
+  void GetEventCoeff(size_t ievt, float* coeff) const;
+
+  inline size_t GetNEvents() const { return fNEvents; };
+  inline int GetNCoeff() const { return fNCoeff; };
+  inline SplineReader* GetReader() const { return fReader; };
+
+  /// Heap footprint of the coefficient and response columns in bytes.
+  size_t GetMemoryUsage() const;
+
+private:
+  SplineCoeffStore(SplineCoeffStore const&);
+  SplineCoeffStore& operator=(SplineCoeffStore const&);
+
+  void Clear();
+  inline const float* Column(int icoeff) const {
+    return fCoeff + icoeff * fStride;
+  };
+
+  SplineReader* fReader;
+  size_t fNEvents;       ///< Number of events held
+  size_t fStride;        ///< Padded column length
+  int fNCoeff;           ///< Coefficients per event
+  int fNSplines;         ///< Splines in the reader
+  std::vector<int> fOffsets; ///< First coefficient of each spline
+
+  float* fCoeff;    ///< fNCoeff columns of fStride coefficients
+  float* fResponse; ///< fNSplines columns, 1 where a spline has any response
+};
+
+#endif
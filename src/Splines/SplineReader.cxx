@@ -19,6 +19,7 @@ void SplineReader::AddSpline(nuiskey splinekey) {
 
   // Add the spline to the list of all forms
   fAllSplines.push_back(Spline(splname, form, points));
+  AddToOffsets(fAllSplines.back());
   fSpline.push_back(splname);
   fType.push_back(type);
   fForm.push_back(form);
@@ -52,9 +53,15 @@ void SplineReader::Read(TTree *tr) {
     NUIS_LOG(SAM, "Registering Input Spline " << fSpline[i] << " " << fForm[i]
                                           << " " << fPoints[i]);
     fAllSplines.push_back(Spline(fSpline[i], fForm[i], fPoints[i]));
+    AddToOffsets(fAllSplines.back());
   }
 }
 
+void SplineReader::AddToOffsets(Spline const &spl) {
+  fOffsets.push_back(fNCoeff);
+  fNCoeff += spl.fNPar;
+}
+
 void SplineReader::Reconfigure(std::map<std::string, double> &vals) {
 
   // std::cout << "NEW SPLINE READER =========" << std::endl;
@@ -80,28 +87,14 @@ bool SplineReader::NeedsReconfigure() { return fNeedsReconfigure; }
 
 void SplineReader::SetNeedsReconfigure(bool val) { fNeedsReconfigure = val; }
 
-double SplineReader::CalcWeight(float *coeffs) {
+double SplineReader::CalcWeight(const float *coeffs) const {
 
-  int off = 0;
   double rw_weight = 1.0;
 
-  // Form Offset list
-  std::vector<int> offsets;
-  for (size_t i = 0; i < fAllSplines.size(); i++) {
-    offsets.push_back(off);
-    off += fAllSplines[i].GetNPar();
-  }
-
-  // #pragma omp parrallel for
+  // Offsets are fixed when splines are added so this is just the
+  // polynomial evaluation for each spline.
   for (size_t i = 0; i < fAllSplines.size(); i++) {
-
-    // std::cout << "Evaluating spline " << fAllSplines[i].GetName() << " at
-    // coeff offset " << off <<  "(" << coeffs << ")" << std::endl; for (int j =
-    // 0; j < fAllSplines[i].GetNPar(); j++){ std::cout << "Coeff " << j+off <<
-    // " " << coeffs[off+j] << std::endl;
-    // }
-
-    double w = fAllSplines[i].DoEval(&coeffs[offsets[i]]);
+    double w = fAllSplines[i].DoEval(&coeffs[fOffsets[i]]);
     rw_weight *= w;
 
     // std::cout << "Spline RW Weight = " << rw_weight << " " << w << std::endl;
@@ -114,10 +107,4 @@ double SplineReader::CalcWeight(float *coeffs) {
   return rw_weight;
 }
 
-int SplineReader::GetNPar() {
-  int n = 0;
-  for (size_t i = 0; i < fAllSplines.size(); i++) {
-    n += fAllSplines[i].GetNPar();
-  }
-  return n;
-}
+int SplineReader::GetNPar() const { return fNCoeff; }
@@ -9,9 +9,12 @@
 
 // #include "GeneralUtils.h"
 
+/// Evaluates the spline weight for an event's coefficients. After
+/// Reconfigure the reader is read-only during CalcWeight, so one reader can
+/// be shared by several threads within an event loop.
 class SplineReader {
 public:
-  SplineReader() {};
+  SplineReader() : fNeedsReconfigure(true), fNCoeff(0) {};
   ~SplineReader() {};
 
   void AddSpline(nuiskey splkey);
@@ -21,8 +24,8 @@ public:
   bool NeedsReconfigure();
   void SetNeedsReconfigure(bool val = true);
 
-  int GetNPar();
-  double CalcWeight(float* coeffs);
+  int GetNPar() const;
+  double CalcWeight(const float* coeffs) const;
 
   std::vector<Spline> fAllSplines;
   std::vector<std::string> fSpline;
@@ -35,6 +38,11 @@ public:
 
   bool fNeedsReconfigure;
 
+  std::vector<int> fOffsets; ///< First coefficient of each spline
+  int fNCoeff;               ///< Total coefficients per event
+
+private:
+  void AddToOffsets(Spline const& spl);
 
 
 };
@@ -42,6 +42,20 @@ void SplineWriter::AddCoefficientsToTree(TTree *tr) {
   tr->Branch("SplineCoeff", fCoEffStorer, Form("SplineCoeff[%d]/F", fNCoEff));
 }
 
+void SplineWriter::AddSpline(nuiskey splkey) {
+  SplineReader::AddSpline(splkey);
+
+  std::string fitter = splkey.Has("fitter")
+                           ? splkey.GetS("fitter")
+                           : FitPar::Config().GetParS("spline_fitter");
+  if (fitter.compare("linear") && fitter.compare("minuit")) {
+    NUIS_ABORT("Unknown spline fitter '" << fitter << "' for spline "
+                                         << splkey.GetS("name")
+                                         << ", expected linear or minuit.");
+  }
+  fFitter.push_back(fitter);
+}
+
 void SplineWriter::SetupSplineSet() {
   std::cout << "Setting up spline set" << std::endl;
   fDrawSplines = FitPar::Config().GetParB("draw_splines");
@@ -101,6 +115,13 @@ void SplineWriter::SetupSplineSet() {
     fWeightList[i] = 1.0;
   }
 
+  // The dial points are fixed, so linear fits can be solved up front
+  fLinearFit.clear();
+  fLinearFit.resize(fAllSplines.size());
+  for (size_t i = 0; i < fAllSplines.size(); i++) {
+    SetupLinearFit(i);
+  }
+
   // Print out the parameter set
   NUIS_LOG(FIT, "Parset | Index | Pars --- ");
   for (size_t i = 0; i < fSetIndex.size(); i++) {
@@ -224,8 +245,10 @@ void SplineWriter::FitSplinesForEvent(double *inputweights, float *coeff) {
     // Perform Fit
     if (hasresponse) {
       // std::cout << "Fitting Coeff" << std::endl;
-      FitCoeff(&fAllSplines[i], dialvals, weightvals, &coeff[coeffcount],
-               fDrawSplines);
+      if (!FitCoeffLinear(i, weightvals, &coeff[coeffcount])) {
+        FitCoeff(&fAllSplines[i], dialvals, weightvals, &coeff[coeffcount],
+                 fDrawSplines);
+      }
     } else {
       for (int j = 0; coeffcount + j < fNCoEff; j++) {
         // std::cout << "Setting 0.0 response " << coeffcount + i << " " <<
@@ -279,8 +302,10 @@ void SplineWriter::FitSplinesForEvent(TCanvas *fitcanvas, bool saveplot) {
 
     // Make a new graph and fit coeff if response
     if (hasresponse) {
-      FitCoeff(&fAllSplines[i], dialvals, weightvals, &fCoEffStorer[coeffcount],
-               fDrawSplines);
+      if (!FitCoeffLinear(i, weightvals, &fCoEffStorer[coeffcount])) {
+        FitCoeff(&fAllSplines[i], dialvals, weightvals,
+                 &fCoEffStorer[coeffcount], fDrawSplines);
+      }
     } else {
       for (int i = 0; i < npar; i++) {
         fCoEffStorer[coeffcount + i] = 0.0;
@@ -424,6 +449,108 @@ void SplineWriter::FitCoeff(Spline *spl, std::vector<std::vector<double> > &v,
 #endif
 }
 
+void SplineWriter::SetupLinearFit(int ispline) {
+  Spline *spl = &fAllSplines[ispline];
+  fLinearFit[ispline].clear();
+
+  // Only the 1D polynomials are linear in their coefficients
+  switch (spl->GetType()) {
+  case k1DPol1:
+  case k1DPol2:
+  case k1DPol3:
+  case k1DPol4:
+  case k1DPol5:
+  case k1DPol6:
+    break;
+  default:
+    return;
+  }
+  std::string fitter = (ispline < int(fFitter.size()))
+                           ? fFitter[ispline]
+                           : FitPar::Config().GetParS("spline_fitter");
+  if (fitter.compare("linear")) {
+    return;
+  }
+
+  // Dial points in the order FitSplinesForEvent collects the weights
+  std::vector<double> x;
+  for (size_t j = 0; j < fSetIndex.size(); j++) {
+    if (fSetIndex[j] == ispline + 1) {
+      x.push_back(fValList[j][0]);
+    }
+  }
+
+  int npts = x.size();
+  int npar = spl->GetNPar();
+  if (npts < npar) {
+    NUIS_ERR(WRN, "Spline " << spl->GetName() << " has " << npts
+                            << " points for " << npar
+                            << " coefficients, falling back to Minuit.");
+    return;
+  }
+
+  // Design matrix A(j, k) = x_j^k
+  TMatrixD design(npts, npar);
+  for (int j = 0; j < npts; j++) {
+    double xp = 1.0;
+    for (int k = 0; k < npar; k++) {
+      design(j, k) = xp;
+      xp *= x[j];
+    }
+  }
+
+  // Pseudo-inverse V S^-1 U^T from the SVD of A, dropping singular values
+  // that are zero to precision so duplicated points still give the
+  // minimum norm solution.
+  TDecompSVD svd(design);
+  if (!svd.Decompose()) {
+    NUIS_ERR(WRN, "SVD of the design matrix failed for spline "
+                      << spl->GetName() << ", falling back to Minuit.");
+    return;
+  }
+  const TMatrixD &U = svd.GetU();
+  const TMatrixD &V = svd.GetV();
+  const TVectorD &S = svd.GetSig();
+  double stol = S(0) * npts * 1E-14;
+
+  std::vector<double> &solve = fLinearFit[ispline];
+  solve.assign(npar * npts, 0.0);
+  for (int l = 0; l < npar; l++) {
+    if (S(l) <= stol) continue;
+    double sinv = 1.0 / S(l);
+    for (int k = 0; k < npar; k++) {
+      double vs = V(k, l) * sinv;
+      for (int j = 0; j < npts; j++) {
+        solve[k * npts + j] += vs * U(j, l);
+      }
+    }
+  }
+
+  NUIS_LOG(SAM, "Precomputed linear least-squares fit for spline "
+                    << spl->GetName() << " (" << npts << " points, " << npar
+                    << " coefficients)");
+}
+
+bool SplineWriter::FitCoeffLinear(int ispline, std::vector<double> &w,
+                                  float *coeff) {
+  std::vector<double> const &solve = fLinearFit[ispline];
+  if (solve.empty() || fDrawSplines) {
+    return false;
+  }
+
+  int npts = w.size();
+  int npar = solve.size() / npts;
+  for (int k = 0; k < npar; k++) {
+    double const *row = &solve[k * npts];
+    double c = 0.0;
+    for (int j = 0; j < npts; j++) {
+      c += row[j] * w[j];
+    }
+    coeff[k] = c;
+  }
+  return true;
+}
+
 void SplineWriter::FitCoeff1DGraph(Spline *spl, int n, double *x, double *y,
                                    float *coeff, bool draw) {
 
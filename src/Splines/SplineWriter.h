@@ -4,6 +4,10 @@
 #include "Spline.h"
 
 #include "SplineUtils.h"
+
+#include "TDecompSVD.h"
+#include "TMatrixD.h"
+
 #ifdef __MINUIT2_ENABLED__
 
 #ifdef ROOT6_USE_FIT_FITTER_INTERFACE
@@ -42,6 +46,10 @@ public:
   };
   ~SplineWriter() {};
 
+  /// Add a spline, reading its fitting backend from the optional "fitter"
+  /// key (linear or minuit), defaulting to the spline_fitter config.
+  void AddSpline(nuiskey splkey);
+
   void SetupSplineSet();
   void Write(std::string name);
   void AddCoefficientsToTree(TTree* tree);
@@ -71,6 +79,14 @@ public:
   FitWeight* fRW;
   bool fDrawSplines;
 
+  /// Fitting backend for each spline
+  std::vector<std::string> fFitter;
+
+  /// Least-squares solve matrix for each linear fitted spline, npar x npts
+  /// row-major, so that coeff = fLinearFit[i] * weights. Empty for splines
+  /// fitted through ROOT.
+  std::vector<std::vector<double> > fLinearFit;
+
   std::vector<TH1D*> fAllDrawnHists;
   std::vector<TGraph*> fAllDrawnGraphs;
 
@@ -85,6 +101,8 @@ public:
   // Available Fitting Functions
   void FitCoeff(Spline* spl, std::vector< std::vector<double> >& v, std::vector<double>& w, float* coeff, bool draw);
   void FitCoeff1DGraph(Spline* spl, int n, double* x, double* y, float* coeff, bool draw);
+  void SetupLinearFit(int ispline);
+  bool FitCoeffLinear(int ispline, std::vector<double>& w, float* coeff);
   void GetCoeff1DTSpline3(Spline* spl, int n, double* x, double* y, float* coeff, bool draw);
   // void FitCoeff2DGraph(Spline* spl, std::vector< std::vector<double> >& v, std::vector<double>& w, float* coeff, bool draw);
   void FitCoeffNDGraph(Spline* spl, std::vector< std::vector<double> >& v, std::vector<double>& w, float* coeff, bool draw);
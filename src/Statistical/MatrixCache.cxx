@@ -0,0 +1,247 @@
+// Copyright 2016-2021 L. Pickering, P Stowell, R. Terri, C. Wilkinson, C. Wret
+
+/*******************************************************************************
+ *    This file is part of NUISANCE.
+ *
+ *    NUISANCE is free software: you can redistribute it and/or modify
+ *    it under the terms of the GNU General Public License as published by
+ *    the Free Software Foundation, either version 3 of the License, or
+ *    (at your option) any later version.
+ *
+ *    NUISANCE is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU General Public License for more details.
+ *
+ *    You should have received a copy of the GNU General Public License
+ *    along with NUISANCE.  If not, see <http://www.gnu.org/licenses/>.
+ *******************************************************************************/
+#include "MatrixCache.h"
+#include "FitLogger.h"
+#include "NuisConfig.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+const char kCacheMagic[8] = {'N', 'U', 'I', 'S', 'M', 'A', 'T', '\0'};
+const UInt_t kCacheVersion = 2;
+const UInt_t kCacheByteOrder = 0x01020304;
+const ULong64_t kFNVPrime = 1099511628211ULL;
+} // namespace
+
+bool MatrixCache::IsEnabled() {
+  return !FitPar::Config().GetParS("MatrixCacheDir").empty();
+}
+
+ULong64_t MatrixCache::Hash(void const *data, size_t n, ULong64_t seed) {
+  unsigned char const *bytes = static_cast<unsigned char const *>(data);
+  ULong64_t hash = seed;
+  for (size_t i = 0; i < n; i++) {
+    hash ^= bytes[i];
+    hash *= kFNVPrime;
+  }
+  return hash;
+}
+
+ULong64_t MatrixCache::Hash(std::string const &str, ULong64_t seed) {
+  return Hash(str.data(), str.size(), seed);
+}
+
+ULong64_t MatrixCache::Hash(TMatrixDSym const &mat, ULong64_t seed) {
+  Int_t nrows = mat.GetNrows();
+  ULong64_t hash = Hash(&nrows, sizeof(nrows), seed);
+  return Hash(mat.GetMatrixArray(), size_t(nrows) * nrows * sizeof(double),
+              hash);
+}
+
+ULong64_t MatrixCache::GetInvertKey(TMatrixDSym const &mat, bool rescale,
+                                    bool usesvd) {
+  ULong64_t key = Hash("StatUtils::GetInvert");
+  key = Hash(&rescale, sizeof(rescale), key);
+  key = Hash(&usesvd, sizeof(usesvd), key);
+  return Hash(mat, key);
+}
+
+ULong64_t MatrixCache::GetDecompKey(TMatrixDSym const &mat) {
+  return Hash(mat, Hash("StatUtils::GetDecomp"));
+}
+
+ULong64_t MatrixCache::GetTextMatrixKey(std::string const &contents, int dimx,
+                                        int dimy) {
+  ULong64_t key = Hash("StatUtils::GetMatrixFromTextFile");
+  key = Hash(&dimx, sizeof(dimx), key);
+  key = Hash(&dimy, sizeof(dimy), key);
+  return Hash(contents, key);
+}
+
+ULong64_t MatrixCache::GetTextHistKey(std::string const &contents) {
+  return Hash(contents, Hash("PlotUtils::GetTH1DFromFile"));
+}
+
+bool MatrixCache::ReadFile(std::string const &path, std::string &contents) {
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+
+  struct stat filestat;
+  if (fstat(fd, &filestat) != 0) {
+    close(fd);
+    return false;
+  }
+
+  contents.resize(filestat.st_size);
+  size_t got = 0;
+  while (got < contents.size()) {
+    ssize_t n = read(fd, &contents[got], contents.size() - got);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      break;
+    }
+    got += n;
+  }
+  close(fd);
+
+  contents.resize(got);
+  return true;
+}
+
+std::string MatrixCache::GetCachePath(ULong64_t key) {
+  char filename[32];
+  snprintf(filename, sizeof(filename), "%016llx.nuismat",
+           (unsigned long long)key);
+  return FitPar::Config().GetParS("MatrixCacheDir") + "/" + filename;
+}
+
+bool MatrixCache::Load(ULong64_t key, int &nrows, int &ncols,
+                       std::vector<double> &values) {
+  if (!IsEnabled()) {
+    return false;
+  }
+
+  std::string path = GetCachePath(key);
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return false;
+  }
+
+  struct stat cachestat;
+  if (fstat(fd, &cachestat) != 0 ||
+      size_t(cachestat.st_size) < sizeof(MatrixCacheHeader)) {
+    close(fd);
+    return false;
+  }
+
+  void *mapping = mmap(NULL, cachestat.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (mapping == MAP_FAILED) {
+    return false;
+  }
+
+  const MatrixCacheHeader *header =
+      static_cast<const MatrixCacheHeader *>(mapping);
+  bool valid = !memcmp(header->magic, kCacheMagic, sizeof(kCacheMagic)) &&
+               header->version == kCacheVersion &&
+               header->headersize == sizeof(MatrixCacheHeader) &&
+               header->byteorder == kCacheByteOrder &&
+               header->doublesize == sizeof(double) &&
+               header->key == key &&
+               ULong64_t(cachestat.st_size) ==
+                   sizeof(MatrixCacheHeader) +
+                       header->nrows * header->ncols * sizeof(double);
+
+  if (valid) {
+    nrows = header->nrows;
+    ncols = header->ncols;
+    const double *data = reinterpret_cast<const double *>(
+        static_cast<const char *>(mapping) + sizeof(MatrixCacheHeader));
+    values.assign(data, data + header->nrows * header->ncols);
+    NUIS_LOG(DEB, "Read " << nrows << "x" << ncols << " matrix from cache "
+                          << path);
+  } else {
+    NUIS_ERR(WRN, "Ignoring corrupt matrix cache entry " << path);
+  }
+
+  munmap(mapping, cachestat.st_size);
+  return valid;
+}
+
+void MatrixCache::Store(ULong64_t key, int nrows, int ncols,
+                        double const *values) {
+  if (!IsEnabled()) {
+    return;
+  }
+
+  std::string cachedir = FitPar::Config().GetParS("MatrixCacheDir");
+  if (mkdir(cachedir.c_str(), 0755) != 0 && errno != EEXIST) {
+    NUIS_ERR(WRN, "Could not create matrix cache directory " << cachedir);
+    return;
+  }
+
+  MatrixCacheHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, kCacheMagic, sizeof(kCacheMagic));
+  header.version = kCacheVersion;
+  header.headersize = sizeof(MatrixCacheHeader);
+  header.byteorder = kCacheByteOrder;
+  header.doublesize = sizeof(double);
+  header.key = key;
+  header.nrows = nrows;
+  header.ncols = ncols;
+
+  // Unique temporary per writer, as parallel jobs and sample loading
+  // threads can store the same entry at once.
+  std::string path = GetCachePath(key);
+  std::string tmppath = path + ".XXXXXX";
+  int fd = mkstemp(&tmppath[0]);
+  if (fd < 0) {
+    NUIS_ERR(WRN, "Could not create matrix cache file " << tmppath);
+    return;
+  }
+  fchmod(fd, 0644);
+
+  FILE *out = fdopen(fd, "wb");
+  size_t nvalues = size_t(nrows) * ncols;
+  bool written = out && fwrite(&header, sizeof(header), 1, out) == 1 &&
+                 fwrite(values, sizeof(double), nvalues, out) == nvalues;
+  if (out) {
+    written = (fclose(out) == 0) && written;
+  } else {
+    close(fd);
+  }
+
+  if (!written || rename(tmppath.c_str(), path.c_str()) != 0) {
+    NUIS_ERR(WRN, "Could not write matrix cache entry " << path);
+    unlink(tmppath.c_str());
+    return;
+  }
+
+  NUIS_LOG(DEB, "Wrote " << nrows << "x" << ncols << " matrix to cache "
+                         << path);
+}
+
+TMatrixDSym *MatrixCache::LoadSym(ULong64_t key) {
+  int nrows = 0;
+  int ncols = 0;
+  std::vector<double> values;
+  if (!Load(key, nrows, ncols, values) || nrows != ncols || !nrows) {
+    return NULL;
+  }
+  return new TMatrixDSym(nrows, &values[0], "");
+}
+
+void MatrixCache::StoreSym(ULong64_t key, TMatrixDSym const *mat) {
+  if (!mat || !mat->GetNrows()) {
+    return;
+  }
+  Store(key, mat->GetNrows(), mat->GetNrows(), mat->GetMatrixArray());
+}
@@ -0,0 +1,95 @@
+// Copyright 2016-2021 L. Pickering, P Stowell, R. Terri, C. Wilkinson, C. Wret
+
+/*******************************************************************************
+*    This file is part of NUISANCE.
+*
+*    NUISANCE is free software: you can redistribute it and/or modify
+*    it under the terms of the GNU General Public License as published by
+*    the Free Software Foundation, either version 3 of the License, or
+*    (at your option) any later version.
+*
+*    NUISANCE is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU General Public License for more details.
+*
+*    You should have received a copy of the GNU General Public License
+*    along with NUISANCE.  If not, see <http://www.gnu.org/licenses/>.
+*******************************************************************************/
+#ifndef MATRIXCACHE_H
+#define MATRIXCACHE_H
+/*!
+ *  \addtogroup Statistical
+ *  @{
+ */
+#include "TMatrixDSym.h"
+
+#include <string>
+#include <vector>
+
+/// Fixed size header at the start of a matrix cache file, followed by
+/// nrows * ncols doubles in row-major order.
+struct MatrixCacheHeader {
+  char magic[8];
+  UInt_t version;
+  UInt_t headersize;
+  UInt_t byteorder;   ///< 0x01020304 as written, to reject foreign endianness
+  UInt_t doublesize;  ///< sizeof(double) of the writer
+  ULong64_t key;      ///< Content hash the entry was stored under
+  ULong64_t nrows;
+  ULong64_t ncols;
+};
+
+/// On-disk cache of parsed data and covariance inputs and of the inverses
+/// and decompositions made from them.
+///
+/// Entries are keyed by a hash of everything that went into them (the raw
+/// text of an input file, or the elements of the matrix being inverted plus
+/// the options used), so they never go stale and can be shared between any
+/// number of jobs. Each entry is one small binary file in MatrixCacheDir,
+/// read back with a single mapping. The cache is off while MatrixCacheDir is
+/// empty.
+class MatrixCache {
+public:
+  /// True if MatrixCacheDir is set
+  static bool IsEnabled();
+
+  /// 64 bit FNV-1a hash of a block of bytes, chained from seed
+  static ULong64_t Hash(void const *data, size_t n,
+                        ULong64_t seed = 14695981039346656037ULL);
+  static ULong64_t Hash(std::string const &str,
+                        ULong64_t seed = 14695981039346656037ULL);
+  static ULong64_t Hash(TMatrixDSym const &mat,
+                        ULong64_t seed = 14695981039346656037ULL);
+
+  /// Keys used by StatUtils and PlotUtils, kept together so that every
+  /// option changing a result is part of its key.
+  static ULong64_t GetInvertKey(TMatrixDSym const &mat, bool rescale,
+                                bool usesvd);
+  static ULong64_t GetDecompKey(TMatrixDSym const &mat);
+  static ULong64_t GetTextMatrixKey(std::string const &contents, int dimx,
+                                    int dimy);
+  static ULong64_t GetTextHistKey(std::string const &contents);
+
+  /// Read a whole file into contents in one go. Returns false if it cannot
+  /// be opened.
+  static bool ReadFile(std::string const &path, std::string &contents);
+
+  /// Location of the entry for key
+  static std::string GetCachePath(ULong64_t key);
+
+  /// Fetch an entry. Returns false if it is missing or corrupt.
+  static bool Load(ULong64_t key, int &nrows, int &ncols,
+                   std::vector<double> &values);
+
+  /// Write an entry, renamed into place once complete so concurrent jobs
+  /// never read a partial file. Failures only cost the cache.
+  static void Store(ULong64_t key, int nrows, int ncols, double const *values);
+
+  /// Symmetric matrix helpers around Load and Store. LoadSym returns NULL
+  /// on a miss.
+  static TMatrixDSym *LoadSym(ULong64_t key);
+  static void StoreSym(ULong64_t key, TMatrixDSym const *mat);
+};
+/*! @} */
+#endif
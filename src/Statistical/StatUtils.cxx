@@ -19,9 +19,11 @@
 
 #include "StatUtils.h"
 #include "GeneralUtils.h"
+#include "MatrixCache.h"
 #include "NuisConfig.h"
 #include "TH1D.h"
 #include "TVector.h"
+#include <algorithm>
 #include <limits>
 
 //*******************************************************************
@@ -113,12 +115,7 @@ Double_t StatUtils::GetChi2FromCov(TH1D *data, TH1D *mc, TMatrixDSym *invcov,
                                    bool SkipEmptyBin) {
   //*******************************************************************
 
-  static bool first = true;
-  static bool UseSVDDecomp = false;
-  if (first) {
-    UseSVDDecomp = FitPar::Config().GetParB("UseSVDInverse");
-    first = false;
-  }
+  static const bool UseSVDDecomp = FitPar::Config().GetParB("UseSVDInverse");
 
   Double_t Chi2 = 0.0;
   TMatrixDSym *calc_cov = (TMatrixDSym *)invcov->Clone("local_invcov");
@@ -315,6 +312,286 @@ Double_t StatUtils::GetChi2FromCov(TH2D *data, TH2D *mc, TMatrixDSym *invcov,
   return Chi2;
 }
 
+//*******************************************************************
+StatUtils::Chi2Evaluator::Chi2Evaluator() {
+  //*******************************************************************
+  fIsSetup = false;
+  fIs2D = false;
+  fAddMCError = false;
+  fUseSVDDecomp = false;
+  fSymmetric = true;
+  fInvCov = NULL;
+  fMaskSource = NULL;
+  fMapSource = NULL;
+  fCovarScale = 1E76;
+  fNBins = 0;
+}
+
+//*******************************************************************
+void StatUtils::Chi2Evaluator::Reset() {
+  //*******************************************************************
+  fIsSetup = false;
+  fInvCov = NULL;
+  fMaskSource = NULL;
+  fMapSource = NULL;
+  fNBins = 0;
+  fBinIndex.clear();
+  fOutBins.clear();
+  fUnmappedBins.clear();
+  fPacked.clear();
+  fResidual.clear();
+  fProduct.clear();
+  fRowActive.clear();
+}
+
+//*******************************************************************
+void StatUtils::Chi2Evaluator::BuildPacked(TMatrixDSym *mat) {
+  //*******************************************************************
+
+  if (mat->GetNrows() != fNBins) {
+    NUIS_ABORT("Chi2Evaluator: masked matrix has "
+               << mat->GetNrows() << " rows but " << fNBins
+               << " bins are unmasked");
+  }
+
+  // GetChi2FromCov only keeps a non-symmetric inverse (see the comment
+  // there) when using the SVD inverse, otherwise the clone is symmetric and
+  // the upper triangle is all that is needed.
+  fSymmetric = true;
+  if (fUseSVDDecomp) {
+    for (int i = 0; i < fNBins && fSymmetric; i++) {
+      for (int j = i + 1; j < fNBins; j++) {
+        if ((*mat)(i, j) != (*mat)(j, i)) {
+          fSymmetric = false;
+          break;
+        }
+      }
+    }
+  }
+
+  fPacked.clear();
+  if (fSymmetric) {
+    fPacked.reserve(fNBins * (fNBins + 1) / 2);
+    for (int i = 0; i < fNBins; i++) {
+      for (int j = i; j < fNBins; j++) {
+        fPacked.push_back((*mat)(i, j) * fCovarScale);
+      }
+    }
+  } else {
+    NUIS_LOG(DEB, "Chi2Evaluator: inverse is not symmetric, storing full "
+                  "matrix");
+    fPacked.reserve(fNBins * fNBins);
+    for (int i = 0; i < fNBins; i++) {
+      for (int j = 0; j < fNBins; j++) {
+        fPacked.push_back((*mat)(i, j) * fCovarScale);
+      }
+    }
+  }
+
+  fResidual.assign(fNBins, 0.0);
+  fProduct.assign(fNBins, 0.0);
+  fRowActive.assign(fNBins, 0);
+}
+
+//*******************************************************************
+void StatUtils::Chi2Evaluator::Setup(TH1D *data, TMatrixDSym *invcov,
+                                     TH1I *mask, double covar_scale) {
+  //*******************************************************************
+
+  Reset();
+
+  if (data->GetNbinsX() != invcov->GetNcols()) {
+    NUIS_ERR(WRN, "Inconsistent matrix and data histogram passed to "
+                  "StatUtils::Chi2Evaluator!");
+    NUIS_ABORT("data_hist has " << data->GetNbinsX() << " matrix has "
+                                << invcov->GetNcols() << " bins");
+  }
+
+  fIs2D = false;
+  fInvCov = invcov;
+  fMaskSource = mask;
+  fCovarScale = covar_scale;
+  fUseSVDDecomp = FitPar::Config().GetParB("UseSVDInverse");
+  fAddMCError = FitPar::Config().GetParB("statutils.addmcerror");
+
+  // Per-bin output is indexed by the masked bin, as in GetChi2FromCov
+  for (int i = 0; i < data->GetNbinsX(); i++) {
+    if (mask && mask->GetBinContent(i + 1))
+      continue;
+    fBinIndex.push_back(i + 1);
+    fOutBins.push_back(fBinIndex.size());
+  }
+  fNBins = fBinIndex.size();
+
+  if (mask) {
+    TMatrixDSym *masked = ApplyInvertedMatrixMasking(invcov, mask);
+    BuildPacked(masked);
+    delete masked;
+  } else {
+    BuildPacked(invcov);
+  }
+
+  fIsSetup = true;
+}
+
+//*******************************************************************
+void StatUtils::Chi2Evaluator::Setup(TH2D *data, TMatrixDSym *invcov,
+                                     TH2I *map, TH2I *mask,
+                                     double covar_scale) {
+  //*******************************************************************
+
+  bool made_map = false;
+  if (!map) {
+    map = GenerateMap(data);
+    made_map = true;
+  }
+
+  // Reuse the 1D setup on the mapped histograms, then convert the 1D bin
+  // indices back into global 2D bins.
+  TH1D *data_1D = MapToTH1D(data, map);
+  TH1I *mask_1D = MapToMask(mask, map);
+  Setup(data_1D, invcov, mask_1D, covar_scale);
+
+  std::vector<int> mapped_bins(data_1D->GetNbinsX(), -1);
+  for (int i = 0; i < map->GetNbinsX(); i++) {
+    for (int j = 0; j < map->GetNbinsY(); j++) {
+      int gb = map->GetBinContent(i + 1, j + 1);
+      if (gb <= 0) {
+        fUnmappedBins.push_back(data->GetBin(i + 1, j + 1));
+        continue;
+      }
+      mapped_bins[gb - 1] = data->GetBin(i + 1, j + 1);
+    }
+  }
+
+  for (int i = 0; i < fNBins; i++) {
+    fBinIndex[i] = mapped_bins[fBinIndex[i] - 1];
+    fOutBins[i] = mapped_bins[fOutBins[i] - 1];
+  }
+
+  fIs2D = true;
+  fMaskSource = mask;
+  fMapSource = made_map ? NULL : map;
+
+  delete data_1D;
+  delete mask_1D;
+  if (made_map) {
+    delete map;
+  }
+}
+
+//*******************************************************************
+Double_t StatUtils::Chi2Evaluator::EvalResiduals(TH1 *outchi2perbin) {
+  //*******************************************************************
+
+  const int n = fNBins;
+  for (int i = 0; i < n; i++) {
+    fProduct[i] = 0.0;
+  }
+
+  if (fSymmetric) {
+    // Symmetric matvec over the packed upper triangle: each off-diagonal
+    // element contributes to both rows.
+    const double *p = n ? &fPacked[0] : NULL;
+    for (int i = 0; i < n; i++) {
+      const double ri = fResidual[i];
+      const double diag = *p++;
+
+      if (!fUseSVDDecomp && fRowActive[i] && diag < 0) {
+        NUIS_ABORT("Found negative diagonal covariance element: Covar("
+                   << i << ", " << i << ") = " << diag
+                   << ", data - mc = " << ri);
+      }
+
+      double yi = diag * ri;
+      for (int j = i + 1; j < n; j++, p++) {
+        yi += (*p) * fResidual[j];
+        fProduct[j] += (*p) * ri;
+      }
+      fProduct[i] += yi;
+    }
+  } else {
+    for (int i = 0; i < n; i++) {
+      const double *row = &fPacked[i * n];
+      double yi = 0.0;
+      for (int j = 0; j < n; j++) {
+        yi += row[j] * fResidual[j];
+      }
+      fProduct[i] = yi;
+    }
+  }
+
+  Double_t Chi2 = 0.0;
+  for (int i = 0; i < n; i++) {
+    double ibin_contrib = fRowActive[i] ? fResidual[i] * fProduct[i] : 0.0;
+    Chi2 += ibin_contrib;
+    if (outchi2perbin && fOutBins[i] > 0) {
+      outchi2perbin->SetBinContent(fOutBins[i], ibin_contrib);
+    }
+  }
+
+  return Chi2;
+}
+
+//*******************************************************************
+Double_t StatUtils::Chi2Evaluator::Eval(TH1D *data, TH1D *mc,
+                                        double data_scale,
+                                        TH1D *outchi2perbin,
+                                        bool SkipEmptyBin) {
+  //*******************************************************************
+
+  if (!fIsSetup || fIs2D) {
+    NUIS_ABORT("Chi2Evaluator::Eval(TH1D) called without a 1D Setup");
+  }
+
+  if (fAddMCError) {
+    return GetChi2FromCov(data, mc, fInvCov, static_cast<TH1I *>(fMaskSource),
+                          data_scale, fCovarScale, outchi2perbin,
+                          SkipEmptyBin);
+  }
+
+  for (int i = 0; i < fNBins; i++) {
+    double dval = data->GetBinContent(fBinIndex[i]) * data_scale;
+    double mval = mc->GetBinContent(fBinIndex[i]) * data_scale;
+    fResidual[i] = dval - mval;
+    fRowActive[i] = !(SkipEmptyBin && (dval == 0 || mval == 0));
+  }
+
+  return EvalResiduals(outchi2perbin);
+}
+
+//*******************************************************************
+Double_t StatUtils::Chi2Evaluator::Eval(TH2D *data, TH2D *mc,
+                                        TH2D *outchi2perbin) {
+  //*******************************************************************
+
+  if (!fIsSetup || !fIs2D) {
+    NUIS_ABORT("Chi2Evaluator::Eval(TH2D) called without a 2D Setup");
+  }
+
+  if (fAddMCError) {
+    return GetChi2FromCov(data, mc, fInvCov, fMapSource,
+                          static_cast<TH2I *>(fMaskSource), outchi2perbin);
+  }
+
+  for (int i = 0; i < fNBins; i++) {
+    double dval = data->GetBinContent(fBinIndex[i]);
+    double mval = mc->GetBinContent(fBinIndex[i]);
+    fResidual[i] = dval - mval;
+    fRowActive[i] = !(dval == 0 || mval == 0);
+  }
+
+  // GetChi2FromCov resets bins that are not in the map when writing back
+  if (outchi2perbin) {
+    for (size_t i = 0; i < fUnmappedBins.size(); i++) {
+      outchi2perbin->SetBinContent(fUnmappedBins[i], 0.0);
+      outchi2perbin->SetBinError(fUnmappedBins[i], 0.0);
+    }
+  }
+
+  return EvalResiduals(outchi2perbin);
+}
+
 //*******************************************************************
 Double_t StatUtils::GetChi2FromSVD(TH1D *data, TH1D *mc, TMatrixDSym *cov,
                                    TH1I *mask) {
@@ -997,15 +1274,28 @@ TMatrixDSym *StatUtils::GetInvert(TMatrixDSym *mat, bool rescale) {
     return new_mat;
   }
 
-  static bool first = true;
-  static bool UseSVDDecomp = false;
-  if (first) {
-    UseSVDDecomp = FitPar::Config().GetParB("UseSVDInverse");
-    first = false;
-    if (UseSVDDecomp) {
+  // Read once. Samples may be constructed on several threads, and the
+  // initialisation of a function local static is thread safe.
+  static const bool UseSVDDecomp = []() -> bool {
+    bool usesvd = FitPar::Config().GetParB("UseSVDInverse");
+    if (usesvd) {
       NUIS_ERR(WRN, "Allowing SVD inverse if matrices are singular, use with "
                     "extreme caution!");
     }
+    return usesvd;
+  }();
+
+  // Reuse an earlier inversion of the same matrix with the same options
+  bool usecache = MatrixCache::IsEnabled();
+  ULong64_t cachekey = 0;
+  if (usecache) {
+    cachekey = MatrixCache::GetInvertKey(*new_mat, rescale, UseSVDDecomp);
+
+    TMatrixDSym *cached = MatrixCache::LoadSym(cachekey);
+    if (cached) {
+      delete new_mat;
+      return cached;
+    }
   }
 
   // Check if this matrix is singular/positive-definite
@@ -1062,6 +1352,10 @@ TMatrixDSym *StatUtils::GetInvert(TMatrixDSym *mat, bool rescale) {
     new_mat = new TMatrixDSym(nrows, mat_decomp.Invert().GetMatrixArray(), "");
   }
 
+  if (usecache) {
+    MatrixCache::StoreSym(cachekey, new_mat);
+  }
+
   return new_mat;
 }
 
@@ -1097,6 +1391,18 @@ TMatrixDSym *StatUtils::GetDecomp(TMatrixDSym *mat) {
     return new_mat;
   }
 
+  bool usecache = MatrixCache::IsEnabled();
+  ULong64_t cachekey = 0;
+  if (usecache) {
+    cachekey = MatrixCache::GetDecompKey(*new_mat);
+
+    TMatrixDSym *cached = MatrixCache::LoadSym(cachekey);
+    if (cached) {
+      delete new_mat;
+      return cached;
+    }
+  }
+
   // Test if we can decompose the matrix before trying
   bool isWellBehaved = StatUtils::IsMatrixWellBehaved(new_mat);
 
@@ -1126,6 +1432,11 @@ TMatrixDSym *StatUtils::GetDecomp(TMatrixDSym *mat) {
 
   TMatrixDSym *dec_mat = new TMatrixDSym(nrows, LU.GetU().GetMatrixArray(), "");
 
+  // Only successful decompositions are cached, the fallback above warns
+  if (usecache) {
+    MatrixCache::StoreSym(cachekey, dec_mat);
+  }
+
   return dec_mat;
 }
 
@@ -1689,33 +2000,49 @@ TMatrixD *StatUtils::GetMatrixFromTextFile(std::string covfile, int dimx,
                                            int dimy) {
   //*******************************************************************
 
-  // Determine dim
-  if (dimx == -1 and dimy == -1) {
-    std::string line;
-    std::ifstream covar(covfile.c_str(), std::ifstream::in);
-
-    int row = 0;
-    while (std::getline(covar >> std::ws, line, '\n')) {
-      int column = 0;
-
-      std::vector<double> entries = GeneralUtils::ParseToDbl(line, " ");
+  // Read the file once, it is both the cache key and what gets parsed
+  std::string contents;
+  if (!MatrixCache::ReadFile(covfile, contents)) {
+    NUIS_ERR(WRN, "StatUtils::GetMatrixFromTextFile, could not read "
+                      << covfile);
+  }
+
+  bool usecache = MatrixCache::IsEnabled();
+  ULong64_t cachekey = 0;
+  if (usecache) {
+    cachekey = MatrixCache::GetTextMatrixKey(contents, dimx, dimy);
+
+    int nrows = 0;
+    int ncols = 0;
+    std::vector<double> values;
+    if (MatrixCache::Load(cachekey, nrows, ncols, values)) {
+      TMatrixD *mat = new TMatrixD(nrows, ncols);
+      mat->SetMatrixArray(&values[0]);
+      return mat;
+    }
+  }
 
-      if (entries.size() <= 1) {
-        NUIS_ERR(WRN, "StatUtils::GetMatrixFromTextFile, matrix only has <= 1 "
-                      "entries on this line: "
-                          << row);
-      }
-      for (std::vector<double>::iterator iter = entries.begin();
-           iter != entries.end(); iter++) {
-        column++;
+  // Parse every line up front, which also gives the dimensions
+  std::vector<std::vector<double> > rows;
+  std::string line;
+  std::istringstream covar(contents);
 
-        if (column > dimx)
-          dimx = column;
-      }
-      row++;
-      if (row > dimy)
-        dimy = row;
+  int maxcolumns = -1;
+  while (std::getline(covar >> std::ws, line, '\n')) {
+    std::vector<double> entries = GeneralUtils::ParseToDbl(line, " ");
+    if (entries.size() <= 1) {
+      NUIS_ERR(WRN, "StatUtils::GetMatrixFromTextFile, matrix only has <= 1 "
+                    "entries on this line: "
+                        << rows.size());
     }
+    maxcolumns = std::max(maxcolumns, int(entries.size()));
+    rows.push_back(entries);
+  }
+
+  // Determine dim
+  if (dimx == -1 and dimy == -1) {
+    dimx = maxcolumns;
+    dimy = rows.size();
   }
 
   // Or assume symmetric
@@ -1726,32 +2053,16 @@ TMatrixD *StatUtils::GetMatrixFromTextFile(std::string covfile, int dimx,
 
   // Make new matrix
   TMatrixD *mat = new TMatrixD(dimx, dimy);
-  std::string line;
-  std::ifstream covar(covfile.c_str(), std::ifstream::in);
-
-  int row = 0;
-  while (std::getline(covar >> std::ws, line, '\n')) {
-    int column = 0;
-
-    std::vector<double> entries = GeneralUtils::ParseToDbl(line, " ");
-    if (entries.size() <= 1) {
-      NUIS_ERR(WRN, "StatUtils::GetMatrixFromTextFile, matrix only has <= 1 "
-                    "entries on this line: "
-                        << row);
-    }
-    for (std::vector<double>::iterator iter = entries.begin();
-         iter != entries.end(); iter++) {
-      // Check Rows
-      // assert(row > mat->GetNrows() && " covar rows doesn't match matrix
-      // rows.");
-      // assert(column > mat->GetNcols() && " covar cols doesn't match matrix
-      // cols.");
-
+  for (size_t row = 0; row < rows.size(); row++) {
+    for (size_t column = 0; column < rows[row].size(); column++) {
       // Fill Matrix
-      (*mat)(row, column) = (*iter);
-      column++;
+      (*mat)(row, column) = rows[row][column];
     }
-    row++;
+  }
+
+  if (usecache) {
+    MatrixCache::Store(cachekey, mat->GetNrows(), mat->GetNcols(),
+                       mat->GetMatrixArray());
   }
 
   return mat;
@@ -30,6 +30,7 @@
 #include <sstream>
 #include <stdlib.h>
 #include <string>
+#include <vector>
 
 // Root Includes
 #include "TDecompChol.h"
@@ -100,6 +101,76 @@ Double_t GetChi2FromEventRate(TH1D *data, TH1D *mc, TH1I *mask = NULL);
 Double_t GetChi2FromEventRate(TH2D *data, TH2D *mc, TH2I *map = NULL,
                               TH2I *mask = NULL);
 
+//! Precompiled version of GetChi2FromCov for repeated evaluation against a
+//! fixed inverse covariance and mask.
+//!
+//! Setup() applies the mask (which requires two matrix inversions) and the
+//! covariance scaling once, storing the result as a packed upper triangle.
+//! Eval() then only forms the residual vector and the symmetric product
+//! r^T C^-1 r in preallocated buffers, so it does not allocate. The result
+//! matches GetChi2FromCov, including the SkipEmptyBin and per-bin output
+//! conventions. If statutils.addmcerror is set the covariance depends on the
+//! MC, so Eval() falls back to GetChi2FromCov.
+class Chi2Evaluator {
+public:
+  Chi2Evaluator();
+  ~Chi2Evaluator(){};
+
+  //! Build from a 1D data histogram, inverted covariance and optional mask
+  void Setup(TH1D *data, TMatrixDSym *invcov, TH1I *mask = NULL,
+             double covar_scale = 1E76);
+
+  //! Build from a 2D data histogram, using map to convert to 1D as in
+  //! GetChi2FromCov. A map is generated if none is given.
+  void Setup(TH2D *data, TMatrixDSym *invcov, TH2I *map = NULL,
+             TH2I *mask = NULL, double covar_scale = 1E76);
+
+  //! Drop the cached matrix, e.g. after the source covariance is modified in
+  //! place.
+  void Reset();
+
+  //! Check whether the cache was built from these inputs
+  bool IsSetup(TMatrixDSym *invcov, TH1 *mask = NULL, TH2I *map = NULL) const {
+    return fIsSetup && (invcov == fInvCov) && (mask == fMaskSource) &&
+           (map == fMapSource);
+  };
+
+  //! Evaluate the chi2 of a 1D histogram pair
+  Double_t Eval(TH1D *data, TH1D *mc, double data_scale = 1,
+                TH1D *outchi2perbin = NULL, bool SkipEmptyBin = true);
+
+  //! Evaluate the chi2 of a 2D histogram pair
+  Double_t Eval(TH2D *data, TH2D *mc, TH2D *outchi2perbin = NULL);
+
+private:
+  //! Fill fPacked from a matrix over the included bins
+  void BuildPacked(TMatrixDSym *mat);
+
+  //! Run r^T C^-1 r over the residuals already stored in fResidual
+  Double_t EvalResiduals(TH1 *outchi2perbin);
+
+  bool fIsSetup;
+  bool fIs2D;
+  bool fAddMCError;
+  bool fUseSVDDecomp;
+  bool fSymmetric;
+
+  TMatrixDSym *fInvCov; //!< Source inverted covariance (not owned)
+  TH1 *fMaskSource;     //!< Source mask (not owned)
+  TH2I *fMapSource;     //!< Source map (not owned)
+  double fCovarScale;
+
+  int fNBins;                 //!< Number of unmasked bins
+  std::vector<int> fBinIndex; //!< Global histogram bin per unmasked bin
+  std::vector<int> fOutBins;  //!< Per-bin output bin, as GetChi2FromCov
+  std::vector<int> fUnmappedBins; //!< 2D bins not in the map (zeroed output)
+  std::vector<double> fPacked;    //!< Upper triangle, row-major, or full
+                                  //!< matrix if fSymmetric is false
+  std::vector<double> fResidual;
+  std::vector<double> fProduct;
+  std::vector<char> fRowActive;
+};
+
 // Likelihood Functions
 
 //! Placeholder for 1D binned likelihood method
@@ -116,27 +116,26 @@ void T2K_CC0piWithProtons_XSec_2018_multidif_0p_1p_Np::FillEventVariables(
   if (event->NumFSParticle(13) == 0)
     return;
 
-  TLorentzVector Pnu = event->GetNeutrinoIn()->fP;
-  TLorentzVector Pmu = event->GetHMFSParticle(13)->fP;
+  FitParticleView Pnu = event->GetNeutrinoInView();
+  FitParticleView Pmu = event->GetHMFSParticleView(13);
 
-  double pmu = Pmu.Vect().Mag()/1000.;
-  double CosThetaMu = cos(Pnu.Vect().Angle(Pmu.Vect()));
+  double pmu = Pmu.p()/1000.;
+  double CosThetaMu = Pnu.CosTheta(Pmu);
 
   // Dummy proton variables if we don't have a proton
   double pp = -999;
   double CosThetaP = -999;
   // Check if we do have a proton and fill variables
-  if (event->NumFSParticle(2212) > 0){
-    TLorentzVector Pp = event->GetHMFSParticle(2212)->fP;
-    pp = Pp.Vect().Mag() / 1000.;
-    CosThetaP = cos(Pnu.Vect().Angle(Pp.Vect()));
+  FitParticleView Pp = event->GetHMFSParticleView(2212);
+  if (Pp.IsValid()){
+    pp = Pp.p() / 1000.;
+    CosThetaP = Pnu.CosTheta(Pp);
   }
 
   // How many protons above threshold?
-  std::vector<FitParticle *> protons = event->GetAllFSProton();
   int nProtonsAboveThresh = 0;
-  for (size_t i = 0; i < protons.size(); i++) {
-    if (protons[i]->p() > 500)
+  for (FitParticleView proton : event->GetFSParticles(2212)) {
+    if (proton.p() > 500)
       nProtonsAboveThresh++;
   }
 
@@ -12,6 +12,7 @@ struct ConstructibleFitEvent : public FitEvent {
     fParticleState[fNParticles] = State;
     fParticlePDG[fNParticles] = PDG;
     fNParticles++;
+    InvalidateParticleSummary();
   }
   void SetMode(int mode) { Mode = mode; }
   std::string ToString() {
@@ -8,11 +8,12 @@ struct ConstructibleInputHandler : public InputHandlerBase {
     fName = name;
   }
 
-  void AddFitEvent(FitEvent *fe) {
+  void AddFitEvent(FitEvent *fe, bool verbose = true) {
     FitEvents.push_back(fe);
 
     fNEvents = FitEvents.size();
 
+    if (!verbose) return;
     std::cout << "[INFO]: Added event " << std::endl;
     fe->Print();
   }
@@ -0,0 +1,105 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+#include <sstream>
+#include <unistd.h>
+
+#include "FitLogger.h"
+#include "JointFCN.h"
+#include "NuisConfig.h"
+#include "TFile.h"
+#include "WeightUtils.h"
+
+bool SameLikelihoods(std::vector<double> const &a,
+                     std::vector<double> const &b) {
+  if (a.size() != b.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < a.size(); i++) {
+    if (std::fabs(a[i] - b[i]) > 1E-8 * std::max(1.0, std::fabs(a[i]))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+int main(int argc, char const *argv[]) {
+  SETVERBOSITY(SAM);
+  NUIS_LOG(FIT, "*            Running DistributedFCN Tests");
+  NUIS_LOG(FIT, "***************************************************");
+
+  // The DummySample library is built next to the tests
+  char const *samplepath = getenv("NUISANCE_TEST_SAMPLE_PATH");
+  Config::SetPar("dynamic_sample.path",
+                 samplepath ? std::string(samplepath)
+                            : std::string(getenv("NUISANCE")) +
+                                  "/build/Linux/tests");
+  Config::SetPar("EventManager", false);
+  Config::SetPar("FakeDataError", 0.1);
+
+  // Two copies of the dummy sample, one for each worker
+  for (int i = 0; i < 2; i++) {
+    nuiskey sample = Config::CreateKey("sample");
+    sample.SetS("name", "DummySample");
+  }
+
+  for (int i = 1; i <= 3; i++) {
+    std::stringstream name;
+    name << "mode_" << i;
+    FitBase::GetRW()->IncludeDial(name.str(), kMODENORM, 1.0);
+  }
+
+  TFile *outfile = new TFile("DistributedFCNTestOutput.root", "RECREATE");
+  JointFCN *local = new JointFCN(Config::QueryKeys("sample"), outfile);
+  local->SetNParams(3);
+
+  Config::SetPar("DistributedWorkers", 2);
+  JointFCN *distributed = new JointFCN(outfile);
+  distributed->SetNParams(3);
+  assert(distributed->IsDistributed());
+  assert(distributed->GetAllNames() == local->GetAllNames());
+
+  NUIS_LOG(FIT, "    *        Test worker likelihoods match local samples");
+  double points[3][3] = {{1.0, 1.0, 1.0}, {0.5, 1.5, 2.0}, {2.0, 0.8, 1.2}};
+  for (int p = 0; p < 3; p++) {
+    double locallike = local->DoEval(points[p]);
+    double distlike = distributed->DoEval(points[p]);
+    assert(std::fabs(locallike - distlike) <
+           1E-8 * std::max(1.0, std::fabs(locallike)));
+    assert(SameLikelihoods(local->GetAllLikelihoods(),
+                           distributed->GetAllLikelihoods()));
+  }
+  std::vector<double> nominal = distributed->GetAllLikelihoods();
+
+  NUIS_LOG(FIT, "    *        Test fake data updates worker likelihoods");
+  local->SetFakeData("MC");
+  distributed->SetFakeData("MC");
+  std::vector<double> fake = distributed->GetAllLikelihoods();
+  assert(SameLikelihoods(local->GetAllLikelihoods(), fake));
+  assert(!SameLikelihoods(nominal, fake));
+
+  NUIS_LOG(FIT, "    *        Test data toys differ between workers");
+  distributed->ThrowDataToy();
+  std::vector<double> toy = distributed->GetAllLikelihoods();
+  assert(!SameLikelihoods(fake, toy));
+  assert(toy[0] != toy[1]);
+
+  NUIS_LOG(FIT, "    *        Test evaluation after the toy");
+  double toylike = distributed->DoEval(points[2]);
+  std::vector<double> evaltoy = distributed->GetAllLikelihoods();
+  assert(std::fabs(toylike - (evaltoy[0] + evaltoy[1])) <
+         1E-8 * std::max(1.0, std::fabs(toylike)));
+
+  NUIS_LOG(FIT, "    *        Test worker stop");
+  delete distributed;
+  delete local;
+  outfile->Close();
+
+  unlink("DistributedFCNTestOutput.root");
+  unlink("DistributedFCNTestOutput.root.worker0.root");
+  unlink("DistributedFCNTestOutput.root.worker1.root");
+
+  NUIS_LOG(FIT, "*            Passed DistributedFCN Tests");
+  return 0;
+}
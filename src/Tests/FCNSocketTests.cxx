@@ -0,0 +1,130 @@
+#include <cassert>
+#include <cmath>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "FCNSocket.h"
+#include "FitLogger.h"
+
+// Stands in for a JointFCN worker owning two samples, whose likelihoods are
+// (i + 1) * sum(dial^2).
+int RunLoopbackWorker(int port) {
+  FCNSocket *socket = FCNSocket::Connect("127.0.0.1", port, 10);
+  if (!socket) {
+    return 1;
+  }
+
+  std::vector<double> hello;
+  hello.push_back(3);  // worker index
+  hello.push_back(10); // sample NDOFs
+  hello.push_back(20);
+  if (!socket->Send(FCNSocket::kHello, hello, "SampleA\nSampleB")) {
+    return 2;
+  }
+
+  int type = 0;
+  std::vector<double> values;
+  std::string text;
+  while (socket->Receive(type, values, text)) {
+    if (type == FCNSocket::kStop) {
+      socket->Send(FCNSocket::kReply, std::vector<double>());
+      delete socket;
+      return 0;
+    }
+
+    if (type != FCNSocket::kEval || values.empty()) {
+      socket->Send(FCNSocket::kError, std::vector<double>(), "bad request");
+      continue;
+    }
+
+    double sum2 = 0.0;
+    for (size_t i = 1; i < values.size(); i++) {
+      sum2 += values[i] * values[i];
+    }
+
+    std::vector<double> reply;
+    reply.push_back(sum2);
+    reply.push_back(2 * sum2);
+    reply.push_back(10);
+    reply.push_back(20);
+    socket->Send(FCNSocket::kReply, reply);
+  }
+
+  return 3;
+}
+
+int main(int argc, char const *argv[]) {
+  SETVERBOSITY(SAM);
+  NUIS_LOG(FIT, "*            Running FCNSocket Tests");
+  NUIS_LOG(FIT, "***************************************************");
+
+  NUIS_LOG(FIT, "    *        Test address parsing");
+  std::string host;
+  int port = 0;
+  bool parsed = FCNSocket::ParseAddress("node12.cluster:5555", host, port);
+  assert(parsed);
+  assert(host == "node12.cluster" && port == 5555);
+  parsed = FCNSocket::ParseAddress("node12.cluster", host, port);
+  assert(!parsed);
+
+  NUIS_LOG(FIT, "    *        Test listening on a free loopback port");
+  port = 0;
+  int listenfd = FCNSocket::Listen("127.0.0.1", port, 1);
+  assert(listenfd >= 0);
+  assert(port > 0);
+
+  pid_t pid = fork();
+  assert(pid >= 0);
+  if (pid == 0) {
+    close(listenfd);
+    _exit(RunLoopbackWorker(port));
+  }
+
+  FCNSocket *worker = FCNSocket::Accept(listenfd, 10);
+  assert(worker);
+  close(listenfd);
+
+  NUIS_LOG(FIT, "    *        Test worker hello");
+  int type = 0;
+  std::vector<double> hello;
+  std::string names;
+  bool received = worker->Receive(type, hello, names);
+  assert(received);
+  assert(type == FCNSocket::kHello);
+  assert(hello.size() == 3 && hello[0] == 3);
+  assert(names == "SampleA\nSampleB");
+
+  NUIS_LOG(FIT, "    *        Test broadcast dial evaluation");
+  std::vector<double> request;
+  request.push_back(1.0); // full reconfigure
+  request.push_back(0.5);
+  request.push_back(-2.0);
+  std::vector<double> reply;
+  std::string replytext;
+  bool replied =
+      worker->Request(FCNSocket::kEval, request, "", reply, replytext);
+  assert(replied);
+  assert(reply.size() == 4);
+  assert(std::fabs(reply[0] - 4.25) < 1E-12);
+  assert(std::fabs(reply[1] - 8.5) < 1E-12);
+  assert(reply[2] == 10 && reply[3] == 20);
+
+  NUIS_LOG(FIT, "    *        Test error replies");
+  replied = worker->Request(FCNSocket::kWrite, std::vector<double>(), "dir",
+                            reply, replytext);
+  assert(!replied);
+  assert(replytext == "bad request");
+
+  NUIS_LOG(FIT, "    *        Test worker stop");
+  replied = worker->Request(FCNSocket::kStop, std::vector<double>(), "", reply,
+                            replytext);
+  assert(replied);
+  delete worker;
+
+  int status = 0;
+  waitpid(pid, &status, 0);
+  assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+
+  NUIS_LOG(FIT, "*            Passed FCNSocket Tests");
+  return 0;
+}
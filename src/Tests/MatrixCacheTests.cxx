@@ -0,0 +1,172 @@
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <dirent.h>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+
+#include "FitLogger.h"
+#include "MatrixCache.h"
+#include "NuisConfig.h"
+#include "StatUtils.h"
+#include "TMatrixD.h"
+
+bool SameMatrix(TMatrixDBase const &a, TMatrixDBase const &b) {
+  if (a.GetNrows() != b.GetNrows() || a.GetNcols() != b.GetNcols()) {
+    return false;
+  }
+  for (int i = 0; i < a.GetNrows(); i++) {
+    for (int j = 0; j < a.GetNcols(); j++) {
+      if (a(i, j) != b(i, j)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+void RemoveDirectory(std::string const &dir) {
+  DIR *d = opendir(dir.c_str());
+  if (!d) {
+    return;
+  }
+  struct dirent *entry;
+  while ((entry = readdir(d))) {
+    std::string name = entry->d_name;
+    if (name != "." && name != "..") {
+      unlink((dir + "/" + name).c_str());
+    }
+  }
+  closedir(d);
+  rmdir(dir.c_str());
+}
+
+int main(int argc, char const *argv[]) {
+  SETVERBOSITY(SAM);
+  NUIS_LOG(FIT, "*            Running MatrixCache Tests");
+  NUIS_LOG(FIT, "***************************************************");
+
+  char dirtemplate[] = "/tmp/nuismatcacheXXXXXX";
+  char *madedir = mkdtemp(dirtemplate);
+  assert(madedir);
+  std::string cachedir = dirtemplate;
+  Config::SetPar("MatrixCacheDir", cachedir);
+  assert(MatrixCache::IsEnabled());
+
+  // Symmetric positive definite and not diagonal, so it is really inverted
+  TMatrixDSym cov(3);
+  double elements[9] = {4.0, 1.0, 0.5, 1.0, 3.0, 0.2, 0.5, 0.2, 2.0};
+  cov.SetMatrixArray(elements);
+
+  NUIS_LOG(FIT, "    *        Test store and load round trip");
+  ULong64_t key = MatrixCache::GetDecompKey(cov);
+  assert(!MatrixCache::LoadSym(key));
+  MatrixCache::StoreSym(key, &cov);
+  TMatrixDSym *loaded = MatrixCache::LoadSym(key);
+  assert(loaded);
+  assert(SameMatrix(*loaded, cov));
+  delete loaded;
+
+  NUIS_LOG(FIT, "    *        Test non-square entries");
+  double points[6] = {0.0, 1.0, 0.1, 1.0, 2.0, 0.2};
+  MatrixCache::Store(key + 1, 2, 3, points);
+  int nrows = 0;
+  int ncols = 0;
+  std::vector<double> values;
+  bool loadedpoints = MatrixCache::Load(key + 1, nrows, ncols, values);
+  assert(loadedpoints);
+  assert(nrows == 2 && ncols == 3 && values.size() == 6);
+  assert(values[5] == 0.2);
+  assert(!MatrixCache::LoadSym(key + 1));
+
+  NUIS_LOG(FIT, "    *        Test truncated entries are rejected");
+  std::string path = MatrixCache::GetCachePath(key);
+  int status = truncate(path.c_str(), sizeof(MatrixCacheHeader) + 8);
+  assert(status == 0);
+  assert(!MatrixCache::LoadSym(key));
+  status = truncate(path.c_str(), 4);
+  assert(status == 0);
+  assert(!MatrixCache::LoadSym(key));
+
+  NUIS_LOG(FIT, "    *        Test foreign byte order is rejected");
+  MatrixCache::StoreSym(key, &cov);
+  {
+    std::fstream entry(path.c_str(),
+                       std::ios::in | std::ios::out | std::ios::binary);
+    UInt_t swapped = 0x04030201;
+    entry.seekp(offsetof(MatrixCacheHeader, byteorder));
+    entry.write((char const *)&swapped, sizeof(swapped));
+  }
+  assert(!MatrixCache::LoadSym(key));
+
+  NUIS_LOG(FIT, "    *        Test entries under another key are rejected");
+  MatrixCache::StoreSym(key, &cov);
+  status = rename(path.c_str(), MatrixCache::GetCachePath(key + 2).c_str());
+  assert(status == 0);
+  assert(!MatrixCache::LoadSym(key + 2));
+
+  NUIS_LOG(FIT, "    *        Test keys depend on every option");
+  ULong64_t invkey = MatrixCache::GetInvertKey(cov, true, false);
+  assert(invkey == MatrixCache::GetInvertKey(cov, true, false));
+  assert(invkey != MatrixCache::GetInvertKey(cov, false, false));
+  assert(invkey != MatrixCache::GetInvertKey(cov, true, true));
+  assert(invkey != MatrixCache::GetDecompKey(cov));
+
+  TMatrixDSym moved(cov);
+  moved(0, 1) = moved(1, 0) = 1.5;
+  assert(invkey != MatrixCache::GetInvertKey(moved, true, false));
+
+  std::string text = "1 2\n3 4\n";
+  ULong64_t textkey = MatrixCache::GetTextMatrixKey(text, -1, -1);
+  assert(textkey != MatrixCache::GetTextMatrixKey(text, 2, -1));
+  assert(textkey != MatrixCache::GetTextMatrixKey(text, 2, 2));
+  assert(textkey != MatrixCache::GetTextMatrixKey("1 2\n3 5\n", -1, -1));
+  assert(textkey != MatrixCache::GetTextHistKey(text));
+
+  NUIS_LOG(FIT, "    *        Test cached inverse matches a fresh one");
+  TMatrixDSym *inverse = StatUtils::GetInvert(&cov, true);
+  assert(access(MatrixCache::GetCachePath(
+                    MatrixCache::GetInvertKey(cov, true, false))
+                    .c_str(),
+                F_OK) == 0);
+  TMatrixDSym *cachedinverse = StatUtils::GetInvert(&cov, true);
+  assert(SameMatrix(*inverse, *cachedinverse));
+
+  TMatrixD unit(cov, TMatrixD::kMult, *cachedinverse);
+  for (int i = 0; i < 3; i++) {
+    for (int j = 0; j < 3; j++) {
+      assert(std::fabs(unit(i, j) - (i == j ? 1.0 : 0.0)) < 1E-10);
+    }
+  }
+  delete inverse;
+  delete cachedinverse;
+
+  NUIS_LOG(FIT, "    *        Test cached text matrices");
+  std::string textfile = cachedir + "/matrix.txt";
+  {
+    std::ofstream out(textfile.c_str());
+    out << "1 2\n\n  3 4\n";
+  }
+  TMatrixD *parsed = StatUtils::GetMatrixFromTextFile(textfile, -1, -1);
+  assert(parsed->GetNrows() == 2 && parsed->GetNcols() == 2);
+  assert((*parsed)(1, 0) == 3 && (*parsed)(1, 1) == 4);
+  TMatrixD *cachedparsed = StatUtils::GetMatrixFromTextFile(textfile, -1, -1);
+  assert(SameMatrix(*parsed, *cachedparsed));
+  delete parsed;
+  delete cachedparsed;
+
+  NUIS_LOG(FIT, "    *        Test disabled cache");
+  Config::SetPar("MatrixCacheDir", "");
+  assert(!MatrixCache::IsEnabled());
+  MatrixCache::StoreSym(key + 3, &cov);
+  Config::SetPar("MatrixCacheDir", cachedir);
+  assert(!MatrixCache::LoadSym(key + 3));
+
+  RemoveDirectory(cachedir);
+
+  NUIS_LOG(FIT, "*            Passed MatrixCache Tests");
+  return 0;
+}
@@ -377,4 +377,57 @@ int main(int argc, char const *argv[]) {
   }
 
   // SignalDef::isCCWithFS(&fe,14);
+
+  NUIS_LOG(FIT, "*            Testing: particle summary against stack scan");
+
+  std::vector<ConstructibleFitEvent *> allevents;
+  for (std::map<ConstructibleFitEvent *, bool>::iterator fe_it =
+           isCCINC_PassExpectations.begin();
+       fe_it != isCCINC_PassExpectations.end(); ++fe_it) {
+    allevents.push_back(fe_it->first);
+  }
+
+  int const ndefs = 8;
+  char const *defnames[ndefs] = {"isCCINC",    "isNCINC", "isCC0pi",
+                                 "isCCQELike", "isCCQE",  "isCCCOH",
+                                 "isCC1pi",    "isNC1pi"};
+
+  // results[path][event * ndefs + def], path 0 is the stack scan
+  std::vector<bool> results[2];
+  bool usesummary = FitEvent::GetUseParticleSummary();
+  for (int path = 0; path < 2; path++) {
+    FitEvent::SetUseParticleSummary(path);
+    for (size_t e = 0; e < allevents.size(); e++) {
+      ConstructibleFitEvent *fe = allevents[e];
+      // As after a fresh read, the summary is rebuilt for each event
+      fe->InvalidateParticleSummary();
+      results[path].push_back(SignalDef::isCCINC(fe, 14));
+      results[path].push_back(SignalDef::isNCINC(fe, 14));
+      results[path].push_back(SignalDef::isCC0pi(fe, 14));
+      results[path].push_back(SignalDef::isCCQELike(fe, 14));
+      results[path].push_back(SignalDef::isCCQE(fe, 14));
+      results[path].push_back(SignalDef::isCCCOH(fe, 14, 211));
+      results[path].push_back(SignalDef::isCC1pi(fe, 14, 211));
+      results[path].push_back(SignalDef::isNC1pi(fe, 14, -211));
+    }
+  }
+  FitEvent::SetUseParticleSummary(usesummary);
+
+  for (size_t e = 0; e < allevents.size(); e++) {
+    for (int d = 0; d < ndefs; d++) {
+      bool scan = results[0][e * ndefs + d];
+      bool summary = results[1][e * ndefs + d];
+      if (scan != summary) {
+        NUIS_ERR(FTL, "Event: (" << e << ")\n" << allevents[e]->ToString());
+        NUIS_ERR(FTL, "SignalDef::" << defnames[d] << " "
+                                     << (summary ? "passed" : "failed")
+                                     << " with the particle summary but "
+                                     << (scan ? "passed" : "failed")
+                                     << " with the stack scan.");
+      }
+      if (FailOnFail) {
+        assert(scan == summary);
+      }
+    }
+  }
 }
@@ -149,10 +149,9 @@ std::vector<std::string> GeneralUtils::ParseFileToStr(std::string str,
 }
 
 std::string GeneralUtils::GetTopLevelDir() {
-  static bool first = true;
-  static std::string topLevelVarVal;
-
-  if (first) {
+  // Function local statics are initialised once, even when samples are
+  // constructed on several threads
+  static const std::string topLevelVarVal = []() -> std::string {
     char* const var = getenv("NUISANCE");
     if (!var) {
       NUIS_ERR(FTL,
@@ -160,9 +159,8 @@ std::string GeneralUtils::GetTopLevelDir() {
             "variable");
       throw;
     }
-    topLevelVarVal = std::string(var);
-    first = false;
-  }
+    return std::string(var);
+  }();
 
   return topLevelVarVal;
 }
@@ -20,6 +20,8 @@
 #include "PlotUtils.h"
 #include "FitEvent.h"
 #include "StatUtils.h"
+#include "MatrixCache.h"
+#include <algorithm>
 
 // MOVE TO GENERAL UTILS?
 bool PlotUtils::CheckObjectWithName(TFile *inFile, std::string substring) {
@@ -580,36 +582,71 @@ TH1D *PlotUtils::GetTH1DFromFile(std::string dataFile, std::string title,
 
     // Else its a space separated txt file
   } else {
-    // Make a TGraph Errors
-    TGraphErrors *gr = new TGraphErrors(dataFile.c_str(), "%lg %lg %lg");
-    if (gr->IsZombie()) {
-      NUIS_ABORT(
-          dataFile
-          << " is a zombie and could not be read. Are you sure it exists?"
-          << std::endl);
+    // Points are cached as (x, y, ey) rows keyed on the file contents
+    bool usecache = MatrixCache::IsEnabled();
+    ULong64_t cachekey = 0;
+    int npoints = 0;
+    int ncols = 0;
+    std::vector<double> points;
+    if (usecache) {
+      std::string contents;
+      MatrixCache::ReadFile(dataFile, contents);
+      cachekey = MatrixCache::GetTextHistKey(contents);
+      usecache = !contents.empty();
+    }
+
+    if (!usecache || !MatrixCache::Load(cachekey, npoints, ncols, points) ||
+        ncols != 3) {
+      // Make a TGraph Errors
+      TGraphErrors *gr = new TGraphErrors(dataFile.c_str(), "%lg %lg %lg");
+      if (gr->IsZombie()) {
+        NUIS_ABORT(
+            dataFile
+            << " is a zombie and could not be read. Are you sure it exists?"
+            << std::endl);
+      }
+
+      npoints = gr->GetN();
+      points.resize(3 * npoints);
+      for (int i = 0; i < npoints; ++i) {
+        points[3 * i] = gr->GetX()[i];
+        points[3 * i + 1] = gr->GetY()[i];
+        points[3 * i + 2] = gr->GetEY()[i];
+      }
+      delete gr;
+
+      if (usecache && npoints) {
+        MatrixCache::Store(cachekey, npoints, 3, &points[0]);
+      }
+    }
+
+    if (npoints < 2) {
+      NUIS_ABORT(dataFile << " has " << npoints
+                          << " points, at least two are needed for one bin.");
+    }
+
+    std::vector<double> bins(npoints);
+    for (int i = 0; i < npoints; ++i) {
+      bins[i] = points[3 * i];
     }
-    double *bins = gr->GetX();
-    double *values = gr->GetY();
-    double *errors = gr->GetEY();
-    int npoints = gr->GetN();
 
     // Fill the histogram from it
-    tempPlot = new TH1D(title.c_str(), title.c_str(), npoints - 1, bins);
+    tempPlot = new TH1D(title.c_str(), title.c_str(), npoints - 1, &bins[0]);
 
     for (int i = 0; i < npoints; ++i) {
-      tempPlot->SetBinContent(i + 1, values[i]);
+      double value = points[3 * i + 1];
+      double error = points[3 * i + 2];
+      tempPlot->SetBinContent(i + 1, value);
 
       // If only two columns are present in the input file, use the sqrt(values)
       // as the error equivalent to assuming that the error is statistical. Also
       // check that we're looking at an event rate rather than a cross section
-      if (!errors[i] && values[i] > 1E-30) {
-        tempPlot->SetBinError(i + 1, sqrt(values[i]));
+      if (!error && value > 1E-30) {
+        tempPlot->SetBinError(i + 1, sqrt(value));
       } else {
-        tempPlot->SetBinError(i + 1, errors[i]);
+        tempPlot->SetBinError(i + 1, error);
       }
     }
-
-    delete gr;
   }
 
   // Allow alternate naming for root files
@@ -651,6 +688,44 @@ TH1D *PlotUtils::GetRatioPlot(TH1D *hist1, TH1D *hist2, TH1D *new_hist) {
   return new_hist;
 };
 
+void PlotUtils::FillBin(TH1 *hist, int bin, double weight) {
+  hist->AddBinContent(bin, weight);
+  if (hist->GetSumw2N()) {
+    hist->GetSumw2()->fArray[bin] += weight * weight;
+  }
+}
+
+void PlotUtils::GetBinContents(TH1 const *hist, std::vector<double> &contents,
+                               std::vector<double> &err2) {
+  int ncells = hist->GetNcells();
+  contents.resize(ncells);
+  for (int i = 0; i < ncells; i++) {
+    contents[i] = hist->GetBinContent(i);
+  }
+
+  err2.clear();
+  if (hist->GetSumw2N()) {
+    double const *sumw2 = hist->GetSumw2()->GetArray();
+    err2.assign(sumw2, sumw2 + ncells);
+  }
+}
+
+void PlotUtils::SetBinContents(TH1 *hist, std::vector<double> const &contents,
+                               std::vector<double> const &err2,
+                               double const *shift, double const *shifterr2) {
+  int ncells = contents.size();
+  for (int i = 0; i < ncells; i++) {
+    hist->SetBinContent(i, contents[i] + (shift ? shift[i] : 0.0));
+  }
+
+  if (!err2.empty() && hist->GetSumw2N()) {
+    double *sumw2 = hist->GetSumw2()->fArray;
+    for (int i = 0; i < ncells; i++) {
+      sumw2[i] = std::max(0.0, err2[i] + (shifterr2 ? shifterr2[i] : 0.0));
+    }
+  }
+}
+
 TH1D *PlotUtils::GetRenormalisedPlot(TH1D *hist1, TH1D *hist2) {
   // make copy of first hist
   TH1D *new_hist = (TH1D *)hist1->Clone();
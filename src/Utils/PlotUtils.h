@@ -219,6 +219,22 @@ void MaskBins(TH2D* hist, TH2I* mask);
 //! Get the data MC ratio considering empty and masked bins
 double GetDataMCRatio(TH1D* data, TH1D* mc, TH1I* mask = NULL);
 
+//! TH1::Fill into an already known global bin. Leaves the entries and
+//! statistics sums alone, those are rebuilt from the bin contents.
+void FillBin(TH1* hist, int bin, double weight);
+
+//! Content and squared error of every cell of hist. err2 is left empty if
+//! hist has no Sumw2.
+void GetBinContents(TH1 const* hist, std::vector<double>& contents,
+                    std::vector<double>& err2);
+
+//! Set every cell of hist from GetBinContents, moved by shift and
+//! shifterr2 where given. Entries are left to the caller.
+void SetBinContents(TH1* hist, std::vector<double> const& contents,
+                    std::vector<double> const& err2,
+                    double const* shift = NULL,
+                    double const* shifterr2 = NULL);
+
 /*!
   Formatting Plot Utils
 */